@@ -71,6 +71,38 @@ void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
   Can_TxMailboxCallback_Trampoline(hcan, CAN_TX_MAILBOX2);
 }
 
+/**
+ * @brief CAN 发送邮箱0中止回调
+ */
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan)
+{
+  Can_TxMailboxAbortCallback_Trampoline(hcan, CAN_TX_MAILBOX0);
+}
+
+/**
+ * @brief CAN 发送邮箱1中止回调
+ */
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan)
+{
+  Can_TxMailboxAbortCallback_Trampoline(hcan, CAN_TX_MAILBOX1);
+}
+
+/**
+ * @brief CAN 发送邮箱2中止回调
+ */
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan)
+{
+  Can_TxMailboxAbortCallback_Trampoline(hcan, CAN_TX_MAILBOX2);
+}
+
+/**
+ * @brief CAN 错误回调(发送仲裁失败/发送错误也经由此回调上报)
+ */
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan)
+{
+  Can_ErrorCallback_Trampoline(hcan);
+}
+
 // ==================== SPI 回调函数 ====================
 
 void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
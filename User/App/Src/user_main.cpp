@@ -7,17 +7,36 @@
 #include "BspUart.h"
 #include "BspPwm.h"
 #include "BspCan.h"
+#include "BspCrc.h"
 #include "Log.h"
+#include "B2MW_Manager.hpp"
 extern "C" 
 {
   #include "task.h"
 }
 
-Uart uartDebug(DEVICE_USART_6);
+// 调试串口 115200,接收只有短命令,发送以日志为主
+UartPort<64, 256> uartDebug(DEVICE_USART_6);
+
+static_assert(UartPortBytes<decltype(uartDebug)>() <= UART_BUFFER_RAM_BUDGET, "UART buffers exceed UART_BUFFER_RAM_BUDGET");
 
 void userMain() 
 {
+  DWT_Init(CHIP_FREQ_MHZ); // 中间件用 DWT 周期计数器做耗时统计
+  Crc::Init(); // 打开硬件 CRC,失败时 Crc32 全部走软件
   Log::Init(uartDebug);
+  // 所有中间件注册结束后统一规划并启动 BSP 资源
+  B2MWManager& b2mw = B2MWManager::GetInstance();
+  b2mw.Boot();
+  B2MWBootReport report;
+  if (b2mw.GetBootReport(report) == MW_Status::SUCCESS)
+  {
+    for (uint8_t i = 0; i < BOOT_PHASE_END; i++)
+    {
+      Log::Print("boot %s: %lu cycles, %s\n", B2MWManager::PhaseName(static_cast<B2MWBootPhase>(i)),
+                 (unsigned long)report.phaseCycles[i], MW_StatusToString(report.phaseStatus[i]));
+    }
+  }
   Log::Print("HXCBordA ready\n");
   
   while (1)
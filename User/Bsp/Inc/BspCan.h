@@ -14,6 +14,8 @@ typedef void (*CanRxCallback_t)(uint32_t canId, uint8_t* data, uint8_t len);
 void Can_RxFifo0Callback_Trampoline(void *_canHandle);
 void Can_RxFifo1Callback_Trampoline(void *_canHandle);
 void Can_TxMailboxCallback_Trampoline(void *_canHandle, uint32_t mailbox);
+void Can_TxMailboxAbortCallback_Trampoline(void *_canHandle, uint32_t mailbox);
+void Can_ErrorCallback_Trampoline(void *_canHandle);
 
 #ifdef __cplusplus
 }
@@ -33,6 +35,20 @@ struct CanMessage
   bool isRemote;         // 是否为远程帧
 };
 
+/**
+ * @brief CAN 发送邮箱的结束结果
+ */
+enum CanTxResult : uint8_t
+{
+  CAN_TX_RESULT_OK = 0,        // 发送成功
+  CAN_TX_RESULT_ABORTED,       // 发送请求被中止
+  CAN_TX_RESULT_ARB_LOST,      // 仲裁失败(关闭自动重传时不会重发)
+  CAN_TX_RESULT_ERROR          // 发送错误
+};
+
+// CAN 发送邮箱结束回调函数类型, mailbox 为邮箱序号(0-2)
+typedef void (*CanTxDoneCallback_t)(uint32_t mailbox, CanTxResult result);
+
 /**
  * @brief CAN 滤波器配置结构体
  */
@@ -58,6 +74,7 @@ private:
   CanRxCallback_t userRxFifo0Callback = nullptr;
   CanRxCallback_t userRxFifo1Callback = nullptr;
   Callback_t userTxCallback = nullptr;
+  CanTxDoneCallback_t userTxDoneCallback = nullptr;
 
 public:
   /**
@@ -157,9 +174,10 @@ public:
   /**
    * @brief 发送CAN消息（通用）
    * @param msg CAN消息结构体
+   * @param mailbox 输出:消息装入的邮箱序号(0-2),可以为 nullptr
    * @return BspResult<bool> 操作结果
    */
-  BspResult<bool> SendMessage(const CanMessage& msg);
+  BspResult<bool> SendMessage(const CanMessage& msg, uint32_t* mailbox = nullptr);
 
   /**
    * @brief 发送远程帧
@@ -205,6 +223,29 @@ public:
    */
   BspResult<bool> ConfigFilterExtId(uint32_t id, uint32_t mask, CanFIFO fifo = FIFO_0, uint32_t filterBank = 0);
 
+  /**
+   * @brief 配置标准ID列表滤波器（16位列表模式，每个滤波器组最多4个ID）
+   * @param ids 标准ID数组
+   * @param count ID数量（1-4），不足4个时用最后一个ID填充
+   * @param fifo FIFO选择
+   * @param filterBank 滤波器组号
+   * @return BspResult<bool> 操作结果
+   */
+  BspResult<bool> ConfigFilterStdIdList(const uint16_t* ids, uint8_t count, CanFIFO fifo = FIFO_0, uint32_t filterBank = 0);
+
+  /**
+   * @brief 关闭一个滤波器组
+   * @param filterBank 滤波器组号
+   * @return BspResult<bool> 操作结果
+   */
+  BspResult<bool> DisableFilterBank(uint32_t filterBank);
+
+  /**
+   * @brief 获取本CAN实例可用的第一个滤波器组号
+   * @return BspResult<uint32_t> 操作结果，CAN1 为 0，CAN2 为分界起始组号
+   */
+  BspResult<uint32_t> GetFilterBankBase() const;
+
   // ==================== 回调设置 ====================
   
   /**
@@ -228,6 +269,13 @@ public:
    */
   BspResult<bool> SetTxCallback(Callback_t callback);
 
+  /**
+   * @brief 设置发送邮箱结束回调,成功、中止、仲裁失败和发送错误都会调用
+   * @param callback 回调函数
+   * @return BspResult<bool> 操作结果
+   */
+  BspResult<bool> SetTxDoneCallback(CanTxDoneCallback_t callback);
+
   // ==================== 状态查询 ====================
   
   /**
@@ -270,6 +318,7 @@ public:
   void InvokeRxFifo0Callback(const CanMessage& msg);
   void InvokeRxFifo1Callback(const CanMessage& msg);
   void InvokeTxCallback();
+  void InvokeTxDoneCallback(uint32_t mailbox, CanTxResult result);
 };
 
 #endif // __cplusplus
@@ -0,0 +1,50 @@
+#ifndef __BSP_CRC_H__
+#define __BSP_CRC_H__
+
+#include "common_inc.h"
+#include "BspStatus.hpp"
+
+#ifdef __cplusplus
+
+// 数据长度不小于该值时才尝试使用硬件CRC,更短的数据用查表更快(省去互斥量的开销)
+#ifndef BSP_CRC_HW_MIN_LEN
+#define BSP_CRC_HW_MIN_LEN 64U
+#endif
+
+// Crc 提供协议常用的校验算法，Uart、CAN、日志等模块共用
+// - 硬件 CRC 单元固定为 CRC-32/MPEG-2(多项式 0x04C11DB7，不反射，按字输入)，
+//   Crc32 通过按位反转把它用于标准 CRC-32，整字部分交给硬件，剩余字节查表
+// - 硬件单元由互斥量在任务间仲裁：拿不到互斥量或在中断中调用时直接退回软件，不会阻塞
+// - 其他多项式只能软件计算：CRC8/CRC16 按字节查表，CRC32 为 slicing-by-4 查表
+// - 所有函数都可以传入上一次的结果作为初值，分段计算；分段计算时只有第一段可以使用硬件
+class Crc
+{
+public:
+  // 打开 CRC 时钟并创建互斥量；未调用时所有计算都走软件
+  static BspResult<bool> Init();
+
+  // CRC-32 (IEEE 802.3/zlib)，crc 为上一段的结果，第一段传 0
+  static uint32_t Crc32(const uint8_t* data, uint32_t len, uint32_t crc = 0);
+  // CRC-32 纯软件实现 (slicing-by-4)，可在任何上下文中调用
+  static uint32_t Crc32Soft(const uint8_t* data, uint32_t len, uint32_t crc = 0);
+
+  // CRC-16/CCITT-FALSE (多项式 0x1021，不反射，初值 0xFFFF)
+  static uint16_t Crc16Ccitt(const uint8_t* data, uint32_t len, uint16_t init = 0xFFFF);
+  // CRC-16/MCRF4XX (多项式 0x1021，反射，初值 0xFFFF)，RoboMaster 裁判系统帧尾校验
+  static uint16_t Crc16Mcrf4xx(const uint8_t* data, uint32_t len, uint16_t init = 0xFFFF);
+  // CRC-8/MAXIM 多项式 (0x31，反射)，RoboMaster 裁判系统帧头校验的初值为 0xFF
+  static uint8_t Crc8Maxim(const uint8_t* data, uint32_t len, uint8_t init = 0xFF);
+
+  // 硬件单元被使用的次数与退回软件的次数，便于评估争用
+  static uint32_t GetHwCount();
+  static uint32_t GetFallbackCount();
+
+private:
+  Crc() = delete;
+  static bool TryLockHw();
+  static void UnlockHw();
+};
+
+#endif // __cplusplus
+
+#endif // __BSP_CRC_H__
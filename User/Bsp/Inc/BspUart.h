@@ -23,9 +23,152 @@ void Uart_ErrorCallback_Trampoline(void *_uartHandle);
   } // extern "C"
 #endif // __cplusplus
 
+/**
+ * @brief 接收事件回调
+ * @param _size 本次事件新到达环形接收缓冲区的字节数,通过 PeekRx/ReleaseRx 就地读取
+ * @note 在中断中调用(IDLE、DMA半传输、DMA传输完成,以及接收错误恢复时补报中止前到达的字节)
+ */
 typedef void (*UartRxCallback_t)(uint16_t _size);
 typedef void (*UartTxCallback_t)(void);
 
+/**
+ * @brief 带上下文的接收事件回调,参数与 UartRxCallback_t 相同,用于同一驱动服务多个串口
+ */
+typedef void (*UartRxEventCallback_t)(void* ctx, uint16_t _size);
+
+/**
+ * @brief 定长帧接收回调,见 EnableRxFrameDMA
+ * @param ctx 启动时传入的上下文
+ * @param frame 收到完整一帧时指向该帧(DMA 此时正写入另一个缓冲区),帧错位时为 nullptr
+ * @param len 完整帧时为帧长,帧错位时为 IDLE 前收到的字节数
+ * @note 在中断中调用(DMA传输完成、IDLE)
+ */
+typedef void (*UartFrameCallback_t)(void* ctx, const uint8_t* frame, uint16_t len);
+
+struct UartFormatSpec;
+
+/**
+ * @brief 校验方式
+ */
+enum class UartParity : uint8_t
+{
+  None = 0,
+  Even,
+  Odd
+};
+
+/**
+ * @brief 停止位
+ */
+enum class UartStopBits : uint8_t
+{
+  One = 0,
+  Two
+};
+
+/**
+ * @brief 硬件流控,只有 USART1/2/3/6 支持,RTS/CTS 引脚需要在 CubeMX 中配置
+ */
+enum class UartFlowControl : uint8_t
+{
+  None = 0,
+  Rts,
+  Cts,
+  RtsCts
+};
+
+/**
+ * @brief 帧格式配置,默认 8N1、16倍过采样、无流控
+ * @note  - dataBits 为不含校验位的数据位数: 7 位必须带校验, 8 位可带可不带;
+ *          7 位数据时接收到的字节最高位是校验位,需要使用者屏蔽
+ *        - 9 位数据需要 16 位宽的 DMA 传输,当前缓冲区按字节组织,不支持
+ *        - over8 为 8 倍过采样,最高波特率从 PCLK/16 提高到 PCLK/8,
+ *          USART1/6 (APB2 90MHz) 最高 11.25Mbaud,但对噪声的容忍度降低
+ */
+struct UartFraming
+{
+  uint8_t dataBits = 8;
+  UartParity parity = UartParity::None;
+  UartStopBits stopBits = UartStopBits::One;
+  bool over8 = false;
+  UartFlowControl flowControl = UartFlowControl::None;
+};
+
+/**
+ * @brief 零拷贝发送的一段数据
+ */
+struct UartTxSegment
+{
+  const uint8_t* data; // 数据地址,不能位于 CCM RAM
+  uint16_t len;        // 数据长度,不能为 0
+};
+
+/**
+ * @brief 零拷贝发送完成回调
+ * @param ctx 提交请求时传入的上下文
+ * @param ok true 表示全部段已经发出, false 表示请求被 ClearTxBuffer 取消、DMA 启动失败或发送 DMA 出错
+ * @note 一般在发送完成中断中调用;被 ClearTxBuffer 取消时在调用 ClearTxBuffer 的上下文中调用,
+ *       SendSegments 中 DMA 启动失败时在提交请求的上下文中(关中断)调用。
+ *       回调之后请求和各段数据才可以被修改或释放
+ */
+typedef void (*UartTxDoneCallback_t)(void* ctx, bool ok);
+
+/**
+ * @brief 零拷贝发送请求,由调用者持有,在完成回调之前必须保持有效
+ */
+struct UartTxRequest
+{
+  const UartTxSegment* segments = nullptr; // 段数组
+  uint8_t count = 0;                       // 段数
+  UartTxDoneCallback_t done = nullptr;     // 完成回调,可以为 nullptr
+  void* ctx = nullptr;                     // 透传给完成回调的上下文
+
+  // 以下由驱动使用
+  UartTxRequest* next = nullptr;
+  uint8_t cursor = 0;                      // 正在发送的段
+  volatile bool pending = false;           // 已提交且尚未完成
+};
+
+/**
+ * @brief 接收错误统计,由 GetErrorStats 获取
+ * @note  DMA 接收时任何一种错误都会让 HAL 中止接收,每次中止计一次 recoveries 或 recoveryFailures
+ */
+struct UartErrorStats
+{
+  uint32_t overrun = 0;          // 溢出错误(ORE),DMA 没有及时搬走数据,丢失一个字节
+  uint32_t framing = 0;          // 帧错误(FE),停止位为 0,通常是波特率不匹配或断线
+  uint32_t noise = 0;            // 噪声错误(NE)
+  uint32_t parity = 0;           // 校验错误(PE)
+  uint32_t dma = 0;              // DMA 传输错误
+  uint32_t recoveries = 0;       // 接收被中止后成功续接的次数
+  uint32_t recoveryFailures = 0; // 续接失败、接收停止的次数
+  uint32_t txRecoveries = 0;     // 发送 DMA 出错后放弃当前传输、续接后续发送的次数
+  uint32_t droppedBytes = 0;     // 被覆盖或在恢复时丢弃的未读字节数,与 GetRxDropped 相同
+};
+
+/**
+ * @brief 全部 UartPort 缓冲区占用 RAM 的上限,在 user_main 中用 UartPortBytes 做编译期检查
+ */
+#ifndef UART_BUFFER_RAM_BUDGET
+#define UART_BUFFER_RAM_BUDGET 4096U
+#endif
+
+/**
+ * @brief 为 1 时用 DWT 记录发送路径的最长关中断时间,见 GetTxIrqOffMaxCycles
+ */
+#ifndef UART_TRACE_IRQ_OFF
+#define UART_TRACE_IRQ_OFF 0
+#endif
+
+/**
+ * @brief SendData 一直等待发送缓冲区空闲
+ */
+#define UART_TX_WAIT_FOREVER 0xFFFFFFFFU
+
+/**
+ * @brief UART 驱动,不拥有缓冲区
+ * @note  通过 UartPort<RxSize, TxSize> 实例化,缓冲区大小在编译期按端口的速率分别确定
+ */
 class Uart
 {
 private:
@@ -34,58 +177,131 @@ private:
 
   UartTxCallback_t userTxCpltCallback = nullptr;
   UartRxCallback_t userRxCpltCallback = nullptr;
+  UartRxEventCallback_t rxEventCallback = nullptr;
+  void* rxEventCtx = nullptr;
+
+  UartFraming framing; // 当前帧格式
 
-  static const uint32_t DMA_RX_BUFFER_SIZE = 64;
-  static const uint32_t TX_BUFFER_SIZE = 256; // 发送缓冲区大小
+  uint8_t* rxBuffer = nullptr; // 当前使用的接收环形缓冲区,可由 SetRxBuffer 替换
+  uint16_t rxBufferSize = 0;
+  volatile uint16_t lastDmaRxPos = 0; // 上次事件时DMA的写入位置
+  volatile uint16_t rxReadPos = 0; // 消费者的读取位置
+  volatile bool rxRelocating = false; // 错误恢复正在开中断搬移未读数据,期间 PeekRx 返回 0
+  volatile uint32_t rxWritten = 0; // DMA写入的字节总数(自由递增)
+  volatile uint32_t rxReleased = 0; // 消费者释放的字节总数(自由递增)
+  volatile uint32_t rxDroppedBytes = 0; // 消费者没有及时释放而被覆盖丢弃的字节数
+  volatile bool rxIdle = true; // 最近一次接收事件是否为IDLE(一帧结束)
+  volatile bool rxEnabled = false; // 环形DMA接收是否在运行
+  UartErrorStats errorStats; // 接收错误统计,droppedBytes 取自 rxDroppedBytes
 
-  uint8_t dmaRxBuffer[DMA_RX_BUFFER_SIZE]; // DMA接收缓冲区
-  volatile uint16_t lastDmaRxPos = 0; // 上次DMA接收位置
-  bool rxCircularMode = true; // 是否启用环形DMA接收模式
+  uint8_t* rxFrameBuffers[2] = {nullptr, nullptr}; // 双缓冲定长帧接收,见 EnableRxFrameDMA
+  uint16_t rxFrameLen = 0; // 不为 0 时处于定长帧接收模式
+  UartFrameCallback_t rxFrameCallback = nullptr;
+  void* rxFrameCtx = nullptr;
 
-  uint8_t txBuffers[2][TX_BUFFER_SIZE];
-  volatile uint16_t txBufferCounts[2] = {0};
+  uint8_t* txBuffers[2] = {nullptr, nullptr}; // 乒乓发送缓冲区
+  uint16_t txBufferSize = 0; // 单个发送缓冲区的大小
+  volatile uint16_t txBufferCounts[2] = {0}; // 已发布、可以交给DMA的字节数
+  volatile uint16_t txReserved[2] = {0}; // 已预留的字节数,写者拷贝完成后发布
+  volatile uint8_t txWriters[2] = {0}; // 正在拷贝的写者数量
+  volatile uint32_t txIrqOffMaxCycles = 0; // 发送路径的最长关中断时间(DWT周期)
   volatile uint8_t fillIndex = 0; // 当前正在填充的缓冲区索引 (0 或 1)
   volatile bool txDmaBusyFlag = false; // DMA发送忙标志
+  TaskHandle_t volatile txWaitTask = nullptr; // 等待发送缓冲区的任务,由发送完成中断通知
+  UartTxRequest* txReqHead = nullptr; // 零拷贝发送队列,队头可能正在发送
+  UartTxRequest* txReqTail = nullptr;
+  volatile bool txReqActive = false; // DMA 当前发送的是队头请求的一段
+  volatile bool txDmaError = false; // 发送DMA出错,等待数据流停止后续接发送
+  StaticSemaphore_t printfMutexBuffer; // VPrintf 互斥量的静态存储
+  SemaphoreHandle_t printfMutex = nullptr; // 任务中的 VPrintf 整个调用持有,并发输出不会按字段交错
 
   void StartDmaTx(uint8_t index); // 内部辅助函数：启动DMA发送
-  BspResult<bool> ConfigureUart(uint32_t baud);
-  BspResult<uint32_t> PushToRxBuffer(uint8_t *data, uint16_t len, size_t offset);
+  size_t WriteTx(const uint8_t* data, size_t size); // 内部辅助函数：写入空闲的发送缓冲区,不等待
+  uint8_t* ReserveTx(uint16_t len, uint8_t& idx); // 内部辅助函数：预留一段连续的发送缓冲区
+  void PublishTx(uint8_t idx); // 内部辅助函数：写者退出并发布预留的数据
+  void KickTx(); // 内部辅助函数：DMA空闲时发送已发布的数据
+  uint32_t PutText(const char* text, size_t len); // 内部辅助函数：格式化输出一段文本
+  uint32_t PutNumber(const UartFormatSpec& spec, char sign, uint64_t intValue, uint8_t base, bool upper,
+                     uint32_t fracValue, uint8_t fracDigits); // 内部辅助函数：格式化输出一个数字字段
+  void WakeTxWaiter(); // 内部辅助函数：在中断中唤醒等待发送缓冲区的任务
+  void StartSegmentTx(); // 内部辅助函数：启动DMA发送队头请求的当前段
+  UartTxRequest* PopTxRequest(); // 内部辅助函数：取出队头请求
+  uint32_t LockTx(); // 内部辅助函数：进入发送临界区
+  void UnlockTx(uint32_t lockStart); // 内部辅助函数：退出发送临界区并记录关中断时间
+  BspResult<bool> ConfigureUart(uint32_t baud, const UartFraming& _framing);
+  BspResult<bool> StartRxFrameDMA(); // 内部辅助函数：启动双缓冲定长帧接收
+  void AlignRxFrame(); // 内部辅助函数：让DMA从缓冲区0的起点重新开始
+  void RxFrameEvent(uint16_t size); // 内部辅助函数：定长帧接收模式的接收事件
+  uint16_t AdvanceRx(uint16_t pos); // 内部辅助函数：按DMA写入位置推进写入计数
+  BspResult<bool> ResumeRxDMA(); // 内部辅助函数：错误中止后续接环形接收,不丢弃未读数据
+  BspResult<bool> ResumeTxDMA(); // 内部辅助函数：发送DMA出错后放弃当前传输并续接发送
+  void TxTransferEnd(bool ok); // 内部辅助函数：一次DMA发送结束,继续发送排队的数据
+  void NotifyRx(uint16_t received); // 内部辅助函数：调用接收回调
 
-public:
+protected:
 
-  explicit Uart(BspDevice_t _deviceID)
+  /**
+   * @brief 由 UartPort 调用,传入端口自带的缓冲区
+   * @param _deviceID UART设备ID
+   * @param _rxStorage 接收环形缓冲区
+   * @param _rxSize 接收环形缓冲区大小
+   * @param _txStorage 两个连续的发送缓冲区,共 2 * _txSize 字节
+   * @param _txSize 单个发送缓冲区大小
+   */
+  Uart(BspDevice_t _deviceID, uint8_t* _rxStorage, uint16_t _rxSize, uint8_t* _txStorage, uint16_t _txSize)
+    : huart(nullptr), rxBuffer(_rxStorage), rxBufferSize(_rxSize), txBufferSize(_txSize)
   {
+    txBuffers[0] = _txStorage;
+    txBuffers[1] = _txStorage + _txSize;
+
     auto isValidDevice = (_deviceID >= DEVICE_USART_START && _deviceID < DEVICE_USART_END);
-    if (isValidDevice)
-    {
-      deviceID = _deviceID;
-    }
-    else
-    {
-      deviceID = DEVICE_NONE;
-      huart = nullptr;
-      return;
-    }
+    deviceID = isValidDevice ? _deviceID : DEVICE_NONE;
   }
 
-  BspResult<bool> Init(uint32_t baud);
+public:
+
+  Uart(const Uart&) = delete;
+  Uart& operator=(const Uart&) = delete;
+
+  BspResult<bool> Init(uint32_t baud, const UartFraming& _framing = UartFraming());
+  const UartFraming& GetFraming() const { return framing; }
 
   BspResult<bool> SetTxCallback(UartTxCallback_t _userCallback);
   BspResult<bool> SetRxCallback(UartRxCallback_t _userCallback);
+  BspResult<bool> SetRxEventCallback(UartRxEventCallback_t callback, void* ctx); // 带上下文的接收回调,与 SetRxCallback 可以同时使用
+
+  BspResult<bool> SetHalfDuplex(bool enable); // 单线半双工(HDSEL),必须在 EnableRxDMA 之前调用
+  void SetReceiverEnabled(bool enable); // 打开/关闭接收器(RE),可以在中断中调用
+
+  BspResult<bool> SetRxBuffer(uint8_t* buffer, uint16_t size); // 替换接收环形缓冲区,必须在 EnableRxDMA 之前调用
+  BspResult<bool> EnableRxDMA(); // 启动环形DMA接收
+  BspResult<bool> EnableRxFrameDMA(uint8_t* buffer0, uint8_t* buffer1, uint16_t frameLen,
+                                   UartFrameCallback_t callback, void* ctx); // 启动双缓冲定长帧接收,代替环形接收
 
-  BspResult<bool> EnableRxDMA(bool circular = true);
+  BspResult<uint32_t> PeekRx(const uint8_t*& data); // 获取一段连续的未读数据,不拷贝
+  BspResult<bool> ReleaseRx(uint32_t len); // 释放已经处理的数据
+  uint32_t GetRxAvailable() const; // 未读字节数
+  uint32_t GetRxDropped() const { return rxDroppedBytes; } // 被覆盖丢弃的字节数
+  bool IsRxIdle() const { return rxIdle; } // 最近一次接收事件是否为IDLE
 
-  BspResult<uint32_t> SendData(const uint8_t* data, size_t size);
-  BspResult<uint32_t> ReceiveData(uint8_t* data, uint16_t currentDmaPos); // 接收数据
-  void Printf(const char *format, ...);
+  BspResult<uint32_t> SendData(const uint8_t* data, size_t size, uint32_t timeoutMs = UART_TX_WAIT_FOREVER); // 缓冲区满时阻塞等待
+  BspResult<uint32_t> SendDataFromISR(const uint8_t* data, size_t size); // 不等待,返回实际写入的字节数
+  BspResult<bool> SendSegments(UartTxRequest& request); // 零拷贝发送,各段依次直接交给DMA
+  uint32_t GetTxIrqOffMaxCycles() const { return txIrqOffMaxCycles; } // 需要 UART_TRACE_IRQ_OFF
+  void ResetTxIrqOffMaxCycles() { txIrqOffMaxCycles = 0; }
+  BspResult<uint32_t> ReceiveData(uint8_t* data, uint32_t maxLen); // 拷贝并释放最多 maxLen 字节
+  void Printf(const char *format, ...); // 轻量格式化输出,不截断
+  BspResult<uint32_t> VPrintf(const char* format, va_list args); // 直接写入发送缓冲区的格式化输出
 
   void HandleError();
+  UartErrorStats GetErrorStats() const; // 接收错误统计
+  void ResetErrorStats(); // 清零错误统计与丢弃计数
 
   void InvokeTxCallback();
   void InvokeRxCallback(uint16_t size);
 
   void TxCpltCallback(); // 发送完成回调
-  void RxEventCallback(uint16_t size); // 新增：接收事件回调
+  uint16_t RxEventCallback(uint16_t size); // 接收事件回调,返回新到达的字节数
 
   BspResult<bool> ClearRxBuffer();
   BspResult<bool> ClearTxBuffer();
@@ -94,6 +310,45 @@ public:
 
 };
 
+/**
+ * @brief 自带缓冲区的UART端口
+ * @tparam RxSize 接收环形缓冲区大小,偶数。至少要容纳消费者最大处理延迟内到达的字节数的两倍
+ * @tparam TxSize 单个乒乓发送缓冲区的大小,共占用 2 * TxSize 字节
+ * @note  - 缓冲区是对象的成员,端口应定义为全局或静态对象,缓冲区因此位于静态存储区
+ *        - 不要把端口放在 CCM RAM 中,DMA 无法访问 CCM
+ *        - 用法: UartPort<64, 256> uartDebug(DEVICE_USART_6);
+ */
+template <uint16_t RxSize, uint16_t TxSize>
+class UartPort : public Uart
+{
+  static_assert(RxSize >= 8 && (RxSize & 1U) == 0, "UartPort RxSize must be even and at least 8");
+  static_assert(TxSize >= 16, "UartPort TxSize must be at least 16");
+
+public:
+  static constexpr uint32_t RX_BUFFER_SIZE = RxSize;
+  static constexpr uint32_t TX_BUFFER_SIZE = TxSize;
+  static constexpr uint32_t BUFFER_BYTES = RxSize + 2U * TxSize; // 该端口缓冲区占用的RAM
+
+  explicit UartPort(BspDevice_t _deviceID)
+    : Uart(_deviceID, rxStorage, RxSize, &txStorage[0][0], TxSize)
+  {
+  }
+
+private:
+  uint8_t rxStorage[RxSize];
+  uint8_t txStorage[2][TxSize];
+};
+
+/**
+ * @brief 编译期计算若干 UartPort 的缓冲区总字节数
+ * @note  static_assert(UartPortBytes<decltype(uartA), decltype(uartB)>() <= UART_BUFFER_RAM_BUDGET, "...");
+ */
+template <typename... Ports>
+constexpr uint32_t UartPortBytes()
+{
+  return (0U + ... + Ports::BUFFER_BYTES);
+}
+
 
 
 #endif // __BSP_UART_H__
\ No newline at end of file
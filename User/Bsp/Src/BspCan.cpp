@@ -203,6 +203,7 @@ BspResult<bool> Can::Init(uint32_t baud, CanMode mode)
   userRxFifo0Callback = nullptr;
   userRxFifo1Callback = nullptr;
   userTxCallback = nullptr;
+  userTxDoneCallback = nullptr;
   
   // 5. 启动设备(标记为占用)
   auto startResult = Bsp_StartDevice(deviceID);
@@ -347,7 +348,7 @@ BspResult<bool> Can::SendExtData(uint32_t id, const uint8_t* data, uint8_t len)
   BSP_CHECK(false, BspError::DeviceBusy, bool);
 }
 
-BspResult<bool> Can::SendMessage(const CanMessage& msg)
+BspResult<bool> Can::SendMessage(const CanMessage& msg, uint32_t* mailbox)
 {
   BSP_CHECK(hcan != nullptr, BspError::NullHandle, bool);
   BSP_CHECK(msg.len <= 8, BspError::InvalidParam, bool);
@@ -378,6 +379,11 @@ BspResult<bool> Can::SendMessage(const CanMessage& msg)
   
   if (status == HAL_OK)
   {
+    if (mailbox != nullptr)
+    {
+      // HAL 返回的是邮箱位掩码(CAN_TX_MAILBOX0/1/2),转换为序号
+      *mailbox = (txMailbox == CAN_TX_MAILBOX0) ? 0U : ((txMailbox == CAN_TX_MAILBOX1) ? 1U : 2U);
+    }
     return BspResult<bool>::success(true);
   }
   
@@ -610,7 +616,7 @@ const char* Can::GetInfo() const
         "AutoRetrans:%s\n"
         "RxFifoLocked:%s\n"
         "TxFifoPriority:%s\n"
-        "Callbacks: Rx0=%s Rx1=%s Tx=%s\n"
+        "Callbacks: Rx0=%s Rx1=%s Tx=%s TxDone=%s\n"
         "=======================\n", 
         CanInstanceName(handle->Instance),
         deviceID, 
@@ -625,12 +631,97 @@ const char* Can::GetInfo() const
         FunctionalStateToString(handle->Init.TransmitFifoPriority),
         userRxFifo0Callback ? "SET" : "NULL",
         userRxFifo1Callback ? "SET" : "NULL", 
-        userTxCallback      ? "SET" : "NULL"
+        userTxCallback      ? "SET" : "NULL",
+        userTxDoneCallback  ? "SET" : "NULL"
   ); 
   
   return infoBuffer;
 }
 
+BspResult<bool> Can::ConfigFilterStdIdList(const uint16_t* ids, uint8_t count, CanFIFO fifo, uint32_t filterBank)
+{
+  BSP_CHECK(hcan != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(ids != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(count >= 1 && count <= 4, BspError::InvalidParam, bool);
+  BSP_CHECK(filterBank <= 27, BspError::InvalidParam, bool);
+  
+  // 验证并选择合适的 FilterBank 范围
+#ifdef CAN2
+  if (IsCan1Inst(hcan))
+  {
+    BSP_CHECK(filterBank < kCan2StartBank, BspError::InvalidParam, bool);
+  }
+  else if (IsCan2Inst(hcan))
+  {
+    BSP_CHECK(filterBank >= kCan2StartBank, BspError::InvalidParam, bool);
+  }
+#endif
+
+  // 不足4个时重复最后一个ID，避免空位匹配ID 0
+  uint16_t list[4];
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    uint16_t id = ids[(i < count) ? i : (count - 1)];
+    BSP_CHECK(id <= 0x7FF, BspError::InvalidParam, bool);
+    list[i] = static_cast<uint16_t>(id << 5); // 16位模式: STID[10:0] 位于 [15:5]
+  }
+
+  CAN_FilterTypeDef filter;
+  filter.FilterBank = filterBank;
+  filter.FilterMode = CAN_FILTERMODE_IDLIST;
+  filter.FilterScale = CAN_FILTERSCALE_16BIT;
+  filter.FilterIdHigh = list[0];
+  filter.FilterIdLow = list[1];
+  filter.FilterMaskIdHigh = list[2];
+  filter.FilterMaskIdLow = list[3];
+  filter.FilterFIFOAssignment = static_cast<uint32_t>(fifo);
+  filter.FilterActivation = CAN_FILTER_ENABLE;
+  // 仅在 CAN1 上设置分区
+#ifdef CAN2
+  filter.SlaveStartFilterBank = kCan2StartBank;
+#else
+  filter.SlaveStartFilterBank = 14;
+#endif
+  
+  HAL_StatusTypeDef status = HAL_CAN_ConfigFilter(hcan, &filter);
+  BSP_CHECK(status == HAL_OK, BspError::HalError, bool);
+  
+  return BspResult<bool>::success(true);
+}
+
+BspResult<bool> Can::DisableFilterBank(uint32_t filterBank)
+{
+  BSP_CHECK(hcan != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(filterBank <= 27, BspError::InvalidParam, bool);
+
+  CAN_FilterTypeDef filter = {};
+  filter.FilterBank = filterBank;
+  filter.FilterMode = CAN_FILTERMODE_IDMASK;
+  filter.FilterScale = CAN_FILTERSCALE_32BIT;
+  filter.FilterFIFOAssignment = CAN_FILTER_FIFO0;
+  filter.FilterActivation = CAN_FILTER_DISABLE;
+#ifdef CAN2
+  filter.SlaveStartFilterBank = kCan2StartBank;
+#else
+  filter.SlaveStartFilterBank = 14;
+#endif
+
+  HAL_StatusTypeDef status = HAL_CAN_ConfigFilter(hcan, &filter);
+  BSP_CHECK(status == HAL_OK, BspError::HalError, bool);
+
+  return BspResult<bool>::success(true);
+}
+
+BspResult<uint32_t> Can::GetFilterBankBase() const
+{
+  BSP_CHECK(hcan != nullptr, BspError::NullHandle, uint32_t);
+#ifdef CAN2
+  return BspResult<uint32_t>::success(IsCan2Inst(hcan) ? kCan2StartBank : 0U);
+#else
+  return BspResult<uint32_t>::success(0U);
+#endif
+}
+
 BspResult<bool> Can::ConfigFilterExtId(uint32_t id, uint32_t mask, CanFIFO fifo, uint32_t filterBank)
 {
   BSP_CHECK(hcan != nullptr, BspError::NullHandle, bool);
@@ -706,6 +797,16 @@ BspResult<bool> Can::SetTxCallback(Callback_t callback)
   return BspResult<bool>::success(true);
 }
 
+BspResult<bool> Can::SetTxDoneCallback(CanTxDoneCallback_t callback)
+{
+  BSP_CHECK(callback != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(deviceID != DEVICE_NONE, BspError::InvalidDevice, bool);
+  
+  userTxDoneCallback = callback;
+  
+  return BspResult<bool>::success(true);
+}
+
 // ==================== 状态查询 ====================
 
 BspResult<uint32_t> Can::GetBaudRate() const
@@ -794,6 +895,14 @@ void Can::InvokeTxCallback()
   }
 }
 
+void Can::InvokeTxDoneCallback(uint32_t mailbox, CanTxResult result)
+{
+  if (userTxDoneCallback != nullptr)
+  {
+    userTxDoneCallback(mailbox, result);
+  }
+}
+
 // ==================== 蹦床函数 ====================
 
 void Can_RxFifo0Callback_Trampoline(void *_canHandle)
@@ -891,6 +1000,66 @@ void Can_TxMailboxCallback_Trampoline(void *_canHandle, uint32_t mailbox)
     if (instance != nullptr)
     {
       instance->InvokeTxCallback();
+      // HAL 传入的是邮箱位掩码,转换为序号
+      uint32_t index = (mailbox == CAN_TX_MAILBOX0) ? 0U : ((mailbox == CAN_TX_MAILBOX1) ? 1U : 2U);
+      instance->InvokeTxDoneCallback(index, CAN_TX_RESULT_OK);
+    }
+  }
+}
+
+void Can_TxMailboxAbortCallback_Trampoline(void *_canHandle, uint32_t mailbox)
+{
+  auto deviceResult = Bsp_FindDeviceByHandle(_canHandle);
+  if (!deviceResult.ok())
+  {
+    return;
+  }
+  
+  BspDevice_t deviceID = deviceResult.value;
+  if (deviceID >= DEVICE_CAN_START && deviceID < DEVICE_CAN_END)
+  {
+    Can* instance = canInstances[deviceID - DEVICE_CAN_START];
+    if (instance != nullptr)
+    {
+      uint32_t index = (mailbox == CAN_TX_MAILBOX0) ? 0U : ((mailbox == CAN_TX_MAILBOX1) ? 1U : 2U);
+      instance->InvokeTxDoneCallback(index, CAN_TX_RESULT_ABORTED);
+    }
+  }
+}
+
+void Can_ErrorCallback_Trampoline(void *_canHandle)
+{
+  auto deviceResult = Bsp_FindDeviceByHandle(_canHandle);
+  if (!deviceResult.ok())
+  {
+    return;
+  }
+  
+  BspDevice_t deviceID = deviceResult.value;
+  if (deviceID >= DEVICE_CAN_START && deviceID < DEVICE_CAN_END)
+  {
+    Can* instance = canInstances[deviceID - DEVICE_CAN_START];
+    CAN_HandleTypeDef* hcan = static_cast<CAN_HandleTypeDef*>(_canHandle);
+    if (instance != nullptr)
+    {
+      // 关闭自动重传时,HAL 把仲裁失败和发送错误记录在错误码中,而不是调用中止回调
+      static const uint32_t kAlstFlags[3] = {HAL_CAN_ERROR_TX_ALST0, HAL_CAN_ERROR_TX_ALST1, HAL_CAN_ERROR_TX_ALST2};
+      static const uint32_t kTerrFlags[3] = {HAL_CAN_ERROR_TX_TERR0, HAL_CAN_ERROR_TX_TERR1, HAL_CAN_ERROR_TX_TERR2};
+      uint32_t errorCode = hcan->ErrorCode;
+      for (uint32_t i = 0; i < 3; i++)
+      {
+        if (errorCode & kAlstFlags[i])
+        {
+          instance->InvokeTxDoneCallback(i, CAN_TX_RESULT_ARB_LOST);
+        }
+        else if (errorCode & kTerrFlags[i])
+        {
+          instance->InvokeTxDoneCallback(i, CAN_TX_RESULT_ERROR);
+        }
+      }
+      // 只清除已经处理过的发送错误位,保留其他错误供上层查询
+      hcan->ErrorCode &= ~(HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_ALST2 |
+                           HAL_CAN_ERROR_TX_TERR0 | HAL_CAN_ERROR_TX_TERR1 | HAL_CAN_ERROR_TX_TERR2);
     }
   }
 }
\ No newline at end of file
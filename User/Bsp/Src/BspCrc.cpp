@@ -0,0 +1,316 @@
+#include "BspCrc.h"
+
+#include <string.h>
+
+/*==================== 查找表 ====================*/
+
+// 编译期生成查找表，表放在 Flash 中
+struct Crc32Tables
+{
+  uint32_t t[4][256];
+};
+
+struct Crc16Table
+{
+  uint16_t t[256];
+};
+
+struct Crc8Table
+{
+  uint8_t t[256];
+};
+
+// 反射 CRC-32 (多项式反转后为 0xEDB88320) 的 slicing-by-4 表
+static constexpr Crc32Tables MakeCrc32Tables()
+{
+  Crc32Tables tables{};
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++)
+    {
+      c = (c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+    }
+    tables.t[0][i] = c;
+  }
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    for (int s = 1; s < 4; s++)
+    {
+      uint32_t prev = tables.t[s - 1][i];
+      tables.t[s][i] = (prev >> 8) ^ tables.t[0][prev & 0xFFU];
+    }
+  }
+  return tables;
+}
+
+// 不反射的 16 位表
+static constexpr Crc16Table MakeCrc16Table(uint16_t poly)
+{
+  Crc16Table table{};
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint16_t c = (uint16_t)(i << 8);
+    for (int k = 0; k < 8; k++)
+    {
+      c = (c & 0x8000U) ? (uint16_t)((c << 1) ^ poly) : (uint16_t)(c << 1);
+    }
+    table.t[i] = c;
+  }
+  return table;
+}
+
+// 反射的 16 位表，reflectedPoly 为反转后的多项式
+static constexpr Crc16Table MakeCrc16TableReflected(uint16_t reflectedPoly)
+{
+  Crc16Table table{};
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint16_t c = (uint16_t)i;
+    for (int k = 0; k < 8; k++)
+    {
+      c = (c & 1U) ? (uint16_t)((c >> 1) ^ reflectedPoly) : (uint16_t)(c >> 1);
+    }
+    table.t[i] = c;
+  }
+  return table;
+}
+
+// 反射的 8 位表
+static constexpr Crc8Table MakeCrc8TableReflected(uint8_t reflectedPoly)
+{
+  Crc8Table table{};
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint8_t c = (uint8_t)i;
+    for (int k = 0; k < 8; k++)
+    {
+      c = (c & 1U) ? (uint8_t)((c >> 1) ^ reflectedPoly) : (uint8_t)(c >> 1);
+    }
+    table.t[i] = c;
+  }
+  return table;
+}
+
+static constexpr Crc32Tables kCrc32 = MakeCrc32Tables();
+static constexpr Crc16Table kCrc16Ccitt = MakeCrc16Table(0x1021U);
+static constexpr Crc16Table kCrc16Mcrf4xx = MakeCrc16TableReflected(0x8408U);
+static constexpr Crc8Table kCrc8Maxim = MakeCrc8TableReflected(0x8CU);
+
+static_assert(kCrc32.t[0][1] == 0x77073096U, "CRC-32 table generation is wrong");
+static_assert(kCrc16Ccitt.t[1] == 0x1021U, "CRC-16/CCITT table generation is wrong");
+
+/*==================== 硬件单元仲裁 ====================*/
+
+static StaticSemaphore_t crcMutexBuffer;
+static SemaphoreHandle_t crcMutex = nullptr;
+static volatile uint32_t crcHwCount = 0;
+static volatile uint32_t crcFallbackCount = 0;
+
+/**
+ * @brief  打开 CRC 时钟并创建互斥量
+ * @return BspResult<bool> 操作结果
+ * @note   HAL 的 CRC 模块没有启用，直接操作 CRC->CR/CRC->DR；重复调用直接返回成功
+ */
+BspResult<bool> Crc::Init()
+{
+  if (crcMutex != nullptr)
+  {
+    return BspResult<bool>::success(true);
+  }
+
+  __HAL_RCC_CRC_CLK_ENABLE();
+  crcMutex = xSemaphoreCreateMutexStatic(&crcMutexBuffer);
+  BSP_CHECK(crcMutex != nullptr, BspError::InitError, bool);
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  尝试占用硬件单元，不等待
+ * @return 是否占用成功
+ * @note   中断中不能使用互斥量，直接返回失败；调度器启动前没有争用，直接成功
+ */
+bool Crc::TryLockHw()
+{
+  if (crcMutex == nullptr || __get_IPSR() != 0U)
+  {
+    return false;
+  }
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+  {
+    return true;
+  }
+  return xSemaphoreTake(crcMutex, 0) == pdTRUE;
+}
+
+/**
+ * @brief  释放硬件单元
+ */
+void Crc::UnlockHw()
+{
+  if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+  {
+    xSemaphoreGive(crcMutex);
+  }
+}
+
+uint32_t Crc::GetHwCount()
+{
+  return crcHwCount;
+}
+
+uint32_t Crc::GetFallbackCount()
+{
+  return crcFallbackCount;
+}
+
+/*==================== CRC-32 ====================*/
+
+/**
+ * @brief  CRC-32 软件实现的内部状态推进 (slicing-by-4)
+ * @param  state 未取反的内部状态
+ * @return 新的内部状态
+ */
+static uint32_t Crc32Update(uint32_t state, const uint8_t* data, uint32_t len)
+{
+  while (len >= 4)
+  {
+    uint32_t word;
+    memcpy(&word, data, 4); // Cortex-M4 支持非对齐访问，memcpy 会被编译成一次 LDR
+    state ^= word;
+    state = kCrc32.t[3][state & 0xFFU] ^
+            kCrc32.t[2][(state >> 8) & 0xFFU] ^
+            kCrc32.t[1][(state >> 16) & 0xFFU] ^
+            kCrc32.t[0][state >> 24];
+    data += 4;
+    len -= 4;
+  }
+  while (len--)
+  {
+    state = (state >> 8) ^ kCrc32.t[0][(state ^ *data++) & 0xFFU];
+  }
+  return state;
+}
+
+/**
+ * @brief  CRC-32 纯软件实现
+ * @param  data 数据
+ * @param  len 数据长度
+ * @param  crc 上一段的结果，第一段传 0
+ * @return CRC-32
+ */
+uint32_t Crc::Crc32Soft(const uint8_t* data, uint32_t len, uint32_t crc)
+{
+  if (data == nullptr)
+  {
+    return crc;
+  }
+  return ~Crc32Update(~crc, data, len);
+}
+
+/**
+ * @brief  CRC-32，整字部分使用硬件单元
+ * @param  data 数据，不要求对齐
+ * @param  len 数据长度
+ * @param  crc 上一段的结果，第一段传 0
+ * @return CRC-32
+ * @note   硬件单元按字从高位开始计算，每个字按位反转后送入，结果再反转，
+ *         即得到反射 CRC-32 的内部状态，剩余不足一个字的字节查表继续计算。
+ *         硬件单元每次从 0xFFFFFFFF 开始，不能接着上一段计算，因此只在第一段使用
+ */
+uint32_t Crc::Crc32(const uint8_t* data, uint32_t len, uint32_t crc)
+{
+  if (data == nullptr)
+  {
+    return crc;
+  }
+  if (crc != 0 || len < BSP_CRC_HW_MIN_LEN || !TryLockHw())
+  {
+    if (crc == 0 && len >= BSP_CRC_HW_MIN_LEN)
+    {
+      crcFallbackCount++;
+    }
+    return Crc32Soft(data, len, crc);
+  }
+
+  uint32_t words = len >> 2;
+  CRC->CR = CRC_CR_RESET;
+  for (uint32_t i = 0; i < words; i++)
+  {
+    uint32_t word;
+    memcpy(&word, data + 4U * i, 4);
+    CRC->DR = __RBIT(word);
+  }
+  uint32_t state = __RBIT(CRC->DR);
+  UnlockHw();
+  crcHwCount++;
+
+  state = Crc32Update(state, data + 4U * words, len & 3U);
+  return ~state;
+}
+
+/*==================== CRC-16 / CRC-8 ====================*/
+
+/**
+ * @brief  CRC-16/CCITT-FALSE
+ * @param  data 数据
+ * @param  len 数据长度
+ * @param  init 初值或上一段的结果
+ * @return CRC-16
+ */
+uint16_t Crc::Crc16Ccitt(const uint8_t* data, uint32_t len, uint16_t init)
+{
+  uint16_t crc = init;
+  if (data == nullptr)
+  {
+    return crc;
+  }
+  while (len--)
+  {
+    crc = (uint16_t)(crc << 8) ^ kCrc16Ccitt.t[(uint8_t)(crc >> 8) ^ *data++];
+  }
+  return crc;
+}
+
+/**
+ * @brief  CRC-16/MCRF4XX
+ * @param  data 数据
+ * @param  len 数据长度
+ * @param  init 初值或上一段的结果
+ * @return CRC-16
+ */
+uint16_t Crc::Crc16Mcrf4xx(const uint8_t* data, uint32_t len, uint16_t init)
+{
+  uint16_t crc = init;
+  if (data == nullptr)
+  {
+    return crc;
+  }
+  while (len--)
+  {
+    crc = (uint16_t)(crc >> 8) ^ kCrc16Mcrf4xx.t[(uint8_t)(crc ^ *data++)];
+  }
+  return crc;
+}
+
+/**
+ * @brief  CRC-8/MAXIM 多项式
+ * @param  data 数据
+ * @param  len 数据长度
+ * @param  init 初值或上一段的结果
+ * @return CRC-8
+ */
+uint8_t Crc::Crc8Maxim(const uint8_t* data, uint32_t len, uint8_t init)
+{
+  uint8_t crc = init;
+  if (data == nullptr)
+  {
+    return crc;
+  }
+  while (len--)
+  {
+    crc = kCrc8Maxim.t[crc ^ *data++];
+  }
+  return crc;
+}
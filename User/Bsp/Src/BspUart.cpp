@@ -1,4 +1,5 @@
 #include "BspUart.h"
+#include <algorithm>
 
 extern "C" 
 {
@@ -34,16 +35,18 @@ static const char* UartInstanceName(const USART_TypeDef* instance)
 }
 
 /**
- * @brief Uart类构造函数
- * @param _deviceID 要初始化的UART设备ID (例如 DEVICE_USART_1)
- * @note  - 初始化Tx和Rx环形缓冲区
+ * @brief Uart初始化
+ * @param baud 波特率
+ * @param _framing 帧格式,默认 8N1
+ * @note  - 检查端口缓冲区
  *        - 将自身实例注册到全局实例表中
  *        - 显式初始化回调函数指针为nullptr
  */
-BspResult<bool> Uart::Init(uint32_t baud)
+BspResult<bool> Uart::Init(uint32_t baud, const UartFraming& _framing)
 {
   BSP_CHECK(deviceID >= DEVICE_USART_START && deviceID < DEVICE_USART_END, BspError::InvalidDevice, bool);
   BSP_CHECK(baud > 0, BspError::InvalidParam, bool);
+  BSP_CHECK(rxBuffer != nullptr && txBuffers[0] != nullptr, BspError::BufferError, bool);
 
   auto handleResult = Bsp_GetDeviceHandle(deviceID);
   BSP_CHECK(handleResult.ok() && handleResult.value != nullptr, handleResult.error, bool);
@@ -58,11 +61,20 @@ BspResult<bool> Uart::Init(uint32_t baud)
   // 初始化乒乓发送状态
   txBufferCounts[0] = 0;
   txBufferCounts[1] = 0;
+  txReserved[0] = 0;
+  txReserved[1] = 0;
   fillIndex = 0;
   txDmaBusyFlag = false;
 
   userTxCpltCallback = nullptr; 
   userRxCpltCallback = nullptr; 
+  rxEventCallback = nullptr;
+  rxEventCtx = nullptr;
+
+  if (printfMutex == nullptr)
+  {
+    printfMutex = xSemaphoreCreateMutexStatic(&printfMutexBuffer);
+  }
   
   auto startResult = Bsp_StartDevice(deviceID);
   if (!startResult.ok())
@@ -70,7 +82,7 @@ BspResult<bool> Uart::Init(uint32_t baud)
     return startResult;
   }
 
-  auto configResult = ConfigureUart(baud);
+  auto configResult = ConfigureUart(baud, _framing);
   if (!configResult.ok())
   {
     Bsp_StopDevice(deviceID);
@@ -83,61 +95,82 @@ BspResult<bool> Uart::Init(uint32_t baud)
   return BspResult<bool>::success(true);
 }
 
-BspResult<bool> Uart::ConfigureUart(uint32_t baud)
+/**
+ * @brief  按帧格式重新配置 UART 寄存器
+ * @param  baud 波特率
+ * @param  _framing 帧格式
+ * @return BspResult<bool> 操作结果
+ * @note   - 先检查参数再进入临界区,参数非法时不改动外设
+ *         - BRR 按过采样倍数分别计算,OVER8 时小数部分只有 3 位
+ */
+BspResult<bool> Uart::ConfigureUart(uint32_t baud, const UartFraming& _framing)
 {
   BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
 
+  USART_TypeDef *instance = huart->Instance;
+
+  // 1. 检查帧格式
+  // M 位决定帧长(数据位 + 校验位): 0 为 8 位, 1 为 9 位
+  bool hasParity = (_framing.parity != UartParity::None);
+  BSP_CHECK(_framing.dataBits != 9, BspError::Unsupported, bool);
+  BSP_CHECK(_framing.dataBits == 8 || (_framing.dataBits == 7 && hasParity), BspError::InvalidParam, bool);
+  BSP_CHECK(_framing.flowControl == UartFlowControl::None || IS_UART_HWFLOW_INSTANCE(instance), BspError::Unsupported, bool);
+
+  uint32_t wordLength = (_framing.dataBits + (hasParity ? 1U : 0U) == 9U) ? UART_WORDLENGTH_9B : UART_WORDLENGTH_8B;
+  uint32_t parity = (_framing.parity == UartParity::Even) ? UART_PARITY_EVEN
+                  : (_framing.parity == UartParity::Odd) ? UART_PARITY_ODD : UART_PARITY_NONE;
+  uint32_t stopBits = (_framing.stopBits == UartStopBits::Two) ? UART_STOPBITS_2 : UART_STOPBITS_1;
+  uint32_t oversampling = _framing.over8 ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16;
+  uint32_t flowControl = UART_HWCONTROL_NONE;
+  switch (_framing.flowControl)
+  {
+    case UartFlowControl::Rts:    flowControl = UART_HWCONTROL_RTS; break;
+    case UartFlowControl::Cts:    flowControl = UART_HWCONTROL_CTS; break;
+    case UartFlowControl::RtsCts: flowControl = UART_HWCONTROL_RTS_CTS; break;
+    default: break;
+  }
+
+  // 2. 计算波特率寄存器
+  uint32_t pclk;
+  if (instance == USART1 || instance == USART6)
+  {
+    pclk = HAL_RCC_GetPCLK2Freq();  // APB2 时钟
+  }
+  else
+  {
+    pclk = HAL_RCC_GetPCLK1Freq();  // APB1 时钟
+  }
+  BSP_CHECK(baud <= pclk / (_framing.over8 ? 8U : 16U), BspError::InvalidParam, bool);
+  uint32_t brr = _framing.over8 ? UART_BRR_SAMPLING8(pclk, baud) : UART_BRR_SAMPLING16(pclk, baud);
+
   // 进入临界区，确保配置过程不被中断
   __disable_irq();
 
-
   HAL_UART_AbortTransmit(huart);
   
   // 停止接收 DMA（如果已启动）
   HAL_UART_AbortReceive(huart);
 
-  // 2. 禁用 UART（避免在重新配置时产生毛刺）
+  // 3. 禁用 UART（避免在重新配置时产生毛刺）
   __HAL_UART_DISABLE(huart);
 
-  // 3. 更新波特率和其他参数（不需要完全 DeInit/Init）
+  // 4. 更新参数（不需要完全 DeInit/Init,不触发 MSP 层反初始化）
   huart->Init.BaudRate = baud;
-  huart->Init.WordLength = UART_WORDLENGTH_8B;
-  huart->Init.StopBits = UART_STOPBITS_1;
-  huart->Init.Parity = UART_PARITY_NONE;
+  huart->Init.WordLength = wordLength;
+  huart->Init.StopBits = stopBits;
+  huart->Init.Parity = parity;
   huart->Init.Mode = UART_MODE_TX_RX;
-  huart->Init.HwFlowCtl = UART_HWCONTROL_NONE;
-  huart->Init.OverSampling = UART_OVERSAMPLING_16;
+  huart->Init.HwFlowCtl = flowControl;
+  huart->Init.OverSampling = oversampling;
 
-  // 4. 仅重新初始化 UART（不触发 MSP 层反初始化）
-  // 使用 HAL 内部函数直接配置寄存器
-  USART_TypeDef *instance = huart->Instance;
-  
-  // 禁用 UART
-  CLEAR_BIT(instance->CR1, USART_CR1_UE);
-  
-  // 计算并设置波特率寄存器
-  uint32_t pclk;
-  if (instance == USART1 || instance == USART6)
-  {
-    pclk = HAL_RCC_GetPCLK2Freq();  // APB2 时钟
-  }
-  else
-  {
-    pclk = HAL_RCC_GetPCLK1Freq();  // APB1 时钟
-  }
-  
-  uint32_t usartdiv = (pclk * 25U) / (4U * baud);
-  uint32_t divmant = usartdiv / 100U;
-  uint32_t divfraq = ((usartdiv - (divmant * 100U)) * 16U + 50U) / 100U;
-  instance->BRR = (divmant << 4U) | (divfraq & 0x0FU);
-  
-  // 配置控制寄存器
+  // 直接配置寄存器
+  instance->BRR = brr;
   MODIFY_REG(instance->CR1,
              USART_CR1_M | USART_CR1_PCE | USART_CR1_PS | USART_CR1_TE | USART_CR1_RE | USART_CR1_OVER8,
-             USART_CR1_TE | USART_CR1_RE);  // 8位数据，无校验，使能发送接收
-             
-  MODIFY_REG(instance->CR2, USART_CR2_STOP, UART_STOPBITS_1);
-  MODIFY_REG(instance->CR3, USART_CR3_RTSE | USART_CR3_CTSE, UART_HWCONTROL_NONE);
+             wordLength | parity | oversampling | USART_CR1_TE | USART_CR1_RE);
+  MODIFY_REG(instance->CR2, USART_CR2_STOP, stopBits);
+  MODIFY_REG(instance->CR3, USART_CR3_RTSE | USART_CR3_CTSE, flowControl);
+  framing = _framing;
   
   // 5. 重新使能 UART
   SET_BIT(instance->CR1, USART_CR1_UE);
@@ -145,309 +178,1373 @@ BspResult<bool> Uart::ConfigureUart(uint32_t baud)
   // 6. 重新使能 IDLE 中断
   __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
 
-  // 7. 禁用 DMA 半传输中断（如果有 RX DMA）
-  if (huart->hdmarx != nullptr)
+  // 接收已被中止,需要重新调用 EnableRxDMA
+  rxEnabled = false;
+
+  __enable_irq();  // 退出临界区
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  向发送缓冲区写入数据，使用乒乓缓存机制
+ * @param  data 要发送的数据指针
+ * @param  size 要发送的数据大小
+ * @param  timeoutMs 两个缓冲区都满时最长等待的毫秒数, UART_TX_WAIT_FOREVER 表示一直等待
+ * @return BspResult<uint32_t> 操作结果，成功返回实际写入缓冲区的数据大小,超时返回 Timeout 和已写入的大小
+ * @note   - 缓冲区满时阻塞在任务通知上,由发送完成中断唤醒,DMA 一完成就继续写入
+ *         - 等待期间会消耗调用任务的通知值,调用任务不能同时把任务通知用作其他用途
+ *         - 在中断中调用时等同于 SendDataFromISR
+ *         - 调度器启动前不等待,两个缓冲区都满时返回 DeviceBusy 和已写入的大小
+ */
+BspResult<uint32_t> Uart::SendData(const uint8_t* data, size_t size, uint32_t timeoutMs)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, uint32_t);
+  BSP_CHECK(data != nullptr, BspError::InvalidParam, uint32_t);
+  BSP_CHECK(size > 0, BspError::InvalidParam, uint32_t);
+
+  if (__get_IPSR() != 0U)
+  {
+    return SendDataFromISR(data, size);
+  }
+
+  bool canBlock = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+  TickType_t waitTicks = (timeoutMs == UART_TX_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+  TickType_t startTick = canBlock ? xTaskGetTickCount() : 0;
+  size_t written = 0;
+
+  while (true)
+  {
+    written += WriteTx(data + written, size - written);
+    if (written >= size)
+    {
+      break;
+    }
+
+    // 两个缓冲区都满,等待 DMA 释放一个
+    if (!canBlock)
+    {
+      // 调度器还没有启动时不自旋等待:先创建的对象可能已经抬高了 BASEPRI,
+      // 发送完成中断被屏蔽,缓冲区永远不会被释放
+      return BspResult<uint32_t>::failure(BspError::DeviceBusy, written, {__FILE__, __LINE__, __func__});
+    }
+
+    TickType_t remaining = portMAX_DELAY;
+    if (waitTicks != portMAX_DELAY)
+    {
+      TickType_t elapsed = xTaskGetTickCount() - startTick;
+      if (elapsed >= waitTicks)
+      {
+        return BspResult<uint32_t>::failure(BspError::Timeout, written, {__FILE__, __LINE__, __func__});
+      }
+      remaining = waitTicks - elapsed;
+    }
+
+    // 在临界区内再次确认缓冲区已满后登记等待,避免错过发送完成中断
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t lockStart = LockTx();
+    bool isFull = txReserved[fillIndex] >= txBufferSize;
+    bool stillFull = isFull && txDmaBusyFlag;
+    bool writerBusy = isFull && (txWriters[fillIndex] != 0);
+    if (stillFull && txWaitTask == nullptr)
+    {
+      txWaitTask = self;
+    }
+    bool isWaiter = stillFull && (txWaitTask == self);
+    UnlockTx(lockStart);
+
+    if (!stillFull && !writerBusy)
+    {
+      continue;
+    }
+    if (!isWaiter)
+    {
+      vTaskDelay(1); // 已有其他任务在等待,或被抢占的写者还没有发布,退回按节拍轮询
+      continue;
+    }
+
+    ulTaskNotifyTake(pdTRUE, remaining);
+
+    __disable_irq();
+    if (txWaitTask == self)
+    {
+      txWaitTask = nullptr; // 超时醒来,撤销登记
+    }
+    __enable_irq();
+  }
+
+  return BspResult<uint32_t>::success(written);
+}
+
+/**
+ * @brief  在中断中向发送缓冲区写入数据,不等待
+ * @param  data 要发送的数据指针
+ * @param  size 要发送的数据大小
+ * @return BspResult<uint32_t> 实际写入的字节数,两个缓冲区都满时可能小于 size
+ */
+BspResult<uint32_t> Uart::SendDataFromISR(const uint8_t* data, size_t size)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, uint32_t);
+  BSP_CHECK(data != nullptr, BspError::InvalidParam, uint32_t);
+
+  return BspResult<uint32_t>::success(WriteTx(data, size));
+}
+
+/**
+ * @brief  把数据写入空闲的发送缓冲区并按需启动 DMA,不等待
+ * @param  data 要发送的数据指针
+ * @param  size 要发送的数据大小
+ * @return 实际写入的字节数,两个缓冲区都满且 DMA 忙时停止
+ * @note   预留 -> 拷贝 -> 发布:
+ *         - 临界区内只预留空间并登记写者,拷贝在临界区外进行
+ *         - 最后一个写者退出时把预留的长度发布给 DMA,有写者时该缓冲区不会被发送
+ *         - 中断中的写者可以抢占任务中的写者,各自拷贝到不同的预留区
+ */
+size_t Uart::WriteTx(const uint8_t* data, size_t size)
+{
+  size_t written = 0;
+
+  while (written < size)
+  {
+    uint32_t lockStart = LockTx();
+    uint8_t idx = fillIndex;
+    uint16_t reserved = txReserved[idx];
+
+    // 如果当前缓冲区已满
+    if (reserved >= txBufferSize)
+    {
+      if (!txDmaBusyFlag && txWriters[idx] == 0)
+      {
+        // DMA空闲，立即发送当前满的缓冲区，并切换到另一个
+        StartDmaTx(idx);
+        UnlockTx(lockStart);
+        continue; // 重新进入循环，此时 fillIndex 已切换，reserved 应为 0
+      }
+      // DMA忙或还有写者在拷贝，由调用者决定是否等待
+      UnlockTx(lockStart);
+      break;
+    }
+
+    // 预留本次写入的空间
+    size_t space = txBufferSize - reserved;
+    size_t chunk = (size - written < space) ? (size - written) : space; // 本次写入的数据块大小
+    txReserved[idx] = reserved + chunk;
+    txWriters[idx]++;
+    UnlockTx(lockStart);
+
+    // 在临界区外拷贝,fillIndex 在写者退出之前不会切换
+    memcpy(&txBuffers[idx][reserved], data + written, chunk);
+    written += chunk;
+
+    PublishTx(idx);
+  }
+
+  KickTx();
+  return written;
+}
+
+/**
+ * @brief  在当前填充缓冲区中预留一段连续空间,供调用者直接写入
+ * @param  len 需要的字节数
+ * @param  idx 用于接收缓冲区索引的引用,发布时传回
+ * @return 预留空间的起始地址,连续空间不足时返回 nullptr 且不预留
+ * @note   写入后必须调用 PublishTx(idx)
+ */
+uint8_t* Uart::ReserveTx(uint16_t len, uint8_t& idx)
+{
+  uint32_t lockStart = LockTx();
+  idx = fillIndex;
+  uint16_t reserved = txReserved[idx];
+  if (txBufferSize - reserved < len)
+  {
+    UnlockTx(lockStart);
+    return nullptr;
+  }
+  txReserved[idx] = reserved + len;
+  txWriters[idx]++;
+  UnlockTx(lockStart);
+
+  return &txBuffers[idx][reserved];
+}
+
+/**
+ * @brief  写者退出,最后一个写者把预留的长度发布给 DMA
+ * @param  idx 预留时的缓冲区索引
+ */
+void Uart::PublishTx(uint8_t idx)
+{
+  uint32_t lockStart = LockTx();
+  if (--txWriters[idx] == 0)
+  {
+    txBufferCounts[idx] = txReserved[idx];
+    // 如果填满了缓冲区，且DMA空闲，立即发送
+    if (txBufferCounts[idx] >= txBufferSize && !txDmaBusyFlag)
+    {
+      StartDmaTx(idx);
+    }
+  }
+  UnlockTx(lockStart);
+}
+
+/**
+ * @brief  如果还有已发布的数据未发送且DMA空闲，触发发送
+ */
+void Uart::KickTx()
+{
+  uint32_t lockStart = LockTx();
+  if (!txDmaBusyFlag && txWriters[fillIndex] == 0 && txBufferCounts[fillIndex] > 0)
+  {
+    StartDmaTx(fillIndex);
+  }
+  UnlockTx(lockStart);
+}
+
+/**
+ * @brief  进入发送路径的临界区
+ * @return 进入时的 DWT 周期计数
+ */
+uint32_t Uart::LockTx()
+{
+  __disable_irq();
+#if UART_TRACE_IRQ_OFF
+  return DWT->CYCCNT;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief  退出发送路径的临界区,并记录最长关中断时间
+ * @param  lockStart LockTx 的返回值
+ */
+void Uart::UnlockTx(uint32_t lockStart)
+{
+#if UART_TRACE_IRQ_OFF
+  uint32_t cycles = DWT->CYCCNT - lockStart;
+  if (cycles > txIrqOffMaxCycles)
+  {
+    txIrqOffMaxCycles = cycles;
+  }
+#else
+  (void)lockStart;
+#endif
+  __enable_irq();
+}
+
+/**
+ * @brief  唤醒等待发送缓冲区的任务
+ * @note   在中断中调用,发送缓冲区刚被释放
+ */
+void Uart::WakeTxWaiter()
+{
+  TaskHandle_t waiter = txWaitTask;
+  if (waiter == nullptr)
+  {
+    return;
+  }
+  txWaitTask = nullptr;
+
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(waiter, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief  启动DMA发送指定索引的缓冲区
+ * @param  index 缓冲区索引 (0 或 1)
+ * @note   内部函数，必须在临界区内调用
+ */
+void Uart::StartDmaTx(uint8_t index)
+{
+  if (txBufferCounts[index] == 0)
+  {
+    return;
+  } 
+
+  txDmaBusyFlag = true;
+  
+  // 启动DMA传输
+  HAL_StatusTypeDef status = HAL_UART_Transmit_DMA(huart, txBuffers[index], txBufferCounts[index]);
+
+  if (status != HAL_OK)
+  {
+    txDmaBusyFlag = false;
+  }
+  else
+  {
+    // 成功启动后，切换填充索引到另一个缓冲区，并重置其计数
+    // 这样上层应用可以继续填充新的缓冲区，而DMA在后台发送旧的
+    fillIndex = 1 - index;
+    txBufferCounts[fillIndex] = 0;
+    txReserved[fillIndex] = 0;
+  }
+}
+
+/**
+ * @brief  提交一个零拷贝发送请求
+ * @param  request 发送请求,各段数据和请求本身在完成回调之前必须保持有效
+ * @return BspResult<bool> 操作结果
+ * @note   - 各段按顺序直接交给DMA,不经过发送缓冲区,适合大块的遥测帧
+ *         - 与 SendData 共用 DMA,只在一次DMA传输结束处交替,请求中的段不会被缓冲数据插入
+ *         - 可以在中断中调用
+ */
+BspResult<bool> Uart::SendSegments(UartTxRequest& request)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(request.segments != nullptr && request.count > 0, BspError::InvalidParam, bool);
+  BSP_CHECK(!request.pending, BspError::DeviceBusy, bool);
+  for (uint8_t i = 0; i < request.count; i++)
+  {
+    BSP_CHECK(request.segments[i].data != nullptr && request.segments[i].len > 0, BspError::InvalidParam, bool);
+  }
+
+  request.next = nullptr;
+  request.cursor = 0;
+  request.pending = true;
+
+  __disable_irq();
+  if (txReqTail == nullptr)
+  {
+    txReqHead = &request;
+  }
+  else
+  {
+    txReqTail->next = &request;
+  }
+  txReqTail = &request;
+
+  if (!txDmaBusyFlag)
+  {
+    StartSegmentTx();
+  }
+  __enable_irq();
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  取出队头请求
+ * @return 队头请求,队列为空时返回 nullptr
+ * @note   内部函数，必须在临界区内调用
+ */
+UartTxRequest* Uart::PopTxRequest()
+{
+  UartTxRequest* request = txReqHead;
+  if (request != nullptr)
+  {
+    txReqHead = request->next;
+    if (txReqHead == nullptr)
+    {
+      txReqTail = nullptr;
+    }
+    request->next = nullptr;
+  }
+  return request;
+}
+
+/**
+ * @brief  启动DMA发送队头请求的当前段
+ * @note   内部函数，必须在临界区内调用
+ *         启动失败的请求以 ok = false 结束,继续尝试下一个请求
+ */
+void Uart::StartSegmentTx()
+{
+  while (txReqHead != nullptr)
+  {
+    const UartTxSegment& segment = txReqHead->segments[txReqHead->cursor];
+
+    txDmaBusyFlag = true;
+    txReqActive = true;
+    if (HAL_UART_Transmit_DMA(huart, const_cast<uint8_t*>(segment.data), segment.len) == HAL_OK)
+    {
+      return;
+    }
+
+    txDmaBusyFlag = false;
+    txReqActive = false;
+    UartTxRequest* failed = PopTxRequest();
+    failed->pending = false;
+    if (failed->done != nullptr)
+    {
+      failed->done(failed->ctx, false);
+    }
+  }
+}
+
+/**
+ * @brief  DMA发送完成中断回调的核心处理函数
+ * @note   由蹦床函数在中断上下文中调用
+ */
+void Uart::TxCpltCallback()
+{
+  TxTransferEnd(true);
+}
+
+/**
+ * @brief  一次DMA发送结束,继续发送排队的数据
+ * @param  ok false 表示这次传输因为DMA错误被放弃
+ * @note   在中断上下文中调用
+ *         - 正在发送零拷贝请求时,继续发送它的下一段,最后一段完成后调用完成回调;
+ *           传输被放弃时整个请求以 ok = false 结束
+ *         - 之后缓冲数据与零拷贝请求交替占用DMA,任何一方都不会一直等待
+ *         - 都没有数据时，标记DMA为空闲
+ */
+void Uart::TxTransferEnd(bool ok)
+{
+  bool requestFinished = false;
+
+  if (txReqActive)
+  {
+    txReqActive = false;
+    UartTxRequest* request = txReqHead;
+    if (ok && ++request->cursor < request->count)
+    {
+      StartSegmentTx(); // 同一个请求的各段连续发送
+      return;
+    }
+
+    PopTxRequest();
+    request->pending = false;
+    if (request->done != nullptr)
+    {
+      request->done(request->ctx, ok);
+    }
+    requestFinished = true;
+  }
+
+  // DMA刚刚完成了上一次传输
+  // 检查当前正在填充的缓冲区是否有数据需要发送
+  // 注意：fillIndex 指向的是当前正在填充（或等待填充）的缓冲区
+  // 如果它有数据，说明在DMA发送期间，应用层已经填了一些数据进去
+  // 还有写者在拷贝时不发送,由最后一个写者发布后启动
+  uint8_t idx = fillIndex;
+  bool hasBuffered = (txBufferCounts[idx] > 0) && (txWriters[idx] == 0);
+
+  if (txReqHead != nullptr && (!hasBuffered || !requestFinished))
+  {
+    StartSegmentTx();
+  }
+  else if (hasBuffered)
+  {
+    // 立即启动发送当前缓冲区
+    // StartDmaTx 会切换 fillIndex，所以下一次填充会去用刚才发送完的那个缓冲区
+    StartDmaTx(idx);
+  }
+  else
+  {
+    // 没有数据要发送，标记为空闲
+    txDmaBusyFlag = false;
+  }
+
+  // 刚发送完的缓冲区已经空闲,唤醒等待写入的任务
+  WakeTxWaiter();
+}
+
+/**
+ * @brief  设置用户自定义的发送完成回调函数
+ * @param  _userCallback 用户提供的回调函数指针
+ * @return BspResult<bool> 操作结果
+ */
+BspResult<bool> Uart::SetTxCallback(UartTxCallback_t _userCallback)
+{
+  BSP_CHECK(_userCallback != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(deviceID != DEVICE_NONE, BspError::InvalidDevice, bool);
+
+  userTxCpltCallback = _userCallback;
+  
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  格式化打印函数，类似标准printf
+ * @param  format 格式化字符串
+ * @param  ... 可变参数
+ * @note   见 VPrintf
+ */
+void Uart::Printf(const char *format, ...) 
+{ 
+  va_list args;
+  va_start(args, format);
+  VPrintf(format, args);
+  va_end(args);
+}
+
+/*==================== 轻量格式化 ====================*/
+
+/**
+ * @brief 一个转换说明符解析后的格式
+ */
+struct UartFormatSpec
+{
+  uint8_t width;       // 最小宽度,不超过 UART_FMT_MAX_WIDTH
+  int8_t precision;    // 精度,-1 表示未指定
+  bool leftAlign;      // '-'
+  bool zeroPad;        // '0'
+  bool forceSign;      // '+'
+};
+
+static const uint8_t UART_FMT_MAX_WIDTH = 32;      // 最大宽度
+static const uint8_t UART_FMT_MAX_FLOAT_PREC = 9;  // 浮点最大精度
+static const uint8_t UART_FMT_FIELD_MAX = 40;      // 一个字段的最大长度
+
+static const uint32_t kPow10[UART_FMT_MAX_FLOAT_PREC + 1] = {
+  1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+/**
+ * @brief 计算无符号数在给定进制下的位数
+ */
+static uint8_t UartFmtDigits(uint64_t value, uint8_t base)
+{
+  uint8_t digits = 1;
+  while (value >= base)
+  {
+    value /= base;
+    digits++;
+  }
+  return digits;
+}
+
+/**
+ * @brief 从 end 向前写入 digits 位数字
+ */
+static void UartFmtRenderDigits(char* end, uint64_t value, uint8_t digits, uint8_t base, bool upper)
+{
+  const char* table = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  while (digits-- > 0)
+  {
+    *--end = table[value % base];
+    value /= base;
+  }
+}
+
+/**
+ * @brief 把一个数字字段写入 dst,长度必须为 UartFmtFieldLen 的结果
+ * @param intValue 整数部分
+ * @param fracValue 小数部分(已按精度缩放)
+ * @param fracDigits 小数位数,0 表示没有小数点
+ */
+static void UartFmtRenderNumber(char* dst, uint16_t fieldLen, const UartFormatSpec& spec, char sign,
+                                uint64_t intValue, uint8_t intDigits, uint8_t base, bool upper,
+                                uint32_t fracValue, uint8_t fracDigits)
+{
+  uint16_t coreLen = (sign ? 1 : 0) + intDigits + (fracDigits ? 1 + fracDigits : 0);
+  uint16_t pad = fieldLen - coreLen;
+  char* p = dst;
+
+  if (!spec.leftAlign && !spec.zeroPad)
+  {
+    memset(p, ' ', pad);
+    p += pad;
+  }
+  if (sign)
+  {
+    *p++ = sign;
+  }
+  if (!spec.leftAlign && spec.zeroPad)
+  {
+    memset(p, '0', pad);
+    p += pad;
+  }
+  p += intDigits;
+  UartFmtRenderDigits(p, intValue, intDigits, base, upper);
+  if (fracDigits)
+  {
+    *p++ = '.';
+    p += fracDigits;
+    UartFmtRenderDigits(p, fracValue, fracDigits, 10, false);
+  }
+  if (spec.leftAlign)
+  {
+    memset(p, ' ', pad);
+  }
+}
+
+/**
+ * @brief  输出一段文本
+ * @return 实际写入的字节数
+ */
+uint32_t Uart::PutText(const char* text, size_t len)
+{
+  if (len == 0)
+  {
+    return 0;
+  }
+  return SendData(reinterpret_cast<const uint8_t*>(text), len).value;
+}
+
+/**
+ * @brief  输出一个数字字段
+ * @note   连续空间足够时直接写入预留的发送缓冲区,否则写入栈上的小缓冲区再发送
+ * @return 实际写入的字节数
+ */
+uint32_t Uart::PutNumber(const UartFormatSpec& spec, char sign, uint64_t intValue, uint8_t base, bool upper,
+                         uint32_t fracValue, uint8_t fracDigits)
+{
+  uint8_t intDigits = UartFmtDigits(intValue, base);
+  uint16_t coreLen = (sign ? 1 : 0) + intDigits + (fracDigits ? 1 + fracDigits : 0);
+  uint16_t fieldLen = (spec.width > coreLen) ? spec.width : coreLen;
+
+  uint8_t idx = 0;
+  uint8_t* dst = ReserveTx(fieldLen, idx);
+  if (dst != nullptr)
+  {
+    UartFmtRenderNumber(reinterpret_cast<char*>(dst), fieldLen, spec, sign, intValue, intDigits, base, upper, fracValue, fracDigits);
+    PublishTx(idx);
+    return fieldLen;
+  }
+
+  // 当前缓冲区的连续空间不够,退回栈上的字段缓冲区
+  char field[UART_FMT_FIELD_MAX];
+  UartFmtRenderNumber(field, fieldLen, spec, sign, intValue, intDigits, base, upper, fracValue, fracDigits);
+  return PutText(field, fieldLen);
+}
+
+/**
+ * @brief  格式化输出,直接写入发送缓冲区
+ * @param  format 格式化字符串
+ * @param  args 参数列表
+ * @return BspResult<uint32_t> 输出的字节数
+ * @note   - 不使用 vsnprintf,没有中间缓冲区,输出长度不受限制
+ *         - 普通文本从格式串直接拷入发送缓冲区,数字直接在预留的发送缓冲区中生成
+ *         - 支持 %d %i %u %o %x %X %c %s %f %p %%,标志 '-' '0' '+',宽度(最大32),精度,长度 h hh l ll z
+ *         - %f 为定点输出,精度默认 6,最大 9,末位四舍五入,整数部分超出 64 位时输出 "ovf";
+ *           %e %g %a 按 %f 输出
+ *         - %n 只消耗参数,不写回;无法确定参数类型的说明符及其后的格式串原样输出,不再格式化
+ *         - 任务中调用时整个调用持有互斥量,多个任务的输出不会交错;中断中和调度器启动前不加锁
+ */
+BspResult<uint32_t> Uart::VPrintf(const char* format, va_list args)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, uint32_t);
+  BSP_CHECK(format != nullptr, BspError::InvalidParam, uint32_t);
+
+  bool locked = false;
+  if (printfMutex != nullptr && __get_IPSR() == 0U && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+  {
+    locked = (xSemaphoreTake(printfMutex, portMAX_DELAY) == pdTRUE);
+  }
+
+  uint32_t total = 0;
+  const char* p = format;
+
+  while (*p != '\0')
+  {
+    // 普通文本整段输出
+    const char* run = p;
+    while (*p != '\0' && *p != '%')
+    {
+      p++;
+    }
+    total += PutText(run, p - run);
+    if (*p == '\0')
+    {
+      break;
+    }
+
+    const char* specStart = p++;
+    UartFormatSpec spec = {0, -1, false, false, false};
+
+    // 标志
+    for (;; p++)
+    {
+      if (*p == '-') spec.leftAlign = true;
+      else if (*p == '0') spec.zeroPad = true;
+      else if (*p == '+') spec.forceSign = true;
+      else break;
+    }
+    // 宽度
+    uint32_t width = 0;
+    while (*p >= '0' && *p <= '9')
+    {
+      width = width * 10 + (*p++ - '0');
+    }
+    spec.width = (width > UART_FMT_MAX_WIDTH) ? UART_FMT_MAX_WIDTH : width;
+    // 精度
+    if (*p == '.')
+    {
+      p++;
+      uint32_t precision = 0;
+      while (*p >= '0' && *p <= '9')
+      {
+        precision = precision * 10 + (*p++ - '0');
+      }
+      spec.precision = (precision > 127) ? 127 : precision;
+    }
+    // 长度
+    uint8_t longness = 0; // 0: int, 1: long, 2: long long, 3: size_t, 4: short, 5: char
+    while (*p == 'h' || *p == 'l' || *p == 'z')
+    {
+      if (*p == 'l') longness = (longness == 1) ? 2 : 1;
+      else if (*p == 'h') longness = (longness == 4) ? 5 : 4;
+      else if (*p == 'z') longness = 3;
+      p++;
+    }
+
+    char conv = *p;
+    if (conv == '\0')
+    {
+      total += PutText(specStart, p - specStart);
+      break;
+    }
+    p++;
+
+    switch (conv)
+    {
+      case 'd':
+      case 'i':
+      {
+        int64_t value;
+        if (longness == 2)      value = va_arg(args, long long);
+        else if (longness == 1) value = va_arg(args, long);
+        else if (longness == 3) value = (int64_t)va_arg(args, size_t);
+        else if (longness == 4) value = (short)va_arg(args, int);
+        else if (longness == 5) value = (signed char)va_arg(args, int);
+        else                    value = va_arg(args, int);
+        char sign = (value < 0) ? '-' : (spec.forceSign ? '+' : 0);
+        uint64_t magnitude = (value < 0) ? (0 - (uint64_t)value) : (uint64_t)value;
+        total += PutNumber(spec, sign, magnitude, 10, false, 0, 0);
+        break;
+      }
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      {
+        uint64_t value;
+        if (longness == 2)      value = va_arg(args, unsigned long long);
+        else if (longness == 1) value = va_arg(args, unsigned long);
+        else if (longness == 3) value = va_arg(args, size_t);
+        else if (longness == 4) value = (unsigned short)va_arg(args, unsigned int);
+        else if (longness == 5) value = (unsigned char)va_arg(args, unsigned int);
+        else                    value = va_arg(args, unsigned int);
+        uint8_t base = (conv == 'u') ? 10 : ((conv == 'o') ? 8 : 16);
+        total += PutNumber(spec, 0, value, base, conv == 'X', 0, 0);
+        break;
+      }
+      case 'p':
+      {
+        uintptr_t value = (uintptr_t)va_arg(args, void*);
+        total += PutText("0x", 2);
+        UartFormatSpec ptrSpec = {8, -1, false, true, false};
+        total += PutNumber(ptrSpec, 0, value, 16, false, 0, 0);
+        break;
+      }
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        double value = va_arg(args, double);
+        uint8_t fracDigits = (spec.precision < 0) ? 6 : spec.precision;
+        if (fracDigits > UART_FMT_MAX_FLOAT_PREC)
+        {
+          fracDigits = UART_FMT_MAX_FLOAT_PREC;
+        }
+        if (value != value)
+        {
+          total += PutText("nan", 3);
+          break;
+        }
+        char sign = (value < 0) ? '-' : (spec.forceSign ? '+' : 0);
+        double magnitude = (value < 0) ? -value : value;
+        if (magnitude >= 1.8e19)
+        {
+          total += PutText((value < 0) ? "-ovf" : "ovf", (value < 0) ? 4 : 3);
+          break;
+        }
+        uint64_t intPart = (uint64_t)magnitude;
+        uint32_t fracPart = (uint32_t)((magnitude - (double)intPart) * kPow10[fracDigits] + 0.5);
+        if (fracPart >= kPow10[fracDigits])
+        {
+          fracPart -= kPow10[fracDigits];
+          intPart++;
+        }
+        total += PutNumber(spec, sign, intPart, 10, false, fracPart, fracDigits);
+        break;
+      }
+      case 'c':
+      {
+        char c = (char)va_arg(args, int);
+        total += PutText(&c, 1);
+        break;
+      }
+      case 's':
+      {
+        const char* str = va_arg(args, const char*);
+        if (str == nullptr)
+        {
+          str = "(null)";
+        }
+        size_t len = strlen(str);
+        if (spec.precision >= 0 && (size_t)spec.precision < len)
+        {
+          len = spec.precision;
+        }
+        static const char spaces[UART_FMT_MAX_WIDTH + 1] = "                                ";
+        size_t pad = (spec.width > len) ? (spec.width - len) : 0;
+        if (!spec.leftAlign)
+        {
+          total += PutText(spaces, pad);
+        }
+        total += PutText(str, len);
+        if (spec.leftAlign)
+        {
+          total += PutText(spaces, pad);
+        }
+        break;
+      }
+      case 'n':
+        (void)va_arg(args, void*);
+        break;
+      case '%':
+        total += PutText("%", 1);
+        break;
+      default:
+        // 不知道参数的类型,后面的参数无法对齐,剩余格式串原样输出
+        total += PutText(specStart, strlen(specStart));
+        p = "";
+        break;
+    }
+  }
+
+  KickTx();
+  if (locked)
+  {
+    xSemaphoreGive(printfMutex);
+  }
+  return BspResult<uint32_t>::success(total);
+}
+
+/**
+ * @brief  替换接收环形缓冲区
+ * @param  buffer 缓冲区,必须在整个接收期间保持有效(通常为静态存储)
+ * @param  size 缓冲区大小,必须为偶数,半传输事件在 size/2 处触发
+ * @return BspResult<bool> 操作结果
+ * @note   必须在 EnableRxDMA 之前调用。缓冲区越大,消费者允许的处理延迟越长:
+ *         消费者必须在 DMA 写满半个缓冲区之前释放数据
+ */
+BspResult<bool> Uart::SetRxBuffer(uint8_t* buffer, uint16_t size)
+{
+  BSP_CHECK(buffer != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(size >= 8 && (size & 1U) == 0, BspError::InvalidParam, bool);
+  BSP_CHECK(!rxEnabled, BspError::DeviceBusy, bool);
+
+  rxBuffer = buffer;
+  rxBufferSize = size;
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  启动UART的环形DMA接收
+ * @return BspResult<bool> 操作结果
+ * @note   - DMA 以环形模式不停地写入接收缓冲区,不会因为重启接收出现丢字节的盲区
+ *         - IDLE、半传输、传输完成三种事件都会进入 RxEventCallback,
+ *           因此消费者最迟在半个缓冲区写满时得到通知
+ *         - 重新启动时丢弃所有未读数据
+ */
+BspResult<bool> Uart::EnableRxDMA()
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(huart->hdmarx != nullptr, BspError::InvalidDevice, bool);
+  BSP_CHECK(rxFrameLen == 0, BspError::DeviceBusy, bool); // 已经用于定长帧接收
+
+  // CubeMX 配置为普通模式时改为环形模式
+  if (huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+  {
+    huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+    HAL_StatusTypeDef dmaStatus = HAL_DMA_Init(huart->hdmarx);
+    if (dmaStatus != HAL_OK)
+    {
+      return BspResult<bool>::failure(BspErrorFromHalStatus(dmaStatus), false, {__FILE__, __LINE__, __func__});
+    }
+  }
+
+  // DMA 从缓冲区起点重新开始写入,未读数据作废
+  __disable_irq();
+  rxDroppedBytes += rxWritten - rxReleased;
+  rxReleased = rxWritten;
+  rxReadPos = 0;
+  lastDmaRxPos = 0;
+  rxIdle = true;
+  __enable_irq();
+
+  HAL_StatusTypeDef status = HAL_UARTEx_ReceiveToIdle_DMA(huart, rxBuffer, rxBufferSize);
+  if (status != HAL_OK)
+  {
+    rxEnabled = false;
+    return BspResult<bool>::failure(BspErrorFromHalStatus(status), false, {__FILE__, __LINE__, __func__});
+  }
+  rxEnabled = true;
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  启动双缓冲定长帧接收,用于遥控器接收机这类固定长度、帧间有空闲的链路
+ * @param  buffer0 帧缓冲区0
+ * @param  buffer1 帧缓冲区1
+ * @param  frameLen 帧长,两个缓冲区都恰好容纳一帧
+ * @param  callback 帧回调,在中断中调用
+ * @param  ctx 透传给帧回调的上下文
+ * @return BspResult<bool> 操作结果
+ * @note   - DMA 工作在双缓冲模式,每写满一帧硬件自动切换到另一个缓冲区,
+ *           回调拿到的帧在下一帧写满之前不会被覆盖,不需要拷贝
+ *         - 帧对齐时 IDLE 出现在 DMA 刚切换缓冲区、一个字节都没写入的时刻,HAL 不会上报;
+ *           IDLE 时 DMA 停在帧中间说明帧与缓冲区错位,驱动从下一帧的起点重新对齐并以 nullptr 通知
+ *         - 缓冲区不能位于 CCM RAM;启动后环形接收相关的接口不再使用,EnableRxDMA 返回 DeviceBusy
+ */
+BspResult<bool> Uart::EnableRxFrameDMA(uint8_t* buffer0, uint8_t* buffer1, uint16_t frameLen,
+                                       UartFrameCallback_t callback, void* ctx)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(huart->hdmarx != nullptr, BspError::InvalidDevice, bool);
+  BSP_CHECK(buffer0 != nullptr && buffer1 != nullptr && buffer0 != buffer1, BspError::InvalidParam, bool);
+  BSP_CHECK(frameLen > 0 && callback != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(!rxEnabled, BspError::DeviceBusy, bool);
+
+  rxFrameBuffers[0] = buffer0;
+  rxFrameBuffers[1] = buffer1;
+  rxFrameCallback = callback;
+  rxFrameCtx = ctx;
+  rxFrameLen = frameLen;
+
+  return StartRxFrameDMA();
+}
+
+/**
+ * @brief  启动(或在错误后重启)双缓冲定长帧接收
+ * @return BspResult<bool> 操作结果
+ * @note   先由 HAL 按 IDLE 接收启动,打开 DMAR、IDLE 与错误中断,再把数据流改为双缓冲模式
+ */
+BspResult<bool> Uart::StartRxFrameDMA()
+{
+  // 双缓冲模式下硬件忽略 CIRC,但 HAL 的接收完成处理按 Init.Mode 和 CIRC 判断是否结束接收
+  if (huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+  {
+    huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+    HAL_StatusTypeDef dmaStatus = HAL_DMA_Init(huart->hdmarx);
+    if (dmaStatus != HAL_OK)
+    {
+      return BspResult<bool>::failure(BspErrorFromHalStatus(dmaStatus), false, {__FILE__, __LINE__, __func__});
+    }
+  }
+
+  HAL_StatusTypeDef status = HAL_UARTEx_ReceiveToIdle_DMA(huart, rxFrameBuffers[0], rxFrameLen);
+  if (status != HAL_OK)
+  {
+    rxEnabled = false;
+    return BspResult<bool>::failure(BspErrorFromHalStatus(status), false, {__FILE__, __LINE__, __func__});
+  }
+
+  // 缓冲区1写满时 HAL 调用 XferM1CpltCallback,与缓冲区0一样交给 UART 的接收完成处理
+  huart->hdmarx->XferM1CpltCallback = huart->hdmarx->XferCpltCallback;
+  __disable_irq();
+  AlignRxFrame();
+  __enable_irq();
+  rxEnabled = true;
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  停止数据流并让DMA从缓冲区0的起点重新开始,同时打开双缓冲模式
+ * @note   在中断中或关中断时调用。停止数据流只需要等当前一个字节的传输结束;
+ *         停止期间到达的字节留在数据寄存器中,重新使能后立即被搬走
+ */
+void Uart::AlignRxFrame()
+{
+  DMA_HandleTypeDef* hdma = huart->hdmarx;
+  DMA_Stream_TypeDef* stream = hdma->Instance;
+
+  __HAL_DMA_DISABLE(hdma);
+  while ((stream->CR & DMA_SxCR_EN) != 0U)
+  {
+  }
+  __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma) | __HAL_DMA_GET_HT_FLAG_INDEX(hdma) |
+                             __HAL_DMA_GET_TE_FLAG_INDEX(hdma) | __HAL_DMA_GET_DME_FLAG_INDEX(hdma) |
+                             __HAL_DMA_GET_FE_FLAG_INDEX(hdma));
+
+  stream->M0AR = reinterpret_cast<uint32_t>(rxFrameBuffers[0]);
+  stream->M1AR = reinterpret_cast<uint32_t>(rxFrameBuffers[1]);
+  stream->NDTR = rxFrameLen;
+  // 只需要传输完成中断,半传输中断关闭
+  stream->CR = (stream->CR & ~(DMA_SxCR_CT | DMA_SxCR_HTIE)) | DMA_SxCR_DBM | DMA_SxCR_CIRC;
+
+  __HAL_DMA_ENABLE(hdma);
+}
+
+/**
+ * @brief  定长帧接收模式的接收事件
+ * @param  size 传输完成时为帧长,IDLE 时为本帧已收到的字节数
+ * @note   由 InvokeRxCallback 在中断中调用
+ */
+void Uart::RxFrameEvent(uint16_t size)
+{
+  if (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_TC)
+  {
+    // CT 已经指向 DMA 正在写入的缓冲区,刚写满的是另一个
+    uint8_t done = ((huart->hdmarx->Instance->CR & DMA_SxCR_CT) != 0U) ? 0U : 1U;
+    rxFrameCallback(rxFrameCtx, rxFrameBuffers[done], rxFrameLen);
+    return;
+  }
+
+  // IDLE 时DMA停在帧中间:丢弃这部分字节,下一帧从缓冲区0的起点写入
+  AlignRxFrame();
+  rxFrameCallback(rxFrameCtx, nullptr, size);
+}
+
+/**
+ * @brief  获取当前未读的字节数
+ */
+uint32_t Uart::GetRxAvailable() const
+{
+  return rxWritten - rxReleased;
+}
+
+/**
+ * @brief  获取一段连续的未读数据,直接指向接收环形缓冲区,不拷贝
+ * @param  data 用于接收数据起始地址的引用
+ * @return BspResult<uint32_t> 连续数据的长度,为 0 表示没有未读数据
+ * @note   数据在回绕处分为两段,处理完第一段并 ReleaseRx 后再次调用得到第二段
+ *         接收错误恢复时未读数据会被挪到缓冲区末尾,处理期间发生恢复时已取得的数据可能失效,
+ *         但 ReleaseRx 按字节数释放,仍然正确
+ */
+BspResult<uint32_t> Uart::PeekRx(const uint8_t*& data)
+{
+  BSP_CHECK(rxBuffer != nullptr, BspError::NullHandle, uint32_t);
+
+  __disable_irq();
+  uint32_t available = rxRelocating ? 0 : (rxWritten - rxReleased);
+  uint16_t readPos = rxReadPos;
+  __enable_irq();
+
+  uint32_t contiguous = rxBufferSize - readPos;
+  data = &rxBuffer[readPos];
+  return BspResult<uint32_t>::success((available < contiguous) ? available : contiguous);
+}
+
+/**
+ * @brief  释放已经处理的数据,把空间还给DMA
+ * @param  len 释放的字节数,不能超过未读字节数
+ * @return BspResult<bool> 操作结果
+ */
+BspResult<bool> Uart::ReleaseRx(uint32_t len)
+{
+  __disable_irq();
+  if (len > rxWritten - rxReleased)
   {
-    __HAL_DMA_DISABLE_IT(huart->hdmarx, DMA_IT_HT);
+    // 期间发生了覆盖或重新启动,数据已经被丢弃
+    __enable_irq();
+    return BspResult<bool>::failure(BspError::InvalidParam, false, {__FILE__, __LINE__, __func__});
   }
-
-  __enable_irq();  // 退出临界区
+  uint32_t pos = rxReadPos + len;
+  rxReadPos = (pos >= rxBufferSize) ? (pos - rxBufferSize) : pos;
+  rxReleased += len;
+  __enable_irq();
 
   return BspResult<bool>::success(true);
 }
 
 /**
- * @brief  向发送缓冲区写入数据，使用乒乓缓存机制
- * @param  data 要发送的数据指针
- * @param  size 要发送的数据大小
- * @return BspResult<uint32_t> 操作结果，成功返回实际写入缓冲区的数据大小
+ * @brief  从接收环形缓冲区拷贝并释放最多 maxLen 字节
+ * @param  data 用于接收数据的缓冲区
+ * @param  maxLen 最多拷贝的字节数
+ * @return BspResult<uint32_t> 实际拷贝的字节数
+ * @note   回绕处最多分两段拷贝;需要就地处理数据时使用 PeekRx/ReleaseRx
  */
-BspResult<uint32_t> Uart::SendData(const uint8_t* data, size_t size) 
+BspResult<uint32_t> Uart::ReceiveData(uint8_t* data, uint32_t maxLen)
 {
-  BSP_CHECK(huart != nullptr, BspError::NullHandle, uint32_t);
   BSP_CHECK(data != nullptr, BspError::InvalidParam, uint32_t);
-  BSP_CHECK(size > 0, BspError::InvalidParam, uint32_t);
-
-  size_t originalSize = size;
 
-  while (size > 0)
+  uint32_t copied = 0;
+  while (copied < maxLen)
   {
-    __disable_irq();
-    uint8_t idx = fillIndex;
-    uint16_t count = txBufferCounts[idx];
-
-    // 如果当前缓冲区已满
-    if (count >= TX_BUFFER_SIZE)
+    const uint8_t* span = nullptr;
+    uint32_t len = PeekRx(span).value;
+    if (len == 0)
     {
-      if (!txDmaBusyFlag)
-      {
-        // DMA空闲，立即发送当前满的缓冲区，并切换到另一个
-        StartDmaTx(idx);
-        __enable_irq();
-        continue; // 重新进入循环，此时 fillIndex 已切换，count 应为 0
-      }
-      else
-      {
-        // DMA忙，且当前缓冲区已满。必须等待DMA释放另一个缓冲区。
-        __enable_irq();
-        vTaskDelay(1); // 避免死循环占用CPU
-        continue; // 忙等待
-      }
+      break;
     }
-
-    // 计算本次能写入的空间
-    uint16_t space = TX_BUFFER_SIZE - count;
-    uint16_t chunk = (size < space) ? size : space; // 本次写入的数据块大小
-
-    memcpy(&txBuffers[idx][count], data, chunk);
-    txBufferCounts[idx] += chunk;
-    data += chunk;
-    size -= chunk;
-
-    // 如果填满了缓冲区，且DMA空闲，立即发送
-    if (txBufferCounts[idx] >= TX_BUFFER_SIZE)
+    if (len > maxLen - copied)
     {
-      if (!txDmaBusyFlag)
-      {
-        StartDmaTx(idx);
-      }
+      len = maxLen - copied;
     }
-
-    __enable_irq();
-  }
-
-  // 数据全部写入后，如果还有剩余数据未发送且DMA空闲，触发发送
-  __disable_irq();
-  if (!txDmaBusyFlag && txBufferCounts[fillIndex] > 0)
-  {
-    StartDmaTx(fillIndex);
+    memcpy(data + copied, span, len);
+    if (!ReleaseRx(len).ok())
+    {
+      break;
+    }
+    copied += len;
   }
-  __enable_irq();
 
-  return BspResult<uint32_t>::success(originalSize);
+  return BspResult<uint32_t>::success(copied);
 }
 
-
 /**
- * @brief  启动DMA发送指定索引的缓冲区
- * @param  index 缓冲区索引 (0 或 1)
- * @note   内部函数，必须在临界区内调用
+ * @brief  DMA接收事件回调的核心处理函数 (IDLE、半传输或传输完成)
+ * @param  size DMA当前在接收缓冲区中的写入位置,传输完成时等于缓冲区大小
+ * @return 本次事件新到达的字节数
+ * @note   由蹦床函数在中断上下文中调用
+ *         - 环形DMA不需要重启,只推进写入计数
+ *         - 消费者没有及时释放导致未读数据被覆盖时,丢弃全部未读数据并计数
  */
-void Uart::StartDmaTx(uint8_t index)
+uint16_t Uart::RxEventCallback(uint16_t size)
 {
-  if (txBufferCounts[index] == 0)
-  {
-    return;
-  } 
+  rxIdle = (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_IDLE);
+  return AdvanceRx((size >= rxBufferSize) ? 0 : size);
+}
 
-  txDmaBusyFlag = true;
-  
-  // 启动DMA传输
-  HAL_StatusTypeDef status = HAL_UART_Transmit_DMA(huart, txBuffers[index], txBufferCounts[index]);
+/**
+ * @brief  按DMA在接收缓冲区中的写入位置推进写入计数
+ * @param  pos DMA当前的写入位置,小于缓冲区大小
+ * @return 新到达的字节数,发生覆盖时为 0
+ * @note   在中断中或关中断时调用
+ */
+uint16_t Uart::AdvanceRx(uint16_t pos)
+{
+  uint16_t last = lastDmaRxPos;
+  uint16_t delta = (pos >= last) ? (pos - last) : (pos + rxBufferSize - last);
+  lastDmaRxPos = pos;
 
-  if (status != HAL_OK)
+  if (delta == 0)
   {
-    txDmaBusyFlag = false;
+    return 0;
   }
-  else
+
+  uint32_t pending = rxWritten - rxReleased;
+  rxWritten += delta;
+  if (pending + delta > rxBufferSize)
   {
-    // 成功启动后，切换填充索引到另一个缓冲区，并重置其计数
-    // 这样上层应用可以继续填充新的缓冲区，而DMA在后台发送旧的
-    fillIndex = 1 - index;
-    txBufferCounts[fillIndex] = 0;
+    rxDroppedBytes += pending + delta;
+    rxReleased = rxWritten;
+    rxReadPos = pos;
+    return 0;
   }
+  return delta;
 }
 
 /**
- * @brief  DMA发送完成中断回调的核心处理函数
+ * @brief  处理UART错误,计数并续接接收
  * @note   由蹦床函数在中断上下文中调用
- *         - 检查当前填充缓冲区是否有数据
- *         - 如果有，立即启动发送
- *         - 如果没有，标记DMA为空闲
+ *         - 按错误种类计数后清除错误标志 (ORE, FE, NE, PE)
+ *         - 任一方向的 DMA 错误都会让 HAL 同时结束发送(gState 为 READY),
+ *           此时放弃当前发送传输,乒乓缓冲与零拷贝队列继续发送,否则 SendData 会一直等待
+ *         - DMA 接收时任何错误都会让 HAL 中止接收,此时环形接收从中止处续接,
+ *           未读数据保留;定长帧接收从缓冲区0重新对齐
  */
-void Uart::TxCpltCallback()
+void Uart::HandleError()
 {
-  // DMA刚刚完成了上一个缓冲区的发送
-  // 检查当前正在填充的缓冲区是否有数据需要发送
-  // 注意：fillIndex 指向的是当前正在填充（或等待填充）的缓冲区
-  // 如果它有数据，说明在DMA发送期间，应用层已经填了一些数据进去
-  
-  uint8_t idx = fillIndex;
-  if (txBufferCounts[idx] > 0)
+  if (huart == nullptr) return;
+
+  uint32_t errCode = huart->ErrorCode;
+  huart->ErrorCode = HAL_UART_ERROR_NONE;
+
+  if (errCode & HAL_UART_ERROR_ORE) errorStats.overrun++;
+  if (errCode & HAL_UART_ERROR_FE) errorStats.framing++;
+  if (errCode & HAL_UART_ERROR_NE) errorStats.noise++;
+  if (errCode & HAL_UART_ERROR_PE) errorStats.parity++;
+  if (errCode & HAL_UART_ERROR_DMA) errorStats.dma++;
+
+  if (errCode & (HAL_UART_ERROR_ORE | HAL_UART_ERROR_FE | HAL_UART_ERROR_NE | HAL_UART_ERROR_PE))
   {
-    // 立即启动发送当前缓冲区
-    // StartDmaTx 会切换 fillIndex，所以下一次填充会去用刚才发送完的那个缓冲区
-    StartDmaTx(idx);
+    // 读 SR 再读 DR 清除标志,DMA 请求已经被 HAL 关闭,不会和 DMA 抢数据
+    __HAL_UART_CLEAR_OREFLAG(huart);
+    __HAL_UART_CLEAR_FEFLAG(huart);
+    __HAL_UART_CLEAR_NEFLAG(huart);
+    __HAL_UART_CLEAR_PEFLAG(huart);
+  }
+
+  // 发送DMA被 HAL 结束而驱动仍认为在发送时续接发送;数据流停止后从DMA中断再次进入这里
+  if ((errCode & HAL_UART_ERROR_DMA) && txDmaBusyFlag && huart->gState == HAL_UART_STATE_READY)
+  {
+    txDmaError = true;
+  }
+  if (txDmaError)
+  {
+    BspResult<bool> txRes = ResumeTxDMA();
+    if (txRes.ok() && txRes.value)
+    {
+      errorStats.txRecoveries++;
+    }
+  }
+
+  // 只有 HAL 已经停止接收(RxState 为 READY)时才续接
+  if (!rxEnabled || huart->RxState != HAL_UART_STATE_READY)
+  {
+    return;
+  }
+
+  BspResult<bool> res = (rxFrameLen != 0) ? StartRxFrameDMA() : ResumeRxDMA();
+  if (res.ok())
+  {
+    // value 为 false 表示要等 DMA 停止后在 DMA 中断中续接,届时再计数
+    if (res.value)
+    {
+      errorStats.recoveries++;
+    }
   }
   else
   {
-    // 没有数据要发送，标记为空闲
-    txDmaBusyFlag = false;
+    errorStats.recoveryFailures++;
   }
 }
 
 /**
- * @brief  设置用户自定义的发送完成回调函数
- * @param  _userCallback 用户提供的回调函数指针
- * @return BspResult<bool> 操作结果
+ * @brief  接收DMA中止完成回调,数据流停止后再次进入错误处理续接接收
+ * @param  hdma 接收DMA句柄,Parent 为所属的UART句柄
+ * @note   在DMA中断中调用,ErrorCode 已经清除,HandleError 只续接不计错误
  */
-BspResult<bool> Uart::SetTxCallback(UartTxCallback_t _userCallback)
+static void Uart_RxDmaAbortCplt(DMA_HandleTypeDef* hdma)
 {
-  BSP_CHECK(_userCallback != nullptr, BspError::InvalidParam, bool);
-  BSP_CHECK(deviceID != DEVICE_NONE, BspError::InvalidDevice, bool);
-
-  userTxCpltCallback = _userCallback;
-  
-  return BspResult<bool>::success(true);
+  Uart_ErrorCallback_Trampoline(hdma->Parent);
 }
 
 /**
- * @brief  格式化打印函数，类似标准printf
- * @param  format 格式化字符串
- * @param  ... 可变参数
- * @return BspResult<bool> 操作结果
- * @note   内部使用一个临时栈缓冲区来格式化字符串，然后调用SendData
+ * @brief  发送DMA中止完成回调,数据流停止后再次进入错误处理续接发送
+ * @param  hdma 发送DMA句柄,Parent 为所属的UART句柄
  */
-void Uart::Printf(const char *format, ...) 
-{ 
-  char txBufferTemp[128];  
-  va_list args;
-  va_start(args, format);
-  vsnprintf(txBufferTemp, sizeof(txBufferTemp), format, args); // 格式化字符串
-  va_end(args);
-
-  SendData((uint8_t *)txBufferTemp, strlen(txBufferTemp));
+static void Uart_TxDmaAbortCplt(DMA_HandleTypeDef* hdma)
+{
+  Uart_ErrorCallback_Trampoline(hdma->Parent);
 }
 
 /**
- * @brief  启动UART的DMA接收
- * @return BspResult<bool> 操作结果
- * @note   使用IDLE线空闲检测模式，配合DMA临时缓冲区
+ * @brief  发送DMA出错后放弃当前传输并续接发送
+ * @return BspResult<bool> 操作结果, value 为 false 表示数据流还在停止中,续接推迟到DMA中断
+ * @note   在中断中调用
+ *         1. 出错的是接收数据流或只有 FIFO 错误时发送数据流可能仍在运行,用 HAL_DMA_Abort_IT 停止,
+ *            不会再产生发送完成中断,停止完成后由 Uart_TxDmaAbortCplt 再次进入这里
+ *         2. 关闭 DMAT,当前缓冲区中未发出的数据丢弃,当前零拷贝请求以 ok = false 结束
+ *         3. 与发送完成相同,继续发送排队的数据并唤醒等待的任务
  */
-BspResult<bool> Uart::EnableRxDMA(bool circular)
+BspResult<bool> Uart::ResumeTxDMA()
 {
-  BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
-
-  rxCircularMode = circular;
+  DMA_HandleTypeDef* hdma = huart->hdmatx;
 
-  HAL_StatusTypeDef status = HAL_UARTEx_ReceiveToIdle_DMA(huart, dmaRxBuffer, DMA_RX_BUFFER_SIZE);
-  if (status != HAL_OK)
+  // 中止已经在进行(例如接收方向的中止回调先进入这里),等待发送数据流的中止回调
+  if (hdma != nullptr && hdma->State == HAL_DMA_STATE_ABORT)
   {
-    return BspResult<bool>::failure(BspErrorFromHalStatus(status), false, {__FILE__, __LINE__, __func__});
+    return BspResult<bool>::success(false);
   }
-
-  // 禁用 DMA 半传输中断
-  if (huart->hdmarx != nullptr)
+  if (hdma != nullptr && hdma->State == HAL_DMA_STATE_BUSY)
   {
-    __HAL_DMA_DISABLE_IT(huart->hdmarx, DMA_IT_HT);
+    hdma->XferAbortCallback = Uart_TxDmaAbortCplt;
+    if (HAL_DMA_Abort_IT(hdma) == HAL_OK)
+    {
+      return BspResult<bool>::success(false);
+    }
   }
 
+  CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+  txDmaError = false;
+  TxTransferEnd(false);
   return BspResult<bool>::success(true);
 }
 
-BspResult<uint32_t> Uart::PushToRxBuffer(uint8_t *data, uint16_t len, size_t offset)
-{
-  BSP_CHECK(huart != nullptr, BspError::NullHandle, uint32_t);
-  BSP_CHECK(data != nullptr, BspError::InvalidParam, uint32_t);
-
-  if (offset >= DMA_RX_BUFFER_SIZE) return BspResult<uint32_t>::failure(BspError::InvalidParam, 0, {__FILE__, __LINE__, __func__});
-  if (offset + len > DMA_RX_BUFFER_SIZE) len = DMA_RX_BUFFER_SIZE - offset;
-
-  memcpy(data, &dmaRxBuffer[offset], len);
-
-  return BspResult<uint32_t>::success(len);
-}
-
-
-BspResult<uint32_t> Uart::ReceiveData(uint8_t* data, uint16_t currentDmaPos) 
+/**
+ * @brief  错误中止后续接环形DMA接收
+ * @return BspResult<bool> 操作结果, value 为 false 表示数据流还在停止中,续接推迟到DMA中断
+ * @note   在中断中调用。HAL 中止时 DMA 停在缓冲区中间的某个位置:
+ *         1. 数据流仍在运行(只有 FIFO 错误)时用 HAL_DMA_Abort_IT 停止,不在中断中等待,
+ *            停止完成后由 Uart_RxDmaAbortCplt 再次进入这里
+ *         2. 先把中止前已经写入的字节计入写入计数
+ *         3. DMA 只能从缓冲区起点重新开始(环形模式的重装值就是起点),
+ *            把未读数据挪到缓冲区末尾,让它紧接在 DMA 的新起点之前,不丢弃任何未读数据:
+ *            未读数据在 [读取位置, 中止位置) 内时只搬移这一段;
+ *            已经跨过回绕点时把整个缓冲区循环左移中止位置个字节,[0, 中止位置) 接到末尾
+ *         4. 临界区内只更新计数,搬移在接收DMA停止、开中断时进行,关中断时间与缓冲区大小无关。
+ *            搬移期间 PeekRx 返回 0,其间释放的字节从未读数据的开头扣除,搬移后按剩余字节数定位读取位置
+ *         5. 与接收事件相同,在中断中用新到达的字节数调用接收回调
+ */
+BspResult<bool> Uart::ResumeRxDMA()
 {
-  uint32_t length = 0;
+  DMA_HandleTypeDef* hdma = huart->hdmarx;
 
-    if (!rxCircularMode)
+  // 串口错误由 HAL 中止数据流;只有 FIFO 错误时数据流可能仍在运行
+  if (hdma->State == HAL_DMA_STATE_BUSY)
+  {
+    hdma->XferAbortCallback = Uart_RxDmaAbortCplt;
+    HAL_StatusTypeDef abortStatus = HAL_DMA_Abort_IT(hdma);
+    if (abortStatus != HAL_OK)
     {
-        // 普通模式：直接从 0 读取 currentDmaPos 长度
-        return PushToRxBuffer(data, currentDmaPos, 0);
+      rxEnabled = false;
+      return BspResult<bool>::failure(BspErrorFromHalStatus(abortStatus), false, {__FILE__, __LINE__, __func__});
     }
+    return BspResult<bool>::success(false);
+  }
+  uint16_t remaining = static_cast<uint16_t>(__HAL_DMA_GET_COUNTER(hdma));
+  uint16_t pos = (remaining >= rxBufferSize) ? 0 : static_cast<uint16_t>(rxBufferSize - remaining);
 
-    // Circular 模式处理
-    if (currentDmaPos >= lastDmaRxPos)
+  __disable_irq();
+  uint16_t received = AdvanceRx(pos);
+  uint32_t pending = rxWritten - rxReleased;
+  uint16_t readPos = rxReadPos;
+  if (pending == 0)
+  {
+    rxReadPos = 0;
+  }
+  bool relocate = (pos != 0 && pending != 0);
+  rxRelocating = relocate;
+  lastDmaRxPos = 0;
+  __enable_irq();
+
+  if (relocate)
+  {
+    if (readPos < pos)
     {
-        // 情况 1: 指针向后移动，未卷绕
-        // [ ... lastRxPos ... NewData ... currentDmaPos ... ]
-        length = currentDmaPos - lastDmaRxPos;
-        PushToRxBuffer(data, length, lastDmaRxPos);
+      // 未读数据都在 [readPos, pos) 内,只搬移这一段
+      memmove(&rxBuffer[rxBufferSize - pending], &rxBuffer[readPos], pending);
     }
     else
     {
-        // 情况 2: 指针卷绕
-        // [ NewData2 ... currentDmaPos ... OldData ... lastRxPos ... NewData1 ... End ]
-        
-        // 第一段：lastRxPos -> End
-        uint16_t len1 = DMA_RX_BUFFER_SIZE - lastDmaRxPos;
-        PushToRxBuffer(data, len1, lastDmaRxPos);
-        
-        // 第二段：0 -> currentDmaPos
-        uint16_t len2 = currentDmaPos;
-        PushToRxBuffer(data + len1, len2, 0);
-        
-        length = len1 + len2;
+      // 未读数据为 [readPos, size) 加 [0, pos),左移 pos 后连续地结束在缓冲区末尾
+      std::rotate(rxBuffer, rxBuffer + pos, rxBuffer + rxBufferSize);
     }
 
-    // 更新位置
-    lastDmaRxPos = currentDmaPos;
-    
-    // 处理边界情况：如果 buffer 刚好填满，HAL 库可能会返回 0 或 Size
-    if (lastDmaRxPos == DMA_RX_BUFFER_SIZE) lastDmaRxPos = 0;
+    __disable_irq();
+    uint32_t left = rxWritten - rxReleased;
+    rxReadPos = (left == 0) ? 0 : static_cast<uint16_t>(rxBufferSize - left);
+    rxRelocating = false;
+    __enable_irq();
+  }
+
+  HAL_StatusTypeDef status = HAL_UARTEx_ReceiveToIdle_DMA(huart, rxBuffer, rxBufferSize);
+  if (status != HAL_OK)
+  {
+    rxEnabled = false;
+    return BspResult<bool>::failure(BspErrorFromHalStatus(status), false, {__FILE__, __LINE__, __func__});
+  }
 
-    return BspResult<uint32_t>::success(length);
+  NotifyRx(received);
+  return BspResult<bool>::success(true);
 }
 
 /**
- * @brief  DMA接收事件回调的核心处理函数 (IDLE或缓冲区满)
- * @param  size DMA本次接收到的数据长度
- * @note   由蹦床函数在中断上下文中调用
- *         - 将DMA临时缓冲区的数据写入主接收环形缓冲区
- *         - 重新启动下一次DMA空闲中断接收
+ * @brief  获取接收错误统计
+ * @return UartErrorStats 统计数据的副本
  */
-void Uart::RxEventCallback(uint16_t size)
+UartErrorStats Uart::GetErrorStats() const
 {
-
+  __disable_irq();
+  UartErrorStats stats = errorStats;
+  stats.droppedBytes = rxDroppedBytes;
+  __enable_irq();
+  return stats;
 }
 
 /**
- * @brief  处理UART错误并尝试恢复
- * @note   由蹦床函数在中断上下文中调用
- *         - 清除常见错误标志 (ORE, FE, NE)
- *         - 如果接收中断被关闭，尝试重启DMA接收
+ * @brief  清零接收错误统计与丢弃计数
  */
-void Uart::HandleError()
+void Uart::ResetErrorStats()
 {
-  if (huart == nullptr) return;
-
-  // 1. 获取错误代码
-  uint32_t errCode = huart->ErrorCode;
-
-  // 2. 检查并清除常见错误标志
-  // 这些错误通常会导致接收中断被 HAL 库关闭
-  if (errCode & (HAL_UART_ERROR_ORE | HAL_UART_ERROR_FE | HAL_UART_ERROR_NE))
-  {
-    // 暴力清除标志位
-    __HAL_UART_CLEAR_OREFLAG(huart);
-    __HAL_UART_CLEAR_FEFLAG(huart);
-    __HAL_UART_CLEAR_NEFLAG(huart);
-    
-    // 3. 尝试重启接收
-    // 只有当 HAL 库已经把状态置为 READY (说明它已经停止了接收) 时才重启
-    // 避免在 DMA 还在跑的时候重复开启
-    if (huart->RxState == HAL_UART_STATE_READY)
-    {
-        // 重新开启 DMA 接收 (Circular 模式)
-        // 注意：这里假设我们总是使用 dmaRxBuffer 和 DMA_RX_BUFFER_SIZE
-        // 如果你的应用场景有变化，可能需要记录上次使用的 buffer 和 size
-        memset(dmaRxBuffer, 0, DMA_RX_BUFFER_SIZE);
-        EnableRxDMA(rxCircularMode); 
-    }
-  }
+  __disable_irq();
+  errorStats = UartErrorStats();
+  rxDroppedBytes = 0;
+  __enable_irq();
 }
 
 /**
@@ -476,11 +1573,17 @@ BspResult<bool> Uart::SetRxCallback(UartRxCallback_t _userCallback)
     snprintf(infoBuffer, sizeof(infoBuffer), 
              "===== %s Info =====\n"
              "deviceID: %d\n"
-             "baud: %u\n"
+             "baud: %u, frame: %u%c%u%s\n"
+             "buffers: rx=%u, tx=2x%u\n"
              "Callbacks: Tx=%s, Rx=%s\n"
              "=======================\n",
              UartInstanceName(handle->Instance),
              deviceID, handle->Init.BaudRate,
+             (unsigned)framing.dataBits,
+             (framing.parity == UartParity::Even) ? 'E' : (framing.parity == UartParity::Odd) ? 'O' : 'N',
+             (framing.stopBits == UartStopBits::Two) ? 2U : 1U,
+             framing.over8 ? " OVER8" : "",
+             (unsigned)rxBufferSize, (unsigned)txBufferSize,
              userTxCpltCallback ? "SET" : "NULL", 
              userRxCpltCallback ? "SET" : "NULL");
 
@@ -504,25 +1607,34 @@ void Uart::InvokeTxCallback()
 
 /**
  * @brief  调用内部核心接收回调和用户自定义接收回调
- * @param  size DMA接收到的数据长度
+ * @param  size DMA当前的写入位置,用户回调收到的是新到达的字节数
  * @note   这是一个公共接口，由蹦床函数调用，以保持封装性
  */
 void Uart::InvokeRxCallback(uint16_t size)
 {
-  RxEventCallback(size);
-  if (userRxCpltCallback != nullptr)
+  if (rxFrameLen != 0)
   {
-    userRxCpltCallback(size);
+    RxFrameEvent(size);
+    return;
   }
 
-  if (!rxCircularMode)
+  NotifyRx(RxEventCallback(size));
+}
+
+/**
+ * @brief  用新到达的字节数调用接收回调
+ * @param  received 新到达的字节数,为 0 时不调用
+ * @note   在接收事件或接收错误恢复的中断中调用
+ */
+void Uart::NotifyRx(uint16_t received)
+{
+  if (received > 0 && userRxCpltCallback != nullptr)
+  {
+    userRxCpltCallback(received);
+  }
+  if (received > 0 && rxEventCallback != nullptr)
   {
-    // 1. 停止当前的接收 (这会重置 DMA 计数器)
-    HAL_UART_AbortReceive(huart);
-    
-    // 2. 重新启动接收 (使用相同的模式设置)
-    // 注意：这里会有极短的盲区，但对于 Log/命令行交互是完全可以接受的
-    EnableRxDMA(false);
+    rxEventCallback(rxEventCtx, received);
   }
 }
 
@@ -555,37 +1667,156 @@ void Uart_TxCpltCallback_Trampoline(void *_uartHandle)
   }
 }
 
+/**
+ * @brief  设置带上下文的接收事件回调
+ * @param  callback 回调函数,在中断中调用,参数为新到达的字节数
+ * @param  ctx 透传给回调的上下文
+ * @return BspResult<bool> 操作结果
+ */
+BspResult<bool> Uart::SetRxEventCallback(UartRxEventCallback_t callback, void* ctx)
+{
+  BSP_CHECK(callback != nullptr, BspError::InvalidParam, bool);
+  BSP_CHECK(deviceID != DEVICE_NONE, BspError::InvalidDevice, bool);
+
+  __disable_irq();
+  rxEventCallback = callback;
+  rxEventCtx = ctx;
+  __enable_irq();
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  打开或关闭单线半双工模式
+ * @param  enable true 为单线半双工, TX 引脚同时用于收发
+ * @return BspResult<bool> 操作结果
+ * @note   - 必须在 Init 之后、EnableRxDMA 之前调用,DMA 正在发送时返回 DeviceBusy
+ *         - TX 引脚需要在 CubeMX 中配置为开漏并上拉(或外接上拉)
+ *         - 发送期间接收器会收到自己发出的字节,用 SetReceiverEnabled 在发送期间关闭接收器
+ */
+BspResult<bool> Uart::SetHalfDuplex(bool enable)
+{
+  BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
+  BSP_CHECK(!rxEnabled, BspError::DeviceBusy, bool);
+
+  __disable_irq();
+  // 关闭 UE 会打断正在发送的字节,发送状态由发送完成中断更新,需要在临界区内检查
+  if (txDmaBusyFlag || txReqActive || txReqHead != nullptr)
+  {
+    __enable_irq();
+    return BspResult<bool>::failure(BspError::DeviceBusy, false, {__FILE__, __LINE__, __func__});
+  }
+  __HAL_UART_DISABLE(huart);
+  if (enable)
+  {
+    // HDSEL 要求 LIN、同步时钟、智能卡和红外模式都关闭
+    CLEAR_BIT(huart->Instance->CR2, USART_CR2_LINEN | USART_CR2_CLKEN);
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_SCEN | USART_CR3_IREN);
+    SET_BIT(huart->Instance->CR3, USART_CR3_HDSEL);
+  }
+  else
+  {
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_HDSEL);
+  }
+  __HAL_UART_ENABLE(huart);
+  __enable_irq();
+
+  return BspResult<bool>::success(true);
+}
+
+/**
+ * @brief  打开或关闭接收器
+ * @param  enable true 为打开
+ * @note   只改写 CR1.RE,DMA 接收继续运行;可以在中断中调用,用于半双工总线的方向切换
+ */
+void Uart::SetReceiverEnabled(bool enable)
+{
+  if (huart == nullptr)
+  {
+    return;
+  }
+  if (enable)
+  {
+    ATOMIC_SET_BIT(huart->Instance->CR1, USART_CR1_RE);
+  }
+  else
+  {
+    ATOMIC_CLEAR_BIT(huart->Instance->CR1, USART_CR1_RE);
+  }
+}
+
 /**
  * @brief  清空接收环形缓冲区
  * @return BspResult<bool> 操作结果
+ * @note   只丢弃未读数据,DMA 接收继续运行
  */
 BspResult<bool> Uart::ClearRxBuffer()
 {
-  return BspResult<bool>::success(true);
+  __disable_irq();
+  uint32_t pending = rxWritten - rxReleased;
+  __enable_irq();
+  return ReleaseRx(pending);
 }
 
 /**
  * @brief  清空发送环形缓冲区
  * @return BspResult<bool> 操作结果
- * @note   这是一个危险操作，会停止正在进行的DMA传输
+ * @note   - 这是一个危险操作，会中止正在进行的DMA发送
+ *         - 只中止发送方向,DMA 接收继续运行
+ *         - 被取消的零拷贝请求的完成回调在调用者的上下文中调用
+ *         - 有写者正在拷贝到预留区(预留未发布)时返回 DeviceBusy 且不做任何修改,
+ *           否则下一次预留会与正在进行的拷贝重叠
  */
 BspResult<bool> Uart::ClearTxBuffer()
 {
   BSP_CHECK(huart != nullptr, BspError::NullHandle, bool);
   
-  // 清空发送缓冲区比较危险，需要先停止DMA
+  // 清空发送缓冲区比较危险，需要先停止发送DMA
   __disable_irq();
+
+  if (txWriters[0] != 0 || txWriters[1] != 0)
+  {
+    __enable_irq();
+    return BspResult<bool>::failure(BspError::DeviceBusy, false, {__FILE__, __LINE__, __func__});
+  }
   
-  HAL_StatusTypeDef status = HAL_UART_DMAStop(huart);
+  HAL_StatusTypeDef status = HAL_UART_AbortTransmit(huart);
   
-  // 重置乒乓缓存状态
+  // 重置乒乓缓存状态,此时没有写者持有预留区
   txBufferCounts[0] = 0;
   txBufferCounts[1] = 0;
+  txReserved[0] = 0;
+  txReserved[1] = 0;
   fillIndex = 0;
   txDmaBusyFlag = false;
+  TaskHandle_t waiter = txWaitTask;
+  txWaitTask = nullptr;
+
+  // 取消所有零拷贝请求
+  UartTxRequest* canceled = txReqHead;
+  txReqHead = nullptr;
+  txReqTail = nullptr;
+  txReqActive = false;
   
   __enable_irq();
 
+  if (waiter != nullptr)
+  {
+    xTaskNotifyGive(waiter);
+  }
+
+  while (canceled != nullptr)
+  {
+    UartTxRequest* request = canceled;
+    canceled = request->next;
+    request->next = nullptr;
+    request->pending = false;
+    if (request->done != nullptr)
+    {
+      request->done(request->ctx, false);
+    }
+  }
+
   if (status != HAL_OK)
   {
     return BspResult<bool>::failure(BspErrorFromHalStatus(status), false, {__FILE__, __LINE__, __func__});
@@ -5,7 +5,7 @@
 * @brief
 * 该文件依赖:
 * BspCan.h
-* BspTimer.h
+* B2MW_Timer.hpp
 * MW_Common.hpp
 * MW_RingBuffer.hpp
 * ===========================================================
@@ -17,9 +17,14 @@
 * 2. 定义了 USE_CanBus 枚举，用于表示上层中间件使用的CAN总线。
 * 3. 定义了 MAX_CAN_SUBSCRIPTIONS 常量，用于表示CAN总线上最大可以挂的设备数量。
 * 4. 定义了 CAN_TXQUEUE_SIZE 常量，用于表示CAN总线上最大可以发送的消息数量。
+* 5. 定义了 CanRxDelivery 枚举，用于订阅者选择在中断中还是在CAN工作任务中接收消息。
+* 6. 定义了 CanOnlineCallback_t 类型，用于按CAN ID通知设备的上线/离线。
+* 7. 定义了 CanCyclicSource_t 类型，用于周期发送调度器在发送时刻填充帧内容。
+* 8. 定义了 CanTxToken 结构体，用于跟踪单帧从入队到发送结束的时间与结果。
+* 9. 定义了 CanFilterPlan 结构体，用于由订阅表规划硬件滤波器组。
 * ===========================================================
-* @version   1.2
-* @date      2025-11-14
+* @version   1.8
+* @date      2026-10-18
 * @copyright Copyright (c) 2025
 ============================================================*/
 #ifndef B2MW_CANMANAGER_HPP
@@ -28,7 +33,7 @@
 /*========================= 文件依赖 =========================*/
 
 #include "BspCan.h"
-#include "BspTimer.h"
+#include "B2MW_Timer.hpp"
 #include "MW_Common.hpp"
 #include "MW_RingBuffer.hpp"
 
@@ -45,6 +50,29 @@ enum  USE_CanBus : uint8_t
     USE_CAN_END
 };
 
+/*==================== CAN订阅消息投递方式枚举 ====================*/
+
+/**
+ * @brief 订阅者回调的投递方式枚举
+ * @details
+ *  CAN_DELIVERY_ISR-在CAN接收中断中直接调用回调,延迟最小,回调必须足够短,
+ *                   同一帧的回调超过 CAN_RX_ISR_BUDGET_CYCLES 后剩余的由CAN工作任务调用
+ *  CAN_DELIVERY_TASK_HIGH-帧被推入高优先级队列,由CAN工作任务调用回调
+ *  CAN_DELIVERY_TASK_LOW-帧被推入低优先级队列,高优先级队列为空时才会被处理
+ */
+enum CanRxDelivery : uint8_t
+{
+    CAN_DELIVERY_ISR = 0,
+    CAN_DELIVERY_TASK_HIGH = 1,
+    CAN_DELIVERY_TASK_LOW = 2,
+    CAN_DELIVERY_END
+};
+
+/**
+ * @brief 延迟投递队列的数量(高/低优先级各一个)
+ */
+#define CAN_DEFER_QUEUE_NUM (CAN_DELIVERY_END - CAN_DELIVERY_TASK_HIGH)
+
 /*========================== 宏定义 ==========================*/
 
 /**
@@ -67,15 +95,197 @@ enum  USE_CanBus : uint8_t
  */
 #define CAN_TXMAILBOX_NUM 3
 
+/**
+ * @brief 每个延迟投递队列的深度(帧数)
+ */
+#define CAN_RX_DEFER_QUEUE_SIZE 32
+
+/**
+ * @brief CAN 工作任务的栈深度(字)
+ */
+#define CAN_RX_TASK_STACK_SIZE 512
+
+/**
+ * @brief CAN 工作任务的优先级
+ */
+#define CAN_RX_TASK_PRIORITY osPriorityAboveNormal
+
+/**
+ * @brief CAN 接收中断中执行中断方式回调的预算(DWT周期)
+ * @details 180MHz 下 1800 个周期约为 10us。每个回调执行前检查一次,预算用完后
+ *          剩余的中断方式回调随帧推入高优先级延迟队列,由CAN工作任务执行
+ */
+#define CAN_RX_ISR_BUDGET_CYCLES 1800
+
+/**
+ * @brief 延迟帧中没有剩余中断方式回调的标记
+ */
+#define CAN_ISR_SKIP_NONE 0xFF
+
+/**
+ * @brief 最多可以同时监视在线状态的 CAN ID 数量
+ */
+#define MAX_CAN_WATCHES 16
+
+/**
+ * @brief 在线监视时间轮的槽数(必须是2的幂),每个槽对应 1ms
+ */
+#define CAN_WATCH_WHEEL_SIZE 64
+
+/**
+ * @brief 在线监视哈希表的大小(必须是2的幂,且大于 MAX_CAN_WATCHES 的两倍)
+ */
+#define CAN_WATCH_HASH_SIZE 32
+
+/**
+ * @brief 每毫秒划分的发送时隙数,CanManager 以 1000 * CAN_TX_SLOTS_PER_MS Hz 向 TimManger 订阅节拍
+ * @details 5 个时隙即每个时隙 200us,1Mbps 下约可容纳 1~2 个标准帧
+ */
+#define CAN_TX_SLOTS_PER_MS 5
+
+/**
+ * @brief 周期发送调度器最多可以注册的帧源数量
+ */
+#define MAX_CAN_CYCLIC_TX 16
+
+/**
+ * @brief 自动选择相位时最多尝试的候选相位数
+ * @details 冲突只取决于相位对各周期最大公约数的余数,候选数超过这些公约数后结果很少再改善
+ */
+#define CAN_CYCLIC_PHASE_CANDIDATES 256
+
+/**
+ * @brief 自动选择相位时帧源表被并发修改后最多重新选择的次数,用完后直接使用最后一次的结果
+ */
+#define CAN_CYCLIC_PHASE_RETRIES 3
+
+/**
+ * @brief 注册周期发送帧源时由调度器自动选择相位
+ */
+#define CAN_CYCLIC_AUTO_PHASE 0xFFFF
+
+/**
+ * @brief 每路CAN可以使用的硬件滤波器组数量(CAN1 为 0~13, CAN2 为 14~27)
+ */
+#define CAN_FILTER_BANKS_PER_BUS 14
+
+/**
+ * @brief 16位列表模式下每个滤波器组可以精确匹配的标准ID数量
+ */
+#define CAN_FILTER_IDS_PER_BANK 4
+
+/**
+ * @brief 每路CAN可以精确匹配的标准ID数量,超过后退回全部接收
+ */
+#define CAN_FILTER_MAX_IDS (CAN_FILTER_BANKS_PER_BUS * CAN_FILTER_IDS_PER_BANK)
+
+/*==================== CAN设备在线状态回调类型 ====================*/
+
+/**
+ * @brief 设备上线/离线通知回调
+ * @param bus 设备所在的总线
+ * @param canId 被监视的 CAN ID
+ * @param online true 表示重新收到了消息, false 表示超时未收到消息
+ * @note 上线通知在CAN接收中断中调用,离线通知在定时器中断中调用
+ */
+typedef void (*CanOnlineCallback_t)(USE_CanBus bus, uint32_t canId, bool online);
+
+/*==================== CAN周期发送帧源类型 ====================*/
+
+/**
+ * @brief 周期发送帧源回调,在发送时隙到达时填充要发送的帧
+ * @param msg 需要填充的帧
+ * @return true 表示发送该帧, false 表示本周期跳过
+ * @note 在定时器中断中调用,必须足够短
+ */
+typedef bool (*CanCyclicSource_t)(CanMessage& msg);
+
+/*===================== CAN接收统计结构体 =====================*/
+
+/**
+ * @brief 单路CAN总线的接收分发统计
+ * @details 下标为 CanRxDelivery - CAN_DELIVERY_TASK_HIGH
+ */
+struct CanRxStats
+{
+    uint32_t isrFrames;                                  /*!< 进入分发的帧数 */
+    uint32_t deferredQueued[CAN_DEFER_QUEUE_NUM];        /*!< 成功推入延迟队列的帧数 */
+    uint32_t deferredDropped[CAN_DEFER_QUEUE_NUM];       /*!< 延迟队列已满被丢弃的帧数 */
+    uint32_t queueHighWater[CAN_DEFER_QUEUE_NUM];        /*!< 延迟队列的最高水位 */
+    uint32_t maxIsrCycles;                               /*!< 单帧中断分发耗时的最大值(DWT周期) */
+    uint32_t isrBudgetDeferred;                          /*!< 预算用完,剩余中断方式回调转入工作任务的帧数 */
+    uint32_t isrOverBudget;                              /*!< 预算用完但无法转入工作任务,仍在中断中执行完的帧数 */
+};
+
+/*==================== CAN发送确认令牌 ====================*/
+
+/**
+ * @brief 发送令牌的状态
+ */
+enum CanTxTokenState : uint8_t
+{
+    CAN_TX_TOKEN_IDLE = 0,        /*!< 未使用 */
+    CAN_TX_TOKEN_QUEUED,          /*!< 已进入发送队列 */
+    CAN_TX_TOKEN_IN_MAILBOX,      /*!< 已装入发送邮箱 */
+    CAN_TX_TOKEN_DONE,            /*!< 已发送到总线 */
+    CAN_TX_TOKEN_FAILED           /*!< 发送失败,原因见 failure */
+};
+
+/**
+ * @brief 发送失败的原因
+ */
+enum CanTxFailure : uint8_t
+{
+    CAN_TX_FAIL_NONE = 0,
+    CAN_TX_FAIL_QUEUE_FULL,       /*!< 发送队列已满,没有入队 */
+    CAN_TX_FAIL_MAILBOX,          /*!< 装入邮箱失败 */
+    CAN_TX_FAIL_ABORTED,          /*!< 发送请求被中止 */
+    CAN_TX_FAIL_ARB_LOST,         /*!< 仲裁失败,关闭了自动重传因此不会重发 */
+    CAN_TX_FAIL_BUS_ERROR         /*!< 发送错误 */
+};
+
+/**
+ * @brief 单帧的发送确认令牌,由调用者提供存储
+ * @details 时间戳均为 DWT 周期计数,差值除以 CHIP_FREQ_MHZ 即为微秒
+ * @note 令牌在状态变为 DONE 或 FAILED 之前必须保持有效,且不能同时用于两帧
+ */
+struct CanTxToken
+{
+    volatile CanTxTokenState state;
+    volatile CanTxFailure failure;
+    volatile uint32_t enqueueCycles;        /*!< 进入发送队列的时刻 */
+    volatile uint32_t mailboxCycles;        /*!< 装入发送邮箱的时刻 */
+    volatile uint32_t completeCycles;       /*!< 发送结束(成功或失败)的时刻 */
+};
+
+/*==================== CAN硬件滤波器规划 ====================*/
+
+/**
+ * @brief 单路CAN的硬件滤波器规划
+ * @details 由订阅表和在线监视表中的 CAN ID 去重得到,
+ *          每 CAN_FILTER_IDS_PER_BANK 个ID占用一个列表模式的滤波器组
+ */
+struct CanFilterPlan
+{
+    uint16_t ids[CAN_FILTER_MAX_IDS];       /*!< 去重后的标准ID */
+    uint8_t idCount;                        /*!< ids 中有效的ID数量 */
+    uint8_t bankCount;                      /*!< 需要占用的滤波器组数量 */
+    bool acceptAll;                         /*!< true 表示不做ID过滤,使用一个全部接收的滤波器组 */
+    uint32_t epoch;                         /*!< 规划时订阅表的版本号,应用时用于发现规划之后新增的ID */
+};
+
 /*======================= CAN 管理器类 =======================*/
 
 /**
  * @brief CAN 管理器类
  * @details
  * 1. 采用单例模式，统一管理 CAN1 和 CAN2 资源。
- * 2. 负责初始化 BSP 层的 CAN，并设置硬件滤波器为“全部接收”模式。
+ * 2. 负责初始化 BSP 层的 CAN，启动时硬件滤波器为“全部接收”模式,
+ *    注册结束后可以按订阅表规划为列表模式,只让被订阅的ID进入接收中断。
  * 3. 提供基于静态数组的发布-订阅机制，实现零动态内存分配，保证实时性。
  * 4. 作为 BSP 和上层模块的桥梁，将收到的消息分发给对应的订阅者。
+ * 5. 订阅者可选择在中断中接收,或由CAN工作任务按优先级在任务上下文中接收。
+ * 6. 周期帧按 周期+相位 分散到每毫秒的多个发送时隙,避免同一时刻挤占发送邮箱。
  */
 class CanManager
 {
@@ -115,9 +325,11 @@ public:
      * @param bus 要订阅的总线
      * @param canId 要订阅的 CAN ID
      * @param callback 接收到消息时调用的回调函数
+     * @param delivery 回调的投递方式,默认在中断中直接调用
      * @return 订阅操作的状态
+     * @note 首次以任务方式订阅时会创建CAN工作任务,因此只能在任务上下文中调用
      */
-    MW_Status Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t callback);
+    MW_Status Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t callback, CanRxDelivery delivery = CAN_DELIVERY_ISR);
 
     
     /**
@@ -134,9 +346,100 @@ public:
      * @brief 向指定的CAN总线上的消息队列添加消息(上层调用)
      * @param bus 要使用的总线
      * @param msg 要发送的消息
+     * @param token 可选的发送确认令牌,用于获取发送时间戳和结果
      * @return 发送操作的状态
      */
-    MW_Status sendMessage(USE_CanBus bus, const CanMessage& msg);
+    MW_Status sendMessage(USE_CanBus bus, const CanMessage& msg, CanTxToken* token = nullptr);
+
+
+    /**
+     * @brief 获取指定CAN总线的接收分发统计
+     * @param bus 要查询的总线
+     * @param stats 用于接收统计数据的引用
+     * @return 查询操作的状态
+     */
+    MW_Status GetRxStats(USE_CanBus bus, CanRxStats& stats);
+
+
+    /**
+     * @brief 监视指定 CAN ID 的在线状态
+     * @param bus 设备所在的总线
+     * @param canId 要监视的 CAN ID
+     * @param timeoutMs 超过该时间没有收到消息即判定为离线
+     * @param callback 上线/离线时调用的回调函数,可以为 nullptr(只通过 IsOnline 查询)
+     * @return 监视操作的状态
+     * @details 注册后设备处于离线状态,收到第一帧消息时触发上线通知
+     */
+    MW_Status WatchOnline(USE_CanBus bus, uint32_t canId, uint32_t timeoutMs, CanOnlineCallback_t callback);
+
+
+    /**
+     * @brief 取消对指定 CAN ID 的在线监视
+     * @param bus 设备所在的总线
+     * @param canId 要取消监视的 CAN ID
+     * @return 取消监视操作的状态
+     */
+    MW_Status UnWatchOnline(USE_CanBus bus, uint32_t canId);
+
+
+    /**
+     * @brief 查询指定 CAN ID 当前是否在线
+     * @param bus 设备所在的总线
+     * @param canId 要查询的 CAN ID
+     * @return result 为在线状态, status 为查询操作的状态
+     */
+    MW_FuncStatus<bool> IsOnline(USE_CanBus bus, uint32_t canId);
+
+
+    /**
+     * @brief 注册一个周期发送帧源
+     * @param bus 要使用的总线
+     * @param periodMs 发送周期(毫秒)
+     * @param phaseSlot 周期内的发送相位,单位为时隙(1ms / CAN_TX_SLOTS_PER_MS),
+     *                  取值 [0, periodMs * CAN_TX_SLOTS_PER_MS),
+     *                  填 CAN_CYCLIC_AUTO_PHASE 时选择负载最小的相位
+     * @param source 发送时刻调用的帧源回调
+     * @return result 为帧源句柄, status 为注册操作的状态
+     * @note 帧源回调在定时器中断中调用
+     */
+    MW_FuncStatus<uint8_t> AddCyclicTx(USE_CanBus bus, uint16_t periodMs, uint16_t phaseSlot, CanCyclicSource_t source);
+
+
+    /**
+     * @brief 注销一个周期发送帧源
+     * @param handle AddCyclicTx 返回的帧源句柄
+     * @return 注销操作的状态
+     */
+    MW_Status RemoveCyclicTx(uint8_t handle);
+
+
+    /**
+     * @brief 查询指定CAN总线是否已经被上层中间件申请
+     * @param bus 要查询的总线
+     * @return result 为是否已被申请, status 为查询操作的状态
+     */
+    MW_FuncStatus<bool> IsResourceAsked(USE_CanBus bus);
+
+
+    /**
+     * @brief 由订阅表和在线监视表规划指定总线的硬件滤波器
+     * @param bus 要规划的总线
+     * @param plan 用于接收规划结果的引用
+     * @return 规划操作的状态
+     * @details 没有任何ID或ID数量超过 CAN_FILTER_MAX_IDS 时规划为全部接收
+     */
+    MW_Status PlanRxFilter(USE_CanBus bus, CanFilterPlan& plan);
+
+
+    /**
+     * @brief 把滤波器规划写入指定总线的硬件滤波器组
+     * @param bus 要应用的总线,必须已经启动
+     * @param plan PlanRxFilter 得到的规划
+     * @return 应用操作的状态
+     * @details 规划之后订阅表发生了变化时退回全部接收并返回 INVALID_OPERATION;
+     *          应用之后再订阅或监视不在列表中的ID时,该总线自动退回全部接收
+     */
+    MW_Status ApplyRxFilter(USE_CanBus bus, const CanFilterPlan& plan);
 
     
 private:
@@ -153,9 +456,9 @@ private:
     Can Can2;    
 
     /**
-     * @brief CAN Manger专用的基本定时器，用于处理CAN消息的发送
+     * @brief 在 TimManger 上订阅的发送时隙定时器句柄
      */
-    Timer Timer6;
+    TimHandle_t TickHandle;
     
     /**
      * @brief 上层中间件的订阅消息结构体
@@ -163,12 +466,37 @@ private:
     struct Subscription{
         uint32_t canId;
         CanRxCallback_t callback;
+        CanRxDelivery delivery;
+    };
+
+    /**
+     * @brief 推入延迟投递队列的CAN帧
+     */
+    struct DeferredFrame{
+        uint32_t canId;
+        uint8_t data[8];
+        uint8_t len;
+        USE_CanBus bus;
+        uint8_t isrSkip;            /*!< 中断中已执行的中断方式回调个数,CAN_ISR_SKIP_NONE 表示没有剩余 */
+    };
+
+    /**
+     * @brief 发送队列中的一项,消息和它的发送确认令牌
+     */
+    struct CanTxItem{
+        CanMessage msg;
+        CanTxToken* token;
     };
 
     /**
      * @brief 用于发送CAN的消息队列数组
      */
-    RingBuffer<CanMessage, CAN_TXQUEUE_SIZE> CanMsgSendQueue[USE_CAN_END];
+    RingBuffer<CanTxItem, CAN_TXQUEUE_SIZE> CanMsgSendQueue[USE_CAN_END];
+
+    /**
+     * @brief 每个发送邮箱中当前帧的令牌,没有令牌时为 nullptr
+     */
+    CanTxToken* MailboxToken[USE_CAN_END][CAN_TXMAILBOX_NUM];
     
     /**
      * @brief CAN_Resouce 存储CAN实例对象的指针数组
@@ -189,7 +517,7 @@ private:
     volatile bool CanIsInit[USE_CAN_END];
 
     /**
-     * @brief 记录CAN Manger专用的基本定时器是否已经初始化
+     * @brief 记录是否已经向 TimManger 订阅了发送时隙定时器
      */
     volatile bool TimIsInit;
     
@@ -225,6 +553,116 @@ private:
      */ 
     Subscription Can2CallbackArray[MAX_CAN_SUBSCRIPTIONS];
 
+    /**
+     * @brief 延迟投递队列,下标0为高优先级,下标1为低优先级
+     */
+    QueueHandle_t DeferQueue[CAN_DEFER_QUEUE_NUM];
+
+    /**
+     * @brief CAN 工作任务句柄,由中断通过任务通知唤醒
+     */
+    TaskHandle_t RxTaskHandle;
+
+    /**
+     * @brief 记录CAN工作任务及其队列是否已经就绪,在句柄和队列全部发布之后才置位
+     */
+    volatile bool RxTaskIsInit;
+
+    /**
+     * @brief 记录CAN工作任务是否正在创建,防止其他线程重复创建
+     */
+    volatile bool RxTaskCreating;
+
+    /**
+     * @brief 每路CAN总线的接收分发统计
+     * @details 下标0为CAN1,下标1为CAN2
+     */
+    CanRxStats RxStats[USE_CAN_END];
+
+    /**
+     * @brief 单个 CAN ID 的在线监视项
+     * @details 监视项挂在时间轮的双向链表上,prev/next 为 WatchPool 下标
+     */
+    struct OnlineWatch{
+        uint32_t canId;
+        uint32_t timeoutMs;
+        uint32_t lastRxMs;             /*!< 最近一次收到消息的时间 */
+        uint32_t deadlineMs;           /*!< 所在时间轮槽的到期时间 */
+        CanOnlineCallback_t callback;
+        USE_CanBus bus;
+        bool used;
+        bool online;
+        bool inWheel;
+        uint8_t prev;
+        uint8_t next;
+    };
+
+    /**
+     * @brief 在线监视项的静态存储池
+     */
+    OnlineWatch WatchPool[MAX_CAN_WATCHES];
+
+    /**
+     * @brief (总线, CAN ID) 到 WatchPool 下标的开放寻址哈希表
+     */
+    uint8_t WatchHash[CAN_WATCH_HASH_SIZE];
+
+    /**
+     * @brief 哈希时间轮,每个槽保存链表头的 WatchPool 下标
+     */
+    uint8_t WatchWheel[CAN_WATCH_WHEEL_SIZE];
+
+    /**
+     * @brief 在线监视使用的毫秒时基,由定时器中断递增
+     */
+    volatile uint32_t WatchNowMs;
+
+    /**
+     * @brief 周期发送帧源
+     */
+    struct CyclicTx{
+        CanCyclicSource_t source;
+        uint32_t periodSlots;          /*!< 以时隙为单位的周期 */
+        uint32_t nextSlot;             /*!< 下一次发送的时隙 */
+        uint32_t dropped;              /*!< 发送队列已满导致丢弃的次数 */
+        uint16_t phaseSlot;
+        USE_CanBus bus;
+        bool used;
+    };
+
+    /**
+     * @brief 周期发送帧源表
+     */
+    CyclicTx CyclicTable[MAX_CAN_CYCLIC_TX];
+
+    /**
+     * @brief 帧源表的修改计数,注册和注销时递增,用于发现自动相位计算期间的并发修改
+     */
+    uint32_t CyclicVersion;
+
+    /**
+     * @brief 自动选择相位时从帧源表复制的快照项
+     */
+    struct CyclicPhaseRef{
+        uint32_t periodSlots;
+        uint16_t phaseSlot;
+    };
+
+    /**
+     * @brief 发送时隙计数,由定时器中断递增
+     */
+    volatile uint32_t TxSlotNow;
+
+    /**
+     * @brief 每路CAN当前生效的滤波器规划,初始为全部接收
+     */
+    CanFilterPlan AppliedFilter[USE_CAN_END];
+
+    /**
+     * @brief 每路CAN订阅表的版本号,每次新增订阅或监视时递增
+     */
+    volatile uint32_t RxIdEpoch[USE_CAN_END];
+
 
 /*==================== CAN 管理器私有成员函数 ====================*/  
     /**
@@ -263,6 +701,52 @@ private:
      */
     static void CAN2_RxCallback(uint32_t canId,  uint8_t* data, uint8_t len);
 
+    /**
+     * @brief CAN1 发送邮箱结束回调,更新邮箱中帧的令牌
+     */
+    static void CAN1_TxDoneCallback(uint32_t mailbox, CanTxResult result);
+
+    /**
+     * @brief CAN2 发送邮箱结束回调,更新邮箱中帧的令牌
+     */
+    static void CAN2_TxDoneCallback(uint32_t mailbox, CanTxResult result);
+
+    /**
+     * @brief 两路CAN共用的发送结束处理,在CAN中断中调用
+     */
+    static void CompleteTxToken(USE_CanBus bus, uint32_t mailbox, CanTxResult result);
+
+    /**
+     * @brief 两路CAN共用的接收分发函数,在接收中断中调用
+     * @param bus 收到消息的总线
+     * @param canId 收到的CAN ID
+     * @param data 收到的CAN数据指针
+     * @param len 收到的CAN数据长度
+     * @details 1. 在预算内调用 CAN_DELIVERY_ISR 方式的订阅者,剩余的随帧推入高优先级队列
+     *          2. 对每个有订阅者的延迟队列只推入一次帧,与订阅者数量无关
+     */
+    static void DispatchRxMessage(USE_CanBus bus, uint32_t canId, uint8_t* data, uint8_t len);
+
+    /**
+     * @brief 创建CAN工作任务及其延迟投递队列(只会创建一次)
+     * @return 创建操作的状态
+     */
+    MW_Status StartRxTask();
+
+    /**
+     * @brief CAN 工作任务,按优先级从延迟队列中取出帧并调用对应订阅者
+     * @param arg 未使用
+     */
+    static void RxTask(void* arg);
+
+    /**
+     * @brief 在任务上下文中调用指定投递方式的订阅者
+     * @param frame 从延迟队列中取出的帧
+     * @param delivery 该帧所在队列对应的投递方式
+     * @note 帧带有剩余的中断方式回调时一并执行
+     */
+    static void DispatchDeferredFrame(DeferredFrame& frame, CanRxDelivery delivery);
+
     
     /**
      * @brief 处理CAN发送队列，尝试从软件队列中发送消息
@@ -273,6 +757,67 @@ private:
      */
     static void processCanSendQueue();
 
+    /**
+     * @brief 在 TimManger 上订阅的定时器回调,每个发送时隙调用一次
+     * @details 1. 每毫秒推进一次在线监视的时间轮
+     *          2. 把到期的周期帧推入发送队列
+     *          3. 处理CAN发送队列
+     */
+    static void OnTimerTick(void* arg);
+
+    /**
+     * @brief 把当前时隙到期的周期帧推入发送队列
+     */
+    static void ProcessCyclicTx(uint32_t slot);
+
+    /**
+     * @brief 按帧源表快照为新帧源选择冲突最少的相位,在临界区外调用
+     */
+    static uint16_t PickCyclicPhase(uint32_t periodSlots, const CyclicPhaseRef* refs, uint8_t refCount);
+
+    /**
+     * @brief 在哈希表中查找 (总线, CAN ID) 对应的监视项,必须在临界区内调用
+     * @return 监视项下标,找不到时返回 CAN_WATCH_NONE
+     */
+    uint8_t FindWatch(USE_CanBus bus, uint32_t canId) const;
+
+    /**
+     * @brief 计算 (总线, CAN ID) 在哈希表中的起始探测位置
+     */
+    static uint8_t WatchHashOf(USE_CanBus bus, uint32_t canId);
+
+    /**
+     * @brief 把监视项挂到 deadlineMs 所在的时间轮槽上,必须在临界区内调用
+     */
+    void LinkWatch(uint8_t index, uint32_t deadlineMs);
+
+    /**
+     * @brief 把监视项从所在的时间轮槽上摘下,必须在临界区内调用
+     */
+    void UnlinkWatch(uint8_t index);
+
+    /**
+     * @brief 在接收中断中刷新 CAN ID 的最近接收时间,O(1)
+     * @details 只写入接收时间,到期时才由时间轮重新挂载,离线设备重新上线时触发通知
+     */
+    static void FeedWatch(USE_CanBus bus, uint32_t canId);
+
+    /**
+     * @brief 处理当前毫秒对应的时间轮槽,只访问该槽上的监视项
+     */
+    static void ProcessWatchWheel();
+
+    /**
+     * @brief 登记一个新接收的ID,必须在临界区内调用
+     * @return true 表示当前生效的列表滤波器不包含该ID,需要在临界区外退回全部接收
+     */
+    bool NoteRxId(USE_CanBus bus, uint32_t canId);
+
+    /**
+     * @brief 把指定总线的滤波器退回全部接收
+     */
+    void RevertRxFilter(USE_CanBus bus);
+
 };
 
 #endif /* B2MW_CANMANAGER_HPP */
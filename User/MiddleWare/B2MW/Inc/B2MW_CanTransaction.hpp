@@ -0,0 +1,295 @@
+/*===========================================================
+* @file      B2MW_CanTransaction.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* B2MW_CANManager.hpp
+* B2MW_Timer.hpp
+* MW_Common.hpp
+* MW_RingBuffer.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 构建在 CanManager 之上的 CAN 请求/应答事务层
+* 每个设备维护一个未完成请求的窗口,多个请求可以同时在总线上,
+* 应答按 (总线, 应答ID) 和序号键 O(1) 匹配,超时与重发由 TimManger 的毫秒定时器驱动,
+* 不需要为每个请求创建任务或阻塞等待。
+* 1. 声明了 CanTransaction 类，作为 CAN 请求/应答事务的统一管理者。
+* 2. 定义了 CanTxnReplyCallback_t 类型，用于接收应答或超时通知。
+* 3. 定义了 CanTxnKeyFn_t 类型，用于从应答帧中提取序号键。
+* 4. 定义了 CanTxnDeviceConfig 结构体，用于描述一个应答设备。
+* ===========================================================
+* @version   1.1
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+#ifndef B2MW_CANTRANSACTION_HPP
+#define B2MW_CANTRANSACTION_HPP
+
+/*========================= 文件依赖 =========================*/
+
+#include "B2MW_CANManager.hpp"
+#include "B2MW_Timer.hpp"
+#include "MW_Common.hpp"
+#include "MW_RingBuffer.hpp"
+
+/*========================== 宏定义 ==========================*/
+
+/**
+ * @brief 最多可以注册的应答设备数量
+ */
+#define MAX_CAN_TXN_DEVICES 8
+
+/**
+ * @brief 每个设备未完成请求窗口的最大值(必须是2的幂)
+ */
+#define CAN_TXN_MAX_WINDOW 8
+
+/**
+ * @brief 每个设备等待进入窗口的请求队列深度
+ */
+#define CAN_TXN_PENDING_SIZE 16
+
+/**
+ * @brief (总线, 应答ID) 到设备下标的哈希表大小(必须是2的幂,且大于 MAX_CAN_TXN_DEVICES 的两倍)
+ */
+#define CAN_TXN_HASH_SIZE 32
+
+/*==================== CAN事务回调类型 ====================*/
+
+/**
+ * @brief 事务结束回调
+ * @param ctx 发起请求时传入的上下文
+ * @param status SUCCESS 表示收到应答, TIMEOUT 表示重发次数用尽仍未收到应答
+ * @param data 应答数据,超时时为 nullptr
+ * @param len 应答数据长度,超时时为 0
+ * @note 收到应答时在CAN接收中断中调用,超时时在定时器中断中调用
+ */
+typedef void (*CanTxnReplyCallback_t)(void* ctx, MW_Status status, const uint8_t* data, uint8_t len);
+
+/**
+ * @brief 从应答帧中提取序号键(例如参数索引或序号字节)
+ * @param data 应答数据
+ * @param len 应答数据长度
+ * @return 序号键,必须与发起请求时的 seqKey 一致
+ */
+typedef uint16_t (*CanTxnKeyFn_t)(const uint8_t* data, uint8_t len);
+
+/*==================== CAN事务设备配置 ====================*/
+
+/**
+ * @brief 应答设备的配置
+ * @details replyKey 为 nullptr 时只按应答ID匹配,窗口强制为 1
+ */
+struct CanTxnDeviceConfig
+{
+    USE_CanBus bus;              /*!< 设备所在的总线 */
+    uint32_t replyId;            /*!< 设备应答使用的 CAN ID */
+    uint8_t window;              /*!< 同时未完成请求的数量,2的幂,不超过 CAN_TXN_MAX_WINDOW */
+    uint16_t timeoutMs;          /*!< 单次请求等待应答的超时时间 */
+    uint8_t maxRetries;          /*!< 超时后的最大重发次数 */
+    CanTxnKeyFn_t replyKey;      /*!< 从应答中提取序号键的函数 */
+};
+
+/**
+ * @brief 单个设备的事务统计
+ */
+struct CanTxnStats
+{
+    uint32_t completed;          /*!< 收到应答的请求数 */
+    uint32_t timeouts;           /*!< 重发用尽后超时的请求数 */
+    uint32_t retries;            /*!< 超时重发的次数 */
+    uint32_t staleReplies;       /*!< 找不到对应请求的应答数(迟到或重复的应答) */
+    uint32_t sendDeferred;       /*!< 发送队列已满,推迟到下一毫秒发送的次数 */
+};
+
+/*===================== CAN 事务管理类 =====================*/
+
+/**
+ * @brief CAN 请求/应答事务管理类
+ * @details
+ * 1. 采用单例模式,所有设备共享 TimManger 上的一个毫秒定时器。
+ * 2. 请求按 seqKey & (window - 1) 放入设备窗口的槽位,槽位被占用时进入等待队列。
+ * 3. 应答先经哈希表找到设备,再由序号键直接定位槽位,匹配为 O(1)。
+ * 4. 全部使用静态存储,不进行动态内存分配。
+ */
+class CanTransaction
+{
+public:
+
+    /**
+     * @brief 获取 CanTransaction 的单例实例
+     */
+    static CanTransaction& GetInstance();
+
+    /**
+     * @brief 注册一个应答设备
+     * @param config 设备配置
+     * @return result 为设备句柄, status 为注册操作的状态
+     * @note 设备所在的总线必须已经通过 CanManager 启动
+     */
+    MW_FuncStatus<uint8_t> AddDevice(const CanTxnDeviceConfig& config);
+
+    /**
+     * @brief 向设备发起一个请求
+     * @param device AddDevice 返回的设备句柄
+     * @param request 请求帧
+     * @param seqKey 序号键,应答中由 replyKey 提取出相同的值
+     * @param callback 事务结束回调,可以为 nullptr
+     * @param ctx 透传给回调的上下文
+     * @return 请求操作的状态
+     * @details 窗口对应槽位空闲时立即发送,否则进入等待队列
+     */
+    MW_Status Request(uint8_t device, const CanMessage& request, uint16_t seqKey, CanTxnReplyCallback_t callback, void* ctx);
+
+    /**
+     * @brief 查询设备尚未结束的请求数量(窗口中 + 等待队列中)
+     * @param device 设备句柄
+     * @return result 为请求数量, status 为查询操作的状态
+     */
+    MW_FuncStatus<uint8_t> GetOutstanding(uint8_t device);
+
+    /**
+     * @brief 获取设备的事务统计
+     * @param device 设备句柄
+     * @param stats 用于接收统计数据的引用
+     * @return 查询操作的状态
+     */
+    MW_Status GetStats(uint8_t device, CanTxnStats& stats);
+
+private:
+
+/*==================== CAN 事务类私有成员变量 ====================*/
+
+    /**
+     * @brief 窗口中的一个槽位
+     */
+    struct TxnSlot{
+        CanMessage msg;                  /*!< 请求帧,重发时使用 */
+        CanTxnReplyCallback_t callback;
+        void* ctx;
+        uint32_t deadlineMs;
+        uint16_t seqKey;
+        uint8_t retriesLeft;
+        bool busy;
+        bool unsent;                     /*!< 请求帧还需要(重新)推入发送队列 */
+    };
+
+    /**
+     * @brief 等待进入窗口的请求
+     */
+    struct PendingReq{
+        CanMessage msg;
+        CanTxnReplyCallback_t callback;
+        void* ctx;
+        uint16_t seqKey;
+    };
+
+    /**
+     * @brief 一个应答设备的全部事务状态
+     */
+    struct TxnDevice{
+        CanTxnDeviceConfig config;
+        TxnSlot slots[CAN_TXN_MAX_WINDOW];
+        RingBuffer<PendingReq, CAN_TXN_PENDING_SIZE> pending;
+        CanTxnStats stats;
+        uint8_t inFlight;
+        bool used;
+    };
+
+    /**
+     * @brief 设备表
+     */
+    TxnDevice Devices[MAX_CAN_TXN_DEVICES];
+
+    /**
+     * @brief 已注册的设备数量,设备只能追加
+     */
+    volatile uint8_t DeviceCount;
+
+    /**
+     * @brief (总线, 应答ID) 到设备下标的开放寻址哈希表
+     */
+    uint8_t ReplyHash[CAN_TXN_HASH_SIZE];
+
+    /**
+     * @brief 事务层的毫秒时基,由毫秒定时器递增
+     */
+    volatile uint32_t NowMs;
+
+    /**
+     * @brief 是否已经向 TimManger 订阅了毫秒定时器
+     */
+    bool TickIsInit;
+
+/*==================== CAN 事务类私有成员函数 ====================*/
+
+    /**
+     * @brief 私有构造函数
+     */
+    CanTransaction();
+
+    /**
+     * @brief 析构默认
+     */
+    ~CanTransaction() = default;
+
+    /**
+     * @brief 拷贝构造私有
+     */
+    CanTransaction(const CanTransaction&) = delete;
+
+    /**
+     * @brief 赋值运算私有
+     */
+    CanTransaction& operator=(const CanTransaction&) = delete;
+
+    /**
+     * @brief 计算 (总线, 应答ID) 在哈希表中的起始探测位置
+     */
+    static uint8_t ReplyHashOf(USE_CanBus bus, uint32_t canId);
+
+    /**
+     * @brief 在哈希表中查找应答ID对应的设备下标,找不到时返回 0xFF
+     */
+    uint8_t FindDevice(USE_CanBus bus, uint32_t canId) const;
+
+    /**
+     * @brief 把等待队列头部的请求依次放入空闲槽位,必须在临界区内调用
+     * @details 队头的槽位被占用时停止,保证同一设备的请求按发起顺序进入窗口
+     */
+    void PromotePending(TxnDevice& dev);
+
+    /**
+     * @brief 把槽位中标记为 unsent 的请求推入 CanManager 的发送队列
+     * @details 在临界区内认领槽位,在临界区外发送,发送队列已满时恢复 unsent 标记
+     */
+    void SendSlot(uint8_t device, uint8_t slot);
+
+    /**
+     * @brief 发送设备窗口中所有标记为 unsent 的请求
+     */
+    void FlushDevice(uint8_t device);
+
+    /**
+     * @brief 两路CAN共用的应答处理,在CAN接收中断中调用
+     */
+    static void OnReply(USE_CanBus bus, uint32_t canId, uint8_t* data, uint8_t len);
+
+    /**
+     * @brief 注册在 CanManager 上的 CAN1 应答回调
+     */
+    static void OnCan1Reply(uint32_t canId, uint8_t* data, uint8_t len);
+
+    /**
+     * @brief 注册在 CanManager 上的 CAN2 应答回调
+     */
+    static void OnCan2Reply(uint32_t canId, uint8_t* data, uint8_t len);
+
+    /**
+     * @brief 在 TimManger 上订阅的毫秒定时器回调,处理超时与重发
+     */
+    static void OnTick(void* arg);
+};
+
+#endif /* B2MW_CANTRANSACTION_HPP */
@@ -1,5 +1,227 @@
+/*===========================================================
+* @file      B2MW_Manager.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* B2MW_CANManager.hpp
+* B2MW_Timer.hpp
+* MW_Common.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* BSP层到中间件层的资源规划与统一启动模块
+* 各个 Manager 先经历被中间件注册(AskResource/Subscribe)的阶段,
+* 注册结束后由 B2MWManager 一次性规划资源并按依赖顺序启动外设,用户无需去管Init。
+* 1. 声明了 B2MWManager 类，作为所有 BSP 资源 Manager 的启动编排者。
+* 2. 定义了 B2MWBootPhase 枚举，用于表示启动的各个阶段。
+* 3. 定义了 B2MWBootReport 结构体，用于记录各阶段的耗时与规划结果。
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
 #ifndef B2MW_MANAGER_HPP
 #define B2MW_MANAGER_HPP
 
+/*========================= 文件依赖 =========================*/
+
+#include "B2MW_CANManager.hpp"
+#include "B2MW_Timer.hpp"
+#include "MW_Common.hpp"
+
+/*========================== 宏定义 ==========================*/
+
+/**
+ * @brief TimManger 占用的硬件定时器对应的中断号,必须与 TIM_MANAGER_DEVICE 一致
+ */
+#define B2MW_TIMER_IRQN TIM6_DAC_IRQn
+
+/**
+ * @brief CAN 接收 FIFO0 中断的优先级,订阅者在其中被直接调用,延迟要求最高
+ */
+#define B2MW_IRQ_PRIO_CAN_RX0 5
+
+/**
+ * @brief CAN 发送邮箱中断与 TimManger 节拍中断的优先级
+ */
+#define B2MW_IRQ_PRIO_CAN_TX 6
+#define B2MW_IRQ_PRIO_TIMER 6
+
+/**
+ * @brief CAN 接收 FIFO1(未使用)与状态/错误中断的优先级
+ */
+#define B2MW_IRQ_PRIO_CAN_ERR 7
+
+/**
+ * @brief 启动规划中最多需要配置的中断数量(两路CAN各4个,加1个定时器)
+ */
+#define B2MW_MAX_IRQ_PLANS 9
+
+/*==================== 启动阶段枚举 ====================*/
+
+/**
+ * @brief 启动阶段枚举
+ * @details
+ *  BOOT_PHASE_PLAN-收集所有注册,一次性计算滤波器组、定时器和中断优先级
+ *  BOOT_PHASE_NVIC-写入中断优先级
+ *  BOOT_PHASE_TIMER-启动 TimManger 的硬件定时器
+ *  BOOT_PHASE_CAN-启动被申请的CAN总线并写入滤波器组
+ */
+enum B2MWBootPhase : uint8_t
+{
+    BOOT_PHASE_PLAN = 0,
+    BOOT_PHASE_NVIC,
+    BOOT_PHASE_TIMER,
+    BOOT_PHASE_CAN,
+    BOOT_PHASE_END
+};
+
+/*==================== 启动报告结构体 ====================*/
+
+/**
+ * @brief 启动报告
+ * @details 耗时均为 DWT 周期,除以 CHIP_FREQ_MHZ 即为微秒
+ */
+struct B2MWBootReport
+{
+    uint32_t phaseCycles[BOOT_PHASE_END];        /*!< 各阶段耗时,跳过的阶段为 0 */
+    MW_Status phaseStatus[BOOT_PHASE_END];       /*!< 各阶段的结果 */
+    uint32_t totalCycles;                        /*!< 启动总耗时 */
+    bool canStarted[USE_CAN_END];                /*!< 该总线是否被申请并启动 */
+    uint8_t filterBanks[USE_CAN_END];            /*!< 该总线占用的滤波器组数量 */
+    uint8_t filterIds[USE_CAN_END];              /*!< 该总线精确匹配的ID数量 */
+    bool filterAcceptAll[USE_CAN_END];           /*!< 该总线是否退回全部接收 */
+    bool timerStarted;                           /*!< 是否启动了 TimManger */
+    uint8_t irqCount;                            /*!< 配置了优先级的中断数量 */
+    bool booted;                                 /*!< 是否已经完成启动 */
+};
+
+/*==================== 资源规划与启动管理类 ====================*/
+
+/**
+ * @brief 资源规划与启动管理类
+ * @details
+ * 1. 采用单例模式,在所有中间件注册结束后调用一次 Boot。
+ * 2. 规划阶段只读取各 Manager 的注册表,不触碰硬件。
+ * 3. 各外设只启动一次,不会出现先按默认配置初始化再反初始化的过程。
+ * 4. DMA 流由 CubeMX 固定分配,规划阶段不做 DMA 分配。
+ */
+class B2MWManager
+{
+public:
+
+    /**
+     * @brief 获取 B2MWManager 的单例实例
+     */
+    static B2MWManager& GetInstance();
+
+    /**
+     * @brief 规划并启动全部被申请的资源,重复调用什么也不做
+     * @return 启动操作的状态,任一阶段失败时返回该阶段的状态
+     * @note 只能在任务上下文中调用,所有中间件必须已经完成注册
+     */
+    MW_Status Boot();
+
+    /**
+     * @brief 获取启动报告
+     * @param report 用于接收报告的引用
+     * @return UNINITIALIZED 表示还没有启动, SUCCESS 表示获取成功
+     */
+    MW_Status GetBootReport(B2MWBootReport& report);
+
+    /**
+     * @brief 获取启动阶段的名称
+     */
+    static const char* PhaseName(B2MWBootPhase phase);
+
+private:
+
+/*==================== 启动管理类私有成员变量 ====================*/
+
+    /**
+     * @brief 一个中断的优先级规划
+     */
+    struct IrqPlan{
+        IRQn_Type irq;
+        uint8_t priority;
+    };
+
+    /**
+     * @brief 每路CAN的滤波器规划
+     */
+    CanFilterPlan FilterPlan[USE_CAN_END];
+
+    /**
+     * @brief 中断优先级规划表
+     */
+    IrqPlan IrqTable[B2MW_MAX_IRQ_PLANS];
+
+    /**
+     * @brief 是否需要启动 TimManger
+     */
+    bool NeedTimer;
+
+    /**
+     * @brief 启动报告
+     */
+    B2MWBootReport Report;
+
+    /**
+     * @brief 启动报告是否有效,Boot 跑完全部阶段或在某一阶段失败后置位
+     */
+    volatile bool ReportValid;
+
+    /**
+     * @brief 是否已经开始启动
+     */
+    volatile bool IsBooting;
+
+/*==================== 启动管理类私有成员函数 ====================*/
+
+    /**
+     * @brief 私有构造函数
+     */
+    B2MWManager();
+
+    /**
+     * @brief 析构默认
+     */
+    ~B2MWManager() = default;
+
+    /**
+     * @brief 拷贝构造私有
+     */
+    B2MWManager(const B2MWManager&) = delete;
+
+    /**
+     * @brief 赋值运算私有
+     */
+    B2MWManager& operator=(const B2MWManager&) = delete;
+
+    /**
+     * @brief 向中断规划表追加一项
+     */
+    void AddIrq(IRQn_Type irq, uint8_t priority);
+
+    /**
+     * @brief 规划阶段,一次遍历得到滤波器组、定时器和中断优先级的规划
+     */
+    MW_Status PlanPhase();
+
+    /**
+     * @brief 中断优先级阶段
+     */
+    MW_Status NvicPhase();
+
+    /**
+     * @brief 定时器阶段
+     */
+    MW_Status TimerPhase();
+
+    /**
+     * @brief CAN 阶段
+     */
+    MW_Status CanPhase();
+};
 
 #endif /* B2MW_MANAGER_HPP */
@@ -8,9 +8,16 @@
 * MW_Common.hpp
 * ===========================================================
 * 该文件功能表述(先声明后定义):
+* BSP层到中间件层的定时器管理模块
+* 采用单例模式,只占用一个硬件定时器,在其上用分层时间轮复用出大量软件定时器,
+* 中间件不再各自占用一个TIM外设。
+* 1. 声明了 TimManger 类，作为软件定时器的统一管理者。
+* 2. 定义了 TimCallback_t 类型，作为软件定时器的回调函数类型。
+* 3. 定义了 TimHandle_t 类型，作为软件定时器的句柄。
+* 4. 定义了 TimJitterStats 结构体，用于统计每个软件定时器的抖动。
 * ===========================================================
-* @version   0.1
-* @date      2025-10-21
+* @version   1.0
+* @date      2026-10-18
 * @copyright Copyright (c) 2025
 ============================================================*/
 
@@ -22,36 +29,261 @@
 #include "MW_Common.hpp"
 
 
-/*==================== Tim定时器资源使用枚举 ===================*/
+/*========================== 宏定义 ==========================*/
 
 /**
- * @brief 上层中间件使用的定时器枚举
+ * @brief TimManger 占用的硬件定时器
  */
-enum USE_Timer : uint8_t
-{
-    USE_TIMER1 = 0,
-    USE_TIMER2 = 1,
-    USE_TIMER3 = 2,
-    USE_TIMER_END
-};
+#define TIM_MANAGER_DEVICE DEVICE_TIMER_6
 
-/*========================== 宏定义 ==========================*/
+/**
+ * @brief 时间轮的节拍频率(Hz),所有软件定时器的周期都以节拍为单位
+ * @details 10kHz 即每个节拍 100us
+ */
+#define TIM_TICK_HZ 10000
 
 /**
  * @brief 定时器最大订阅数量
  */
-#define MAX_TIME_SUBSCRIPTIONS 4
+#define MAX_TIME_SUBSCRIPTIONS 256
+
+/**
+ * @brief 时间轮的层数
+ */
+#define TIM_WHEEL_LEVELS 4
+
+/**
+ * @brief 每层时间轮槽数的位数,每层 1 << TIM_WHEEL_BITS 个槽
+ * @details 4 层 64 槽可以覆盖 2^24 个节拍,10kHz 下约 27 分钟
+ */
+#define TIM_WHEEL_BITS 6
+
+/**
+ * @brief 每层时间轮的槽数
+ */
+#define TIM_WHEEL_SIZE (1U << TIM_WHEEL_BITS)
 
+/**
+ * @brief 把毫秒换算为节拍数
+ */
+#define TIM_MS_TO_TICKS(ms) ((uint32_t)(ms) * (TIM_TICK_HZ / 1000U))
+
+/*==================== 软件定时器类型 ====================*/
+
+/**
+ * @brief 软件定时器回调
+ * @param ctx 订阅时传入的上下文
+ * @note 在硬件定时器中断中调用,必须足够短
+ */
+typedef void (*TimCallback_t)(void* ctx);
+
+/**
+ * @brief 软件定时器句柄
+ * @details 低16位为存储池下标,高16位为代数,防止取消已经被复用的定时器
+ */
+typedef uint32_t TimHandle_t;
+
+/**
+ * @brief 单个软件定时器的抖动统计,单位为 DWT 周期
+ * @details 抖动为相邻两次触发的间隔与标称周期之差的绝对值,只对周期定时器统计
+ */
+struct TimJitterStats
+{
+    uint32_t fires;                  /*!< 触发次数 */
+    uint32_t lastJitterCycles;       /*!< 最近一次的抖动 */
+    uint32_t maxJitterCycles;        /*!< 抖动的最大值 */
+    uint32_t avgJitterCycles;        /*!< 抖动的滑动平均(1/16 权重) */
+    uint32_t maxRunCycles;           /*!< 回调执行耗时的最大值 */
+};
 
 /*======================= TIM 管理器类 =======================*/
 /**
- * @brief 定时器
- * 
+ * @brief 定时器管理器类
+ * @details
+ * 1. 采用单例模式,只占用 TIM_MANAGER_DEVICE 一个硬件定时器,以 TIM_TICK_HZ 产生节拍。
+ * 2. 软件定时器挂在 TIM_WHEEL_LEVELS 层分层时间轮的双向链表上,插入和取消都是 O(1)。
+ * 3. 每个节拍只处理第 0 层的一个槽,高层的槽在低层转满一圈时向下层级联。
+ * 4. 全部使用静态存储池,不进行动态内存分配。
  */
 class TimManger{
+public:
+
+    /**
+     * @brief 获取 TimManger 的单例实例
+     */
+    static TimManger& GetInstance();
+
+    /**
+     * @brief 启动硬件定时器,重复调用什么也不做
+     * @return 启动操作的状态
+     */
+    MW_Status Start();
+
+    /**
+     * @brief 订阅一个周期软件定时器
+     * @param periodTicks 周期(节拍)
+     * @param callback 回调函数
+     * @param ctx 透传给回调的上下文
+     * @param firstDelayTicks 第一次触发前的延时(节拍),为 0 时等于周期
+     * @return result 为定时器句柄, status 为订阅操作的状态
+     */
+    MW_FuncStatus<TimHandle_t> Subscribe(uint32_t periodTicks, TimCallback_t callback, void* ctx, uint32_t firstDelayTicks = 0);
+
+    /**
+     * @brief 订阅一个单次软件定时器,触发后自动释放
+     * @param delayTicks 延时(节拍)
+     * @param callback 回调函数
+     * @param ctx 透传给回调的上下文
+     * @return result 为定时器句柄, status 为订阅操作的状态
+     */
+    MW_FuncStatus<TimHandle_t> OneShot(uint32_t delayTicks, TimCallback_t callback, void* ctx);
+
+    /**
+     * @brief 取消一个软件定时器
+     * @param handle 定时器句柄
+     * @return 取消操作的状态
+     * @note 可以在回调中取消自身或其他定时器
+     */
+    MW_Status Cancel(TimHandle_t handle);
+
+    /**
+     * @brief 获取软件定时器的抖动统计
+     * @param handle 定时器句柄
+     * @param stats 用于接收统计数据的引用
+     * @return 查询操作的状态
+     */
+    MW_Status GetStats(TimHandle_t handle, TimJitterStats& stats);
+
+    /**
+     * @brief 获取当前节拍数
+     */
+    uint32_t NowTicks() const { return Now; }
+
+    /**
+     * @brief 获取当前已订阅(尚未取消或触发)的软件定时器数量
+     * @details 启动编排据此判断是否需要启动硬件定时器
+     */
+    uint16_t GetActiveCount() const { return ActiveCount; }
+
+private:
+
+/*==================== TIM 管理器私有成员变量 ====================*/
+
+    /**
+     * @brief 时间轮中的一个软件定时器
+     */
+    struct TimEntry{
+        TimCallback_t callback;
+        void* ctx;
+        uint32_t periodTicks;            /*!< 0 表示单次定时器 */
+        uint32_t expiry;                 /*!< 到期的节拍 */
+        uint32_t lastFireCycles;         /*!< 上一次触发的 DWT 周期 */
+        TimJitterStats stats;
+        uint16_t prev;
+        uint16_t next;
+        uint16_t generation;
+        uint8_t level;                   /*!< 所在层,只在 linked 为 true 时有效 */
+        uint8_t slot;                    /*!< 所在槽 */
+        bool used;
+        bool linked;
+    };
+
+    /**
+     * @brief 软件定时器存储池
+     */
+    TimEntry Pool[MAX_TIME_SUBSCRIPTIONS];
+
+    /**
+     * @brief 分层时间轮,每个槽保存链表头的存储池下标
+     */
+    uint16_t Wheel[TIM_WHEEL_LEVELS][TIM_WHEEL_SIZE];
+
+    /**
+     * @brief 空闲存储池链表头,空闲项通过 next 串联
+     */
+    uint16_t FreeHead;
+
+    /**
+     * @brief 已订阅的软件定时器数量
+     */
+    volatile uint16_t ActiveCount;
+
+    /**
+     * @brief 当前节拍
+     */
+    volatile uint32_t Now;
+
+    /**
+     * @brief 每个节拍对应的 DWT 周期数
+     */
+    uint32_t CyclesPerTick;
+
+    /**
+     * @brief TimManger 占用的硬件定时器
+     */
+    Timer Tim;
+
+    /**
+     * @brief 硬件定时器是否已经启动
+     */
+    volatile bool TimIsInit;
+
+/*==================== TIM 管理器私有成员函数 ====================*/
+
+    /**
+     * @brief 私有构造函数
+     */
+    TimManger();
+
+    /**
+     * @brief 析构默认
+     */
+    ~TimManger() = default;
+
+    /**
+     * @brief 拷贝构造私有
+     */
+    TimManger(const TimManger&) = delete;
+
+    /**
+     * @brief 赋值运算私有
+     */
+    TimManger& operator=(const TimManger&) = delete;
+
+    /**
+     * @brief 分配存储池并挂入时间轮
+     */
+    MW_FuncStatus<TimHandle_t> Add(uint32_t delayTicks, uint32_t periodTicks, TimCallback_t callback, void* ctx);
+
+    /**
+     * @brief 按到期节拍把定时器挂到对应层的槽上,必须在临界区内调用
+     */
+    void Link(uint16_t index);
+
+    /**
+     * @brief 把定时器从所在的槽上摘下,必须在临界区内调用
+     */
+    void Unlink(uint16_t index);
+
+    /**
+     * @brief 把定时器放回空闲链表,必须在临界区内调用
+     */
+    void Release(uint16_t index);
+
+    /**
+     * @brief 校验句柄并返回存储池下标,无效时返回 0xFFFF,必须在临界区内调用
+     */
+    uint16_t IndexOf(TimHandle_t handle) const;
+
+    /**
+     * @brief 把第 level 层当前槽上的定时器重新挂到更低的层,必须在临界区内调用
+     */
+    void Cascade(uint8_t level);
 
-    
+    /**
+     * @brief 硬件定时器的中断回调,推进一个节拍
+     */
+    static void OnTick();
 };
 
 #endif /* B2MW_TIMER_HPP */
- 
\ No newline at end of file
@@ -1,51 +1,227 @@
+/*===========================================================
+* @file      MW_RingBuffer.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* MW_Common.hpp
+* cmsis_compiler.h
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 中间件通用的固定容量环形队列
+* 1. 定义了 RingIndex 模板，容量为2的幂时用掩码回绕下标，否则用比较回绕，都不使用除法。
+* 2. 定义了 RingBuffer 模板，通用环形队列，需要外部临界区保护。
+* 3. 定义了 SpscRingBuffer 模板，单生产者/单消费者无锁环形队列，
+*    一个中断和一个任务之间使用时不需要关中断。
+* 4. 两种队列都提供批量读写(最多两段 memcpy)和 reserve/commit、peek_contiguous/consume
+*    连续区接口，DMA 可以直接读写队列内存，不需要中间拷贝。
+* 5. 元素存放在未构造的对齐存储中，入队时才构造、出队时析构，
+*    支持 emplace 与移动语义，不要求元素可默认构造。
+* 6. 定义了 RingOverflowPolicy 枚举，RingBuffer 满时可以选择拒绝新元素或覆盖最旧元素，
+*    并支持按新旧程度 O(1) 随机访问和从旧到新的遍历，可直接作为历史数据缓冲区。
+* ===========================================================
+* @version   1.4
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
 #ifndef MW_RINGBUFFER_HPP
 #define MW_RINGBUFFER_HPP
 
+/*========================= 文件依赖 =========================*/
 
 #include "MW_Common.hpp"
-#include <array>
+#include "cmsis_compiler.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*==================== 环形队列下标回绕 ====================*/
+
+/**
+ * @brief 判断一个数是否为2的幂
+ */
+constexpr bool MW_IsPowerOfTwo(uint32_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+/**
+ * @brief 环形队列的下标回绕,容量不是2的幂时用一次比较代替取模
+ * @tparam Size 缓冲区的最大容量
+ */
+template <uint32_t Size, bool Pow2 = MW_IsPowerOfTwo(Size)>
+struct RingIndex {
+    /**
+     * @brief 返回下标 i 的下一个位置,i 必须小于 Size
+     */
+    static constexpr uint32_t next(uint32_t i) {
+        return (i + 1 == Size) ? 0 : (i + 1);
+    }
+
+    /**
+     * @brief 返回下标 i 向后 n 个位置,i 必须小于 Size, n 不能大于 Size
+     */
+    static constexpr uint32_t advance(uint32_t i, uint32_t n) {
+        return (i + n >= Size) ? (i + n - Size) : (i + n);
+    }
+};
+
+/**
+ * @brief 容量为2的幂时的特化,用掩码回绕下标
+ */
+template <uint32_t Size>
+struct RingIndex<Size, true> {
+    static constexpr uint32_t next(uint32_t i) {
+        return (i + 1) & (Size - 1);
+    }
+
+    static constexpr uint32_t advance(uint32_t i, uint32_t n) {
+        return (i + n) & (Size - 1);
+    }
+};
+
+/*==================== 环形队列元素存储 ====================*/
+
+/**
+ * @brief 环形队列的未构造元素存储
+ * @tparam T 存储的元素类型
+ * @tparam Size 元素个数
+ * @details 只提供按下标取地址,元素的构造和析构由队列负责
+ */
+template <typename T, uint32_t Size>
+class RingStorage {
+public:
+    T* slot(uint32_t i) {
+        return std::launder(reinterpret_cast<T*>(&raw[i]));
+    }
+
+    const T* slot(uint32_t i) const {
+        return std::launder(reinterpret_cast<const T*>(&raw[i]));
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type raw[Size];
+};
+
+/*==================== 环形队列满时的策略 ====================*/
+
+/**
+ * @brief 环形队列满时的策略
+ * @details
+ *  RING_REJECT_NEW-拒绝新元素,push 返回 RESOURCE_BUSY(默认,用于消息队列)
+ *  RING_OVERWRITE_OLDEST-丢弃最旧的元素,push 总是成功(用于遥测、传感器历史、追踪缓冲)
+ */
+enum RingOverflowPolicy : uint8_t
+{
+    RING_REJECT_NEW = 0,
+    RING_OVERWRITE_OLDEST = 1
+};
+
+/*======================= 通用环形队列 =======================*/
 
 /**
  * @brief 一个通用的、固定大小、无动态内存分配的环形队列缓冲区 (Ring Buffer)
  * @tparam T 存储的元素类型
  * @tparam Size 缓冲区的最大容量
+ * @tparam Policy 队列满时的策略
  * @note 这个实现不是线程安全的。如果在中断和主循环中同时访问，需要用户在外部处理临界区（例如关中断）。
+ *       只有一个生产者和一个消费者时可以使用不需要临界区的 SpscRingBuffer。
  */
-template <typename T, uint32_t Size>
+template <typename T, uint32_t Size, RingOverflowPolicy Policy = RING_REJECT_NEW>
 class RingBuffer {
+    static_assert(Size > 0, "RingBuffer size must be positive");
 public:
+    /**
+     * @brief 从最旧到最新遍历队列的迭代器
+     * @tparam Q RingBuffer 或 const RingBuffer
+     * @tparam V T 或 const T
+     */
+    template <typename Q, typename V>
+    class Iter {
+    public:
+        Iter(Q* ring, uint32_t pos) : ring(ring), pos(pos) {}
+        V& operator*() const { return *ring->buffer.slot(RingIndex<Size>::advance(ring->head, pos)); }
+        V* operator->() const { return &**this; }
+        Iter& operator++() { pos++; return *this; }
+        bool operator!=(const Iter& other) const { return pos != other.pos; }
+        bool operator==(const Iter& other) const { return pos == other.pos; }
+    private:
+        Q* ring;
+        uint32_t pos;           /*!< 距最旧元素的偏移 */
+    };
+
+    typedef Iter<RingBuffer, T> iterator;
+    typedef Iter<const RingBuffer, const T> const_iterator;
+
     /**
      * @brief 构造函数，初始化环形缓冲区
      * @details 初始化头指针、尾指针和元素计数器为 0
      */
     RingBuffer() : head(0), tail(0), count(0) {};
 
+    /**
+     * @brief 析构时析构队列中剩余的元素
+     */
+    ~RingBuffer() {
+        clear();
+    }
+
+    /**
+     * @brief 队列持有元素的所有权,禁止拷贝
+     */
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
     /**
      * @brief 向队列尾部压入一个元素
      * @param item 要压入的元素
-     * @return 如果队列未满，成功压入则返回 MW_Status::SUCCESS；否则返回 MW_Status::ERROR 
+     * @return 如果队列未满，成功压入则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
      */
     MW_Status push(const T& item) {
+        return emplace(item);
+    }
+
+    /**
+     * @brief 向队列尾部移入一个元素
+     * @param item 要移入的元素,成功后处于被移动后的状态
+     * @return 如果队列未满，成功压入则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
+     */
+    MW_Status push(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    /**
+     * @brief 在队列尾部直接构造一个元素
+     * @param args 元素构造函数的参数
+     * @return 如果队列未满，成功构造则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
+     */
+    template <typename... Args>
+    MW_Status emplace(Args&&... args) {
         if (is_full()) {
-            return MW_Status::RESOURCE_BUSY;
+            if (Policy == RING_REJECT_NEW) {
+                return MW_Status::RESOURCE_BUSY;
+            }
+            drop_oldest(1);
         }
-        buffer[tail] = item;
-        tail = (tail + 1) % Size;
+        new (buffer.slot(tail)) T(std::forward<Args>(args)...);
+        tail = RingIndex<Size>::next(tail);
         count++;
         return MW_Status::SUCCESS;
     }
 
     /**
      * @brief 从队列头部弹出一个元素
-     * @param item 用于接收弹出元素的引用
+     * @param item 用于接收弹出元素的引用,元素被移动赋值给它
      * @return 如果队列不为空，成功弹出则返回 MW_Status::SUCCESS；否则返回 MW_Status::ERROR 
      */
     MW_Status pop(T& item) {
         if (is_empty()) {
             return MW_Status::ERROR;
         }
-        item = buffer[head];
-        head = (head + 1) % Size;
+        T* p = buffer.slot(head);
+        item = std::move(*p);
+        p->~T();
+        head = RingIndex<Size>::next(head);
         count--;
         return MW_Status::SUCCESS;
     }
@@ -59,10 +235,54 @@ public:
         if (is_empty()) {
             return MW_Status::ERROR;
         }
-        item = buffer[head];
+        item = *buffer.slot(head);
         return MW_Status::SUCCESS;
     }
 
+    /**
+     * @brief 获取队列头部元素的指针,不拷贝
+     * @return 队列为空时返回 nullptr
+     */
+    T* front() {
+        return is_empty() ? nullptr : buffer.slot(head);
+    }
+
+    /**
+     * @brief 按新旧程度随机访问元素,O(1)
+     * @param age 0 为最新的元素, size() - 1 为最旧的元素,必须小于 size()
+     */
+    T& operator[](uint32_t age) {
+        return *buffer.slot(RingIndex<Size>::advance(tail, Size - 1 - age));
+    }
+
+    const T& operator[](uint32_t age) const {
+        return *buffer.slot(RingIndex<Size>::advance(tail, Size - 1 - age));
+    }
+
+    /**
+     * @brief 从最旧到最新遍历,遍历期间不能压入或弹出元素
+     */
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    /**
+     * @brief 析构并丢弃队列中的全部元素
+     */
+    void clear() {
+        if (!std::is_trivially_destructible<T>::value) {
+            while (count > 0) {
+                buffer.slot(head)->~T();
+                head = RingIndex<Size>::next(head);
+                count--;
+            }
+        }
+        head = 0;
+        tail = 0;
+        count = 0;
+    }
+
     /**
      * @brief 检查队列是否已满
      * @return 如果队列已满，则返回 true；否则返回 false
@@ -95,11 +315,414 @@ public:
         return Size;
     }
 
+    /**
+     * @brief 批量压入元素
+     * @param src 要压入的元素数组
+     * @param n 要压入的元素数量
+     * @return 实际压入的元素数量
+     * @details 拒绝策略下空间不足时只压入能放下的部分;
+     *          覆盖策略下丢弃最旧的元素,n 超过容量时只保留 src 中最新的 Size 个
+     * @note 回绕处最多分两段 memcpy,只能用于可平凡拷贝的类型
+     */
+    uint32_t push_bulk(const T* src, uint32_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk copy requires a trivially copyable T");
+        uint32_t space = Size - count;
+        if (Policy == RING_OVERWRITE_OLDEST) {
+            if (n > Size) {
+                src += n - Size;
+                n = Size;
+            }
+            if (n > space) {
+                drop_oldest(n - space);
+            }
+        } else if (n > space) {
+            n = space;
+        }
+        uint32_t first = Size - tail;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(buffer.slot(tail), src, first * sizeof(T));
+        memcpy(buffer.slot(0), src + first, (n - first) * sizeof(T));
+        tail = RingIndex<Size>::advance(tail, n);
+        count += n;
+        return n;
+    }
+
+    /**
+     * @brief 批量弹出元素,元素不足时只弹出已有的部分
+     * @param dst 用于接收元素的数组
+     * @param n 最多弹出的元素数量
+     * @return 实际弹出的元素数量
+     */
+    uint32_t pop_bulk(T* dst, uint32_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk copy requires a trivially copyable T");
+        if (n > count) {
+            n = count;
+        }
+        uint32_t first = Size - head;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(dst, buffer.slot(head), first * sizeof(T));
+        memcpy(dst + first, buffer.slot(0), (n - first) * sizeof(T));
+        head = RingIndex<Size>::advance(head, n);
+        count -= n;
+        return n;
+    }
+
+    /**
+     * @brief 预留队尾的一段连续空间,供 DMA 或调用者直接写入
+     * @param ptr 用于接收连续空间起始地址的引用
+     * @param max 最多需要的元素数量
+     * @return 连续空间的长度,为 0 表示队列已满
+     * @details 写入后调用 commit 使元素可见,预留本身不改变队列
+     */
+    uint32_t reserve(T*& ptr, uint32_t max) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw writes require a trivially copyable T");
+        uint32_t n = Size - count;
+        if (n > Size - tail) {
+            n = Size - tail;
+        }
+        if (n > max) {
+            n = max;
+        }
+        ptr = buffer.slot(tail);
+        return n;
+    }
+
+    /**
+     * @brief 提交已经写入预留空间的元素
+     * @param n 提交的元素数量,不能超过 reserve 返回的长度
+     * @return 提交操作的状态, n 超过空闲空间时返回 MW_Status::INVALID_PARAM
+     */
+    MW_Status commit(uint32_t n) {
+        if (n > Size - count) {
+            return MW_Status::INVALID_PARAM;
+        }
+        tail = RingIndex<Size>::advance(tail, n);
+        count += n;
+        return MW_Status::SUCCESS;
+    }
+
+    /**
+     * @brief 获取队头的一段连续元素,供 DMA 或调用者直接读取
+     * @param ptr 用于接收连续元素起始地址的引用
+     * @return 连续元素的数量,为 0 表示队列为空
+     * @details 读完后调用 consume 释放空间,回绕时需要调用两次
+     */
+    uint32_t peek_contiguous(const T*& ptr) const {
+        uint32_t n = count;
+        if (n > Size - head) {
+            n = Size - head;
+        }
+        ptr = buffer.slot(head);
+        return n;
+    }
+
+    /**
+     * @brief 释放队头已经读取的元素
+     * @param n 释放的元素数量
+     * @return 释放操作的状态, n 超过元素数量时返回 MW_Status::INVALID_PARAM
+     */
+    MW_Status consume(uint32_t n) {
+        if (n > count) {
+            return MW_Status::INVALID_PARAM;
+        }
+        drop_oldest(n);
+        return MW_Status::SUCCESS;
+    }
+
 private:
-    std::array<T, Size> buffer;
+    RingStorage<T, Size> buffer;
     uint32_t head;
     uint32_t tail;
     uint32_t count;
+
+    /**
+     * @brief 析构并丢弃最旧的 n 个元素,n 不能超过 count
+     */
+    void drop_oldest(uint32_t n) {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (uint32_t i = 0; i < n; i++) {
+                buffer.slot(RingIndex<Size>::advance(head, i))->~T();
+            }
+        }
+        head = RingIndex<Size>::advance(head, n);
+        count -= n;
+    }
+};
+
+/*================ 单生产者/单消费者无锁环形队列 ================*/
+
+/**
+ * @brief 单生产者/单消费者无锁环形队列
+ * @tparam T 存储的元素类型
+ * @tparam Size 缓冲区的最大容量,必须是2的幂
+ * @details
+ * 1. head 只由消费者写, tail 只由生产者写,两者都是自由递增的计数,
+ *    tail - head 即为元素数量,不需要单独的 count,也不浪费一个存储位。
+ * 2. 生产者先写元素再发布 tail,消费者先读 tail 再读元素,两次之间用 __DMB 保证顺序。
+ * 3. 一个中断和一个任务(或两个不会互相抢占的上下文)之间使用时不需要关中断。
+ * @note 多个生产者或多个消费者时必须使用 RingBuffer 并自行加临界区。
+ */
+template <typename T, uint32_t Size>
+class SpscRingBuffer {
+    static_assert(MW_IsPowerOfTwo(Size), "SpscRingBuffer size must be a power of two");
+public:
+    /**
+     * @brief 构造函数，初始化读写计数
+     */
+    SpscRingBuffer() : head(0), tail(0) {};
+
+    /**
+     * @brief 析构时析构队列中剩余的元素
+     */
+    ~SpscRingBuffer() {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (uint32_t h = head; h != tail; h++) {
+                buffer.slot(h & (Size - 1))->~T();
+            }
+        }
+    }
+
+    /**
+     * @brief 队列持有元素的所有权,禁止拷贝
+     */
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * @brief 向队列尾部压入一个元素,只能由生产者调用
+     * @param item 要压入的元素
+     * @return 如果队列未满，成功压入则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
+     */
+    MW_Status push(const T& item) {
+        return emplace(item);
+    }
+
+    /**
+     * @brief 向队列尾部移入一个元素,只能由生产者调用
+     * @param item 要移入的元素,成功后处于被移动后的状态
+     * @return 如果队列未满，成功压入则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
+     */
+    MW_Status push(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    /**
+     * @brief 在队列尾部直接构造一个元素,只能由生产者调用
+     * @param args 元素构造函数的参数
+     * @return 如果队列未满，成功构造则返回 MW_Status::SUCCESS；否则返回 MW_Status::RESOURCE_BUSY
+     */
+    template <typename... Args>
+    MW_Status emplace(Args&&... args) {
+        uint32_t t = tail;
+        if (t - head == Size) {
+            return MW_Status::RESOURCE_BUSY;
+        }
+        new (buffer.slot(t & (Size - 1))) T(std::forward<Args>(args)...);
+        /* 元素构造完之后才能对消费者可见 */
+        __DMB();
+        tail = t + 1;
+        return MW_Status::SUCCESS;
+    }
+
+    /**
+     * @brief 从队列头部弹出一个元素,只能由消费者调用
+     * @param item 用于接收弹出元素的引用
+     * @return 如果队列不为空，成功弹出则返回 MW_Status::SUCCESS；否则返回 MW_Status::ERROR
+     */
+    MW_Status pop(T& item) {
+        uint32_t h = head;
+        if (tail == h) {
+            return MW_Status::ERROR;
+        }
+        /* 看到新的 tail 之后才能读元素 */
+        __DMB();
+        T* p = buffer.slot(h & (Size - 1));
+        item = std::move(*p);
+        p->~T();
+        /* 元素析构之后才能把位置还给生产者 */
+        __DMB();
+        head = h + 1;
+        return MW_Status::SUCCESS;
+    }
+
+    /**
+     * @brief 查看队列头部的元素，但不弹出,只能由消费者调用
+     * @param item 用于接收元素的引用
+     * @return 如果队列不为空，则返回 MW_Status::SUCCESS；否则返回 MW_Status::ERROR
+     */
+    MW_Status peek(T& item) const {
+        uint32_t h = head;
+        if (tail == h) {
+            return MW_Status::ERROR;
+        }
+        __DMB();
+        item = *buffer.slot(h & (Size - 1));
+        return MW_Status::SUCCESS;
+    }
+
+    /**
+     * @brief 检查队列是否已满,在消费者一侧调用时结果可能已经过时
+     */
+    bool is_full() const {
+        return tail - head == Size;
+    }
+
+    /**
+     * @brief 检查队列是否为空,在生产者一侧调用时结果可能已经过时
+     */
+    bool is_empty() const {
+        return tail == head;
+    }
+
+    /**
+     * @brief 获取当前队列中的元素数量
+     */
+    uint32_t size() const {
+        return tail - head;
+    }
+
+    /**
+     * @brief 获取队列的最大容量
+     */
+    uint32_t capacity() const {
+        return Size;
+    }
+
+    /**
+     * @brief 批量压入元素,只能由生产者调用,空间不足时只压入能放下的部分
+     * @param src 要压入的元素数组
+     * @param n 要压入的元素数量
+     * @return 实际压入的元素数量
+     * @note 回绕处最多分两段 memcpy,全部写完后一次发布 tail
+     */
+    uint32_t push_bulk(const T* src, uint32_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk copy requires a trivially copyable T");
+        uint32_t t = tail;
+        uint32_t space = Size - (t - head);
+        if (n > space) {
+            n = space;
+        }
+        uint32_t idx = t & (Size - 1);
+        uint32_t first = Size - idx;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(buffer.slot(idx), src, first * sizeof(T));
+        memcpy(buffer.slot(0), src + first, (n - first) * sizeof(T));
+        __DMB();
+        tail = t + n;
+        return n;
+    }
+
+    /**
+     * @brief 批量弹出元素,只能由消费者调用,元素不足时只弹出已有的部分
+     * @param dst 用于接收元素的数组
+     * @param n 最多弹出的元素数量
+     * @return 实际弹出的元素数量
+     */
+    uint32_t pop_bulk(T* dst, uint32_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk copy requires a trivially copyable T");
+        uint32_t h = head;
+        uint32_t avail = tail - h;
+        if (n > avail) {
+            n = avail;
+        }
+        __DMB();
+        uint32_t idx = h & (Size - 1);
+        uint32_t first = Size - idx;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(dst, buffer.slot(idx), first * sizeof(T));
+        memcpy(dst + first, buffer.slot(0), (n - first) * sizeof(T));
+        __DMB();
+        head = h + n;
+        return n;
+    }
+
+    /**
+     * @brief 预留队尾的一段连续空间,只能由生产者调用
+     * @param ptr 用于接收连续空间起始地址的引用
+     * @param max 最多需要的元素数量
+     * @return 连续空间的长度,为 0 表示队列已满
+     * @details 写入(或 DMA 写入完成)后调用 commit 发布
+     */
+    uint32_t reserve(T*& ptr, uint32_t max) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw writes require a trivially copyable T");
+        uint32_t t = tail;
+        uint32_t idx = t & (Size - 1);
+        uint32_t n = Size - (t - head);
+        if (n > Size - idx) {
+            n = Size - idx;
+        }
+        if (n > max) {
+            n = max;
+        }
+        ptr = buffer.slot(idx);
+        return n;
+    }
+
+    /**
+     * @brief 发布已经写入预留空间的元素,只能由生产者调用
+     * @param n 发布的元素数量,不能超过 reserve 返回的长度
+     * @return 发布操作的状态, n 超过空闲空间时返回 MW_Status::INVALID_PARAM
+     */
+    MW_Status commit(uint32_t n) {
+        uint32_t t = tail;
+        if (n > Size - (t - head)) {
+            return MW_Status::INVALID_PARAM;
+        }
+        __DMB();
+        tail = t + n;
+        return MW_Status::SUCCESS;
+    }
+
+    /**
+     * @brief 获取队头的一段连续元素,只能由消费者调用
+     * @param ptr 用于接收连续元素起始地址的引用
+     * @return 连续元素的数量,为 0 表示队列为空
+     * @details 读完(或 DMA 发送完成)后调用 consume 释放,回绕时需要调用两次
+     */
+    uint32_t peek_contiguous(const T*& ptr) const {
+        uint32_t h = head;
+        uint32_t n = tail - h;
+        __DMB();
+        uint32_t idx = h & (Size - 1);
+        if (n > Size - idx) {
+            n = Size - idx;
+        }
+        ptr = buffer.slot(idx);
+        return n;
+    }
+
+    /**
+     * @brief 释放队头已经读取的元素,只能由消费者调用
+     * @param n 释放的元素数量
+     * @return 释放操作的状态, n 超过元素数量时返回 MW_Status::INVALID_PARAM
+     */
+    MW_Status consume(uint32_t n) {
+        uint32_t h = head;
+        if (n > tail - h) {
+            return MW_Status::INVALID_PARAM;
+        }
+        __DMB();
+        if (!std::is_trivially_destructible<T>::value) {
+            for (uint32_t i = 0; i < n; i++) {
+                buffer.slot((h + i) & (Size - 1))->~T();
+            }
+        }
+        head = h + n;
+        return MW_Status::SUCCESS;
+    }
+
+private:
+    RingStorage<T, Size> buffer;
+    volatile uint32_t head;          /*!< 已读出的元素总数,只由消费者写 */
+    volatile uint32_t tail;          /*!< 已写入的元素总数,只由生产者写 */
 };
 
 #endif /* MW_RINGBUFFER_HPP */
\ No newline at end of file
@@ -9,9 +9,13 @@
 * ===========================================================
 * 该文件功能表述(先声明后定义):
 * 1.实现了CANManager类的成员函数
+* 2.实现了CAN工作任务,在任务上下文中投递延迟订阅的消息
+* 3.实现了基于哈希时间轮的 CAN ID 在线监视
+* 4.实现了按 周期+相位 分散发送的周期帧调度器
+* 5.实现了单帧发送确认令牌
 * ===========================================================
-* @version   1.2
-* @date      2025-11-14
+* @version   1.7
+* @date      2026-10-18
 * @copyright Copyright (c) 2025
 ============================================================*/
 
@@ -19,13 +23,38 @@
 
 #include "MW_RingBuffer.hpp"
 #include "B2MW_CANManager.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+/**
+ * @brief 时间轮链表和哈希表中的空下标
+ */
+static constexpr uint8_t CAN_WATCH_NONE = 0xFF;
+
+/**
+ * @brief 哈希表中被删除的位置,查找时需要继续探测
+ */
+static constexpr uint8_t CAN_WATCH_DELETED = 0xFE;
+
+static_assert((CAN_WATCH_WHEEL_SIZE & (CAN_WATCH_WHEEL_SIZE - 1)) == 0, "CAN_WATCH_WHEEL_SIZE must be a power of two");
+static_assert((CAN_WATCH_HASH_SIZE & (CAN_WATCH_HASH_SIZE - 1)) == 0, "CAN_WATCH_HASH_SIZE must be a power of two");
+static_assert(CAN_WATCH_HASH_SIZE >= 2 * MAX_CAN_WATCHES, "CAN_WATCH_HASH_SIZE is too small");
+static_assert(MAX_CAN_WATCHES < CAN_WATCH_DELETED, "MAX_CAN_WATCHES is too large");
+
+/**
+ * @brief 每个发送时隙对应的 TimManger 节拍数
+ */
+static constexpr uint32_t CAN_TICKS_PER_SLOT = TIM_TICK_HZ / (1000U * CAN_TX_SLOTS_PER_MS);
+
+static_assert(TIM_TICK_HZ % (1000U * CAN_TX_SLOTS_PER_MS) == 0, "TIM_TICK_HZ must be a multiple of the CAN slot rate");
 
 /*================= CanManager的成员函数定义 =================*/
 
 /** 
  * @brief 构造函数,初始化CanManager的成员变量 
  */
-CanManager::CanManager():Can1(DEVICE_CAN_1),Can2(DEVICE_CAN_2),Timer6(DEVICE_TIMER_6),CanResource{&Can1,&Can2}
+CanManager::CanManager():Can1(DEVICE_CAN_1),Can2(DEVICE_CAN_2),CanResource{&Can1,&Can2}
 {
    /** 初始化CAN管理器的成员变量 */
    for(uint8_t i =USE_CAN_BEGIN ;i < USE_CAN_END; i++){
@@ -33,9 +62,34 @@ CanManager::CanManager():Can1(DEVICE_CAN_1),Can2(DEVICE_CAN_2),Timer6(DEVICE_TIM
       CanIsInit[i] = false;
    }
    TimIsInit = false;
+   TickHandle = 0;
    /* 上层中间件调用的CAN回调函数数组索引清0 */
    Can1CallbackArrayIndex = 0;
    Can2CallbackArrayIndex = 0;
+   /* CAN工作任务在第一次以任务方式订阅时才创建 */
+   for(uint8_t i = 0; i < CAN_DEFER_QUEUE_NUM; i++){
+      DeferQueue[i] = nullptr;
+   }
+   RxTaskHandle = nullptr;
+   RxTaskIsInit = false;
+   RxTaskCreating = false;
+   memset(RxStats, 0, sizeof(RxStats));
+   /* 在线监视的存储池、哈希表和时间轮全部置空 */
+   memset(WatchPool, 0, sizeof(WatchPool));
+   memset(WatchHash, CAN_WATCH_NONE, sizeof(WatchHash));
+   memset(WatchWheel, CAN_WATCH_NONE, sizeof(WatchWheel));
+   WatchNowMs = 0;
+   memset(CyclicTable, 0, sizeof(CyclicTable));
+   CyclicVersion = 0;
+   memset(MailboxToken, 0, sizeof(MailboxToken));
+   TxSlotNow = 0;
+   /* Can::Init 会配置全部接收的滤波器,初始规划与之一致 */
+   memset(AppliedFilter, 0, sizeof(AppliedFilter));
+   for(uint8_t i = USE_CAN_BEGIN; i < USE_CAN_END; i++){
+      AppliedFilter[i].acceptAll = true;
+      AppliedFilter[i].bankCount = 1;
+      RxIdEpoch[i] = 0;
+   }
 }; 
 
 /**
@@ -96,8 +150,7 @@ MW_Status CanManager::AskResource(USE_CanBus bus, Can::CanBaudRate baudRate, Can
  * @details 1. 依据上层中间件需要使用哪路CAN总线,就初始化哪路Can总线
  *          2. 如果使用CAN1，固定使用过滤器0，配置全通模式绑定FIFO 0
  *          3. 如果使用CAN2，固定使用过滤器14，配置全通模式绑定FIFO 0
- *          4. 初始化定时器以1kHZ频率触发中断
- *          5. 注册定时器中断回调函数processCanSendQueue      
+ *          4. 启动 TimManger,并以 1000 * CAN_TX_SLOTS_PER_MS Hz 订阅定时器回调OnTimerTick
  * @details
  *          1. 如果总线还没有被初始化，就初始化CAN总线。
  *          2. 如果总线已经被初始化，则什么也不做。 
@@ -119,6 +172,7 @@ MW_Status CanManager::StartResource(USE_CanBus bus){
    }
    BspResult<bool> OperationSuccess ;
    CanRxCallback_t CanRxCallback = (bus == USE_CAN1) ? CAN1_RxCallback : CAN2_RxCallback;
+   CanTxDoneCallback_t CanTxDoneCallback = (bus == USE_CAN1) ? CAN1_TxDoneCallback : CAN2_TxDoneCallback;
    
    /* 检查并更新CAN总线的初始化状态，此部分需要原子操作 */
    __disable_irq();
@@ -138,6 +192,7 @@ MW_Status CanManager::StartResource(USE_CanBus bus){
             return MW_Status::INVALID_OPERATION;
       }
       CanResource[bus]->SetRxFifo0Callback(CanRxCallback);
+      CanResource[bus]->SetTxDoneCallback(CanTxDoneCallback);
       CanResource[bus]->Start();
    }
    
@@ -149,19 +204,21 @@ MW_Status CanManager::StartResource(USE_CanBus bus){
    }
    __enable_irq();
 
-   /* 如果定时器还没有初始化*/
+   /* 如果还没有订阅定时器*/
    if(should_init_tim){
-      /*初始化定时器以1000Hz频率触发中断*/
-      OperationSuccess =Timer6.Init(1000);
-      /* 检查定时器初始化结果,如果失败返回无效操作 */
-      if(!OperationSuccess.ok()){
+      TimManger& TimMangerInstance = TimManger::GetInstance();
+      /* 启动共享的硬件定时器,如果失败返回无效操作 */
+      if(TimMangerInstance.Start() != MW_Status::SUCCESS){
          TimIsInit = false;
-         /*能跑到这里说明用户在其他地方使用了Bsp层的Timer资源,导致初始化失败*/
          return MW_Status::INVALID_OPERATION;
       }
-      Timer6.SetCallback(processCanSendQueue);
-      /*定时器启动*/
-      Timer6.Start();
+      /*每个发送时隙触发一次*/
+      MW_FuncStatus<TimHandle_t> TickResult = TimMangerInstance.Subscribe(CAN_TICKS_PER_SLOT, OnTimerTick, nullptr);
+      if(TickResult.status != MW_Status::SUCCESS){
+         TimIsInit = false;
+         return MW_Status::INVALID_OPERATION;
+      }
+      TickHandle = TickResult.result;
    }
    return MW_Status::SUCCESS;
 };
@@ -172,19 +229,23 @@ MW_Status CanManager::StartResource(USE_CanBus bus){
  * @param bus 要订阅的总线
  * @param canId 要订阅的CAN ID
  * @param callback 接收到消息时调用的回调函数 
+ * @param delivery 回调的投递方式
  * @details 由于修改了回调数组这个静态变量，所以需要保证其原子性
+ *          如果以任务方式订阅，会先确保CAN工作任务已经创建
  * @return 订阅操作的状态
  *         返回值:
  *         INVALID_PARAM 表示填入的参数无效,
- *         RESOURCE_BUSY 表示回调数组已满,
+ *         RESOURCE_BUSY 表示回调数组已满或工作任务正在被其他线程创建,
  *         SUCCESS 表示订阅成功
+ * @note 只要求总线已经被申请,因此可以在 B2MW_Manager 统一启动之前订阅,
+ *       滤波器规划才能看到全部ID
  */
-MW_Status CanManager::Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t callback){
+MW_Status CanManager::Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t callback, CanRxDelivery delivery){
    /*校验参数*/
    if(bus >=USE_CanBus::USE_CAN_END ){
       return MW_Status::INVALID_PARAM;
    }
-   if(CanIsInit[bus] == false){
+   if(NeedUSECAN[bus] == false){
       return MW_Status::INVALID_PARAM;
    }
    if(canId > CAN_STANDARD_ID_MAX){
@@ -193,6 +254,17 @@ MW_Status CanManager::Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t c
    if(callback == nullptr){
       return MW_Status::INVALID_PARAM;
    }
+   if(delivery >= CAN_DELIVERY_END){
+      return MW_Status::INVALID_PARAM;
+   }
+
+   /*以任务方式订阅时，需要CAN工作任务已经在运行*/
+   if(delivery != CAN_DELIVERY_ISR){
+      MW_Status res = StartRxTask();
+      if(res != MW_Status::SUCCESS){
+         return res;
+      }
+   }
 
    /*根据上层应用层提供的BUS选择操作资源*/
    Subscription* CallbackArray = (bus == USE_CAN1) ? Can1CallbackArray : Can2CallbackArray;
@@ -208,12 +280,18 @@ MW_Status CanManager::Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t c
    /*将canId和回调函数添加到回调数组中*/
    CallbackArray[CallbackArrayIndex].canId = canId;
    CallbackArray[CallbackArrayIndex].callback = callback;
+   CallbackArray[CallbackArrayIndex].delivery = delivery;
    /*更新没有被使用的回调函数数组索引*/
    CallbackArrayIndex++;
+   /*登记新ID,当前列表滤波器不包含它时需要退回全部接收*/
+   bool revert = NoteRxId(bus, canId);
 
    /*退出临界区*/
    __enable_irq();
 
+   if(revert){
+      RevertRxFilter(bus);
+   }
    return MW_Status::SUCCESS;
 };
 
@@ -229,13 +307,14 @@ MW_Status CanManager::Subscribe(USE_CanBus bus, uint32_t canId,CanRxCallback_t c
  *         INVALID_PARAM 表示参数无效,
  *         INVALID_OPERATION 表示没有找到匹配项,
  *         SUCCESS 表示取消订阅成功
+ * @note 与 Subscribe 一致,只要求总线已经被申请,B2MW_Manager 启动之前也可以取消订阅
 */
 MW_Status CanManager::UnSubscribe(USE_CanBus bus, uint32_t canId, CanRxCallback_t callback){
    /*校验参数*/
    if(bus >=USE_CanBus::USE_CAN_END ){
       return MW_Status::INVALID_PARAM;
    }
-   if(CanIsInit[bus] == false){
+   if(NeedUSECAN[bus] == false){
       return MW_Status::INVALID_PARAM;
    }
    if(canId > CAN_STANDARD_ID_MAX){
@@ -264,6 +343,7 @@ MW_Status CanManager::UnSubscribe(USE_CanBus bus, uint32_t canId, CanRxCallback_
          // 清空最后一个元素
          CallbackArray[CallbackArrayIndex-1].canId = 0;
          CallbackArray[CallbackArrayIndex-1].callback = nullptr;
+         CallbackArray[CallbackArrayIndex-1].delivery = CAN_DELIVERY_ISR;
          // 跟新没有被使用的回调函数数组索引
          CallbackArrayIndex--;
          found = true;
@@ -282,13 +362,16 @@ MW_Status CanManager::UnSubscribe(USE_CanBus bus, uint32_t canId, CanRxCallback_
  * @brief 发送CAN 消息到消息队列 (上层调用)
  * @param bus 要使用的总线
  * @param msg 要发送的消息
+ * @param token 可选的发送确认令牌
+ * @details 传入令牌时记录入队时刻并置为 QUEUED,之后由定时器中断和CAN中断推进其状态;
+ *          入队失败时令牌直接置为 FAILED
  * @return 发送操作的状态
  * @details 返回发送操作的状态,
  * INVALID_PARAM 表示参数无效,
  * RESOURCE_BUSY 表示消息队列已满,
  * SUCCESS 表示发送成功
  */
-MW_Status CanManager::sendMessage(USE_CanBus bus, const CanMessage& msg){
+MW_Status CanManager::sendMessage(USE_CanBus bus, const CanMessage& msg, CanTxToken* token){
    /*校验参数*/
    if(bus >=USE_CanBus::USE_CAN_END ){
       return MW_Status::INVALID_PARAM;
@@ -299,32 +382,495 @@ MW_Status CanManager::sendMessage(USE_CanBus bus, const CanMessage& msg){
    if(msg.id > CAN_STANDARD_ID_MAX){
       return MW_Status::INVALID_PARAM;
    }
-   
-   MW_Status res = MW_Status::SUCCESS;
-   /*根据上层应用层提供的BUS选择操作资源*/
-   switch (bus)
-   {
-   case USE_CAN1:
-      /*进入临界区, 确保发送操作的原子性*/
+
+   CanTxItem item;
+   item.msg = msg;
+   item.token = token;
+   if(token != nullptr){
+      token->failure = CAN_TX_FAIL_NONE;
+      token->mailboxCycles = 0;
+      token->completeCycles = 0;
+      token->enqueueCycles = DWT->CYCCNT;
+      token->state = CAN_TX_TOKEN_QUEUED;
+   }
+
+   /*进入临界区, 确保发送操作的原子性*/
+   __disable_irq();
+   MW_Status res = CanMsgSendQueue[bus].push(item);
+   __enable_irq();
+
+   if(res != MW_Status::SUCCESS && token != nullptr){
+      token->failure = CAN_TX_FAIL_QUEUE_FULL;
+      token->completeCycles = DWT->CYCCNT;
+      token->state = CAN_TX_TOKEN_FAILED;
+   }
+   return res;
+}
+
+/**
+ * @brief 获取指定CAN总线的接收分发统计
+ * @param bus 要查询的总线
+ * @param stats 用于接收统计数据的引用
+ * @return 查询操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         SUCCESS 表示查询成功
+ */
+MW_Status CanManager::GetRxStats(USE_CanBus bus, CanRxStats& stats){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return MW_Status::INVALID_PARAM;
+   }
+   /*统计数据在中断中更新,复制时需要保证一致性*/
+   __disable_irq();
+   stats = RxStats[bus];
+   __enable_irq();
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 监视指定 CAN ID 的在线状态
+ * @param bus 设备所在的总线
+ * @param canId 要监视的 CAN ID
+ * @param timeoutMs 超过该时间没有收到消息即判定为离线
+ * @param callback 上线/离线时调用的回调函数
+ * @details 1. 在存储池中分配一个监视项并插入哈希表
+ *          2. 新的监视项处于离线状态且不在时间轮上,收到第一帧后才开始计时
+ * @return 监视操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         INVALID_OPERATION 表示该 CAN ID 已经被监视,
+ *         RESOURCE_BUSY 表示监视项已满,
+ *         SUCCESS 表示监视成功
+ */
+MW_Status CanManager::WatchOnline(USE_CanBus bus, uint32_t canId, uint32_t timeoutMs, CanOnlineCallback_t callback){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(canId > CAN_STANDARD_ID_MAX){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(timeoutMs == 0 || timeoutMs > 0x7FFFFFFF){
+      return MW_Status::INVALID_PARAM;
+   }
+
+   MW_Status res = MW_Status::RESOURCE_BUSY;
+
+   /*进入临界区, 哈希表和存储池会在中断中被访问*/
+   __disable_irq();
+   if(FindWatch(bus, canId) != CAN_WATCH_NONE){
+      res = MW_Status::INVALID_OPERATION;
+   }else{
+      for(uint8_t i = 0; i < MAX_CAN_WATCHES; i++){
+         if(WatchPool[i].used){
+            continue;
+         }
+         /*在哈希表中找到第一个空位或删除位*/
+         uint8_t pos = WatchHashOf(bus, canId);
+         while(WatchHash[pos] != CAN_WATCH_NONE && WatchHash[pos] != CAN_WATCH_DELETED){
+            pos = (pos + 1) & (CAN_WATCH_HASH_SIZE - 1);
+         }
+         OnlineWatch& w = WatchPool[i];
+         w.canId = canId;
+         w.bus = bus;
+         w.timeoutMs = timeoutMs;
+         w.lastRxMs = WatchNowMs;
+         w.deadlineMs = 0;
+         w.callback = callback;
+         w.online = false;
+         w.inWheel = false;
+         w.prev = CAN_WATCH_NONE;
+         w.next = CAN_WATCH_NONE;
+         w.used = true;
+         WatchHash[pos] = i;
+         res = MW_Status::SUCCESS;
+         break;
+      }
+   }
+   /*监视的ID也必须能通过滤波器,否则设备永远不会上线*/
+   bool revert = (res == MW_Status::SUCCESS) && NoteRxId(bus, canId);
+   /*退出临界区*/
+   __enable_irq();
+
+   if(revert){
+      RevertRxFilter(bus);
+   }
+   return res;
+}
+
+/**
+ * @brief 取消对指定 CAN ID 的在线监视
+ * @param bus 设备所在的总线
+ * @param canId 要取消监视的 CAN ID
+ * @return 取消监视操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         INVALID_OPERATION 表示该 CAN ID 没有被监视,
+ *         SUCCESS 表示取消成功
+ */
+MW_Status CanManager::UnWatchOnline(USE_CanBus bus, uint32_t canId){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(canId > CAN_STANDARD_ID_MAX){
+      return MW_Status::INVALID_PARAM;
+   }
+
+   bool found = false;
+
+   /*进入临界区*/
+   __disable_irq();
+   uint8_t pos = WatchHashOf(bus, canId);
+   for(uint8_t probe = 0; probe < CAN_WATCH_HASH_SIZE; probe++){
+      uint8_t index = WatchHash[pos];
+      if(index == CAN_WATCH_NONE){
+         break;
+      }
+      if(index != CAN_WATCH_DELETED && WatchPool[index].bus == bus && WatchPool[index].canId == canId){
+         if(WatchPool[index].inWheel){
+            UnlinkWatch(index);
+         }
+         WatchPool[index].used = false;
+         WatchHash[pos] = CAN_WATCH_DELETED;
+         found = true;
+         break;
+      }
+      pos = (pos + 1) & (CAN_WATCH_HASH_SIZE - 1);
+   }
+   /*退出临界区*/
+   __enable_irq();
+
+   return found ? MW_Status::SUCCESS : MW_Status::INVALID_OPERATION;
+}
+
+/**
+ * @brief 查询指定 CAN ID 当前是否在线
+ * @param bus 设备所在的总线
+ * @param canId 要查询的 CAN ID
+ * @return result 为在线状态,
+ *         status 为 INVALID_PARAM 表示参数无效,
+ *         INVALID_OPERATION 表示该 CAN ID 没有被监视,
+ *         SUCCESS 表示查询成功
+ */
+MW_FuncStatus<bool> CanManager::IsOnline(USE_CanBus bus, uint32_t canId){
+   if(bus >=USE_CanBus::USE_CAN_END || canId > CAN_STANDARD_ID_MAX){
+      return {false, MW_Status::INVALID_PARAM};
+   }
+
+   __disable_irq();
+   uint8_t index = FindWatch(bus, canId);
+   bool online = (index != CAN_WATCH_NONE) && WatchPool[index].online;
+   __enable_irq();
+
+   if(index == CAN_WATCH_NONE){
+      return {false, MW_Status::INVALID_OPERATION};
+   }
+   return {online, MW_Status::SUCCESS};
+}
+
+/**
+ * @brief 注册一个周期发送帧源
+ * @param bus 要使用的总线
+ * @param periodMs 发送周期(毫秒)
+ * @param phaseSlot 周期内的发送相位(时隙),CAN_CYCLIC_AUTO_PHASE 表示自动选择
+ * @param source 发送时刻调用的帧源回调
+ * @details 1. 相位以时隙为单位,使不同帧源落在毫秒内不同的时隙上
+ *          2. 首次发送时刻为下一个满足 slot % period == phase 的时隙
+ *          3. 自动相位在临界区内只复制同一总线的帧源快照,在临界区外计算,
+ *             插入时帧源表已被修改则重新计算,最多 CAN_CYCLIC_PHASE_RETRIES 次
+ * @return result 为帧源句柄,
+ *         status 为 INVALID_PARAM 表示参数无效,
+ *         RESOURCE_BUSY 表示帧源表已满,
+ *         SUCCESS 表示注册成功
+ */
+MW_FuncStatus<uint8_t> CanManager::AddCyclicTx(USE_CanBus bus, uint16_t periodMs, uint16_t phaseSlot, CanCyclicSource_t source){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   if(NeedUSECAN[bus] == false){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   if(periodMs == 0 || source == nullptr){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   uint32_t periodSlots = static_cast<uint32_t>(periodMs) * CAN_TX_SLOTS_PER_MS;
+   bool autoPhase = (phaseSlot == CAN_CYCLIC_AUTO_PHASE);
+   if(!autoPhase && phaseSlot >= periodSlots){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+
+   MW_FuncStatus<uint8_t> res = {0, MW_Status::RESOURCE_BUSY};
+
+   for(uint8_t attempt = 0; autoPhase && attempt < CAN_CYCLIC_PHASE_RETRIES; attempt++){
+      /*临界区内只复制同一总线的帧源,相位在临界区外计算*/
+      CyclicPhaseRef refs[MAX_CAN_CYCLIC_TX];
+      uint8_t refCount = 0;
       __disable_irq();
-      res = CanMsgSendQueue[USE_CAN1].push(msg);
+      uint32_t version = CyclicVersion;
+      for(uint8_t i = 0; i < MAX_CAN_CYCLIC_TX; i++){
+         if(CyclicTable[i].used && CyclicTable[i].bus == bus){
+            refs[refCount].periodSlots = CyclicTable[i].periodSlots;
+            refs[refCount].phaseSlot = CyclicTable[i].phaseSlot;
+            refCount++;
+         }
+      }
       __enable_irq();
-      break;
-   case USE_CAN2:
-      /*进入临界区, 确保发送操作的原子性*/
+
+      phaseSlot = PickCyclicPhase(periodSlots, refs, refCount);
+
+      /*期间没有其他注册或注销时快照仍然有效*/
       __disable_irq();
-      res = CanMsgSendQueue[USE_CAN2].push(msg);
+      bool unchanged = (version == CyclicVersion);
       __enable_irq();
+      if(unchanged){
+         break;
+      }
+   }
+
+   /*进入临界区, 帧源表会在定时器中断中被访问*/
+   __disable_irq();
+   for(uint8_t i = 0; i < MAX_CAN_CYCLIC_TX; i++){
+      if(CyclicTable[i].used){
+         continue;
+      }
+      CyclicTx& c = CyclicTable[i];
+      uint32_t now = TxSlotNow;
+      /*对齐到下一个满足相位的时隙*/
+      uint32_t offset = (phaseSlot + periodSlots - (now % periodSlots)) % periodSlots;
+      c.source = source;
+      c.periodSlots = periodSlots;
+      c.phaseSlot = phaseSlot;
+      c.nextSlot = now + (offset == 0 ? periodSlots : offset);
+      c.dropped = 0;
+      c.bus = bus;
+      c.used = true;
+      CyclicVersion++;
+      res = {i, MW_Status::SUCCESS};
       break;
-   default:
-      res = MW_Status::INVALID_PARAM;
-      break;
-   }  
+   }
+   /*退出临界区*/
+   __enable_irq();
+
+   return res;
+}
+
+/**
+ * @brief 注销一个周期发送帧源
+ * @param handle AddCyclicTx 返回的帧源句柄
+ * @return 注销操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示句柄无效,
+ *         SUCCESS 表示注销成功
+ */
+MW_Status CanManager::RemoveCyclicTx(uint8_t handle){
+   if(handle >= MAX_CAN_CYCLIC_TX){
+      return MW_Status::INVALID_PARAM;
+   }
+   MW_Status res = MW_Status::INVALID_PARAM;
+   __disable_irq();
+   if(CyclicTable[handle].used){
+      CyclicTable[handle].used = false;
+      CyclicVersion++;
+      res = MW_Status::SUCCESS;
+   }
+   __enable_irq();
    return res;
 }
 
+/**
+ * @brief 查询指定CAN总线是否已经被上层中间件申请
+ * @param bus 要查询的总线
+ * @return result 为是否已被申请,
+ *         status 为 INVALID_PARAM 表示参数无效, SUCCESS 表示查询成功
+ */
+MW_FuncStatus<bool> CanManager::IsResourceAsked(USE_CanBus bus){
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return {false, MW_Status::INVALID_PARAM};
+   }
+   return {NeedUSECAN[bus], MW_Status::SUCCESS};
+}
+
+/**
+ * @brief 由订阅表和在线监视表规划指定总线的硬件滤波器
+ * @param bus 要规划的总线
+ * @param plan 用于接收规划结果的引用
+ * @details 1. 在临界区内只复制ID,去重在临界区外完成
+ *          2. 没有任何ID时规划为全部接收,保持与启动时一致
+ *          3. 去重后的ID超过 CAN_FILTER_MAX_IDS 时规划为全部接收
+ * @return 规划操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         SUCCESS 表示规划成功
+ */
+MW_Status CanManager::PlanRxFilter(USE_CanBus bus, CanFilterPlan& plan){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return MW_Status::INVALID_PARAM;
+   }
+   memset(&plan, 0, sizeof(plan));
+
+   Subscription* CallbackArray = (bus == USE_CAN1) ? Can1CallbackArray : Can2CallbackArray;
+   uint8_t& CallbackArrayIndex = (bus == USE_CAN1) ? Can1CallbackArrayIndex : Can2CallbackArrayIndex;
+   uint16_t raw[MAX_CAN_SUBSCRIPTIONS + MAX_CAN_WATCHES];
+   uint8_t rawCount = 0;
+
+   /*进入临界区, 复制订阅表和监视表中的ID以及版本号*/
+   __disable_irq();
+   for(uint8_t i = 0; i < CallbackArrayIndex; i++){
+      raw[rawCount++] = static_cast<uint16_t>(CallbackArray[i].canId);
+   }
+   for(uint8_t i = 0; i < MAX_CAN_WATCHES; i++){
+      if(WatchPool[i].used && WatchPool[i].bus == bus){
+         raw[rawCount++] = static_cast<uint16_t>(WatchPool[i].canId);
+      }
+   }
+   plan.epoch = RxIdEpoch[bus];
+   /*退出临界区*/
+   __enable_irq();
+
+   /*去重*/
+   for(uint8_t i = 0; i < rawCount && !plan.acceptAll; i++){
+      bool seen = false;
+      for(uint8_t j = 0; j < plan.idCount; j++){
+         if(plan.ids[j] == raw[i]){
+            seen = true;
+            break;
+         }
+      }
+      if(seen){
+         continue;
+      }
+      if(plan.idCount >= CAN_FILTER_MAX_IDS){
+         plan.acceptAll = true;
+         break;
+      }
+      plan.ids[plan.idCount++] = raw[i];
+   }
+
+   if(plan.idCount == 0){
+      plan.acceptAll = true;
+   }
+   if(plan.acceptAll){
+      plan.idCount = 0;
+      plan.bankCount = 1;
+   }else{
+      plan.bankCount = (plan.idCount + CAN_FILTER_IDS_PER_BANK - 1) / CAN_FILTER_IDS_PER_BANK;
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 把滤波器规划写入指定总线的硬件滤波器组
+ * @param bus 要应用的总线
+ * @param plan PlanRxFilter 得到的规划
+ * @details 1. 从该总线的第一个滤波器组开始,每组写入 CAN_FILTER_IDS_PER_BANK 个ID
+ *          2. 关闭上一次规划多占用的滤波器组
+ *          3. 写入期间订阅表发生了变化,或写入失败时,退回全部接收
+ * @return 应用操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         UNINITIALIZED 表示总线还没有启动,
+ *         INVALID_OPERATION 表示规划已经过期或写入失败,已退回全部接收,
+ *         SUCCESS 表示应用成功
+ */
+MW_Status CanManager::ApplyRxFilter(USE_CanBus bus, const CanFilterPlan& plan){
+   /*校验参数*/
+   if(bus >=USE_CanBus::USE_CAN_END ){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(plan.idCount > CAN_FILTER_MAX_IDS){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(!plan.acceptAll && (plan.idCount == 0 ||
+      plan.bankCount != (plan.idCount + CAN_FILTER_IDS_PER_BANK - 1) / CAN_FILTER_IDS_PER_BANK)){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(CanIsInit[bus] == false){
+      return MW_Status::UNINITIALIZED;
+   }
+
+   Can* can = CanResource[bus];
+   BspResult<uint32_t> base = can->GetFilterBankBase();
+   if(!base.ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+
+   /*先按新规划写入滤波器组*/
+   bool ok = true;
+   if(plan.acceptAll){
+      ok = can->ConfigFilterAcceptAll().ok();
+   }else{
+      for(uint8_t b = 0; b < plan.bankCount && ok; b++){
+         uint8_t first = b * CAN_FILTER_IDS_PER_BANK;
+         uint8_t count = plan.idCount - first;
+         if(count > CAN_FILTER_IDS_PER_BANK){
+            count = CAN_FILTER_IDS_PER_BANK;
+         }
+         ok = can->ConfigFilterStdIdList(&plan.ids[first], count, Can::FIFO_0, base.value + b).ok();
+      }
+   }
+   /*关闭上一次规划多占用的滤波器组*/
+   for(uint8_t b = plan.bankCount; b < AppliedFilter[bus].bankCount && ok; b++){
+      ok = can->DisableFilterBank(base.value + b).ok();
+   }
+
+   /*进入临界区, 确认规划之后没有新增ID再生效*/
+   __disable_irq();
+   bool fresh = ok && (plan.epoch == RxIdEpoch[bus]);
+   if(fresh){
+      AppliedFilter[bus] = plan;
+   }
+   /*退出临界区*/
+   __enable_irq();
+
+   if(!fresh){
+      RevertRxFilter(bus);
+      return MW_Status::INVALID_OPERATION;
+   }
+   return MW_Status::SUCCESS;
+}
+
 /*==================== 私有函数实现 ====================*/
 
+/**
+ * @brief 登记一个新接收的ID,必须在临界区内调用
+ * @param bus 新ID所在的总线
+ * @param canId 新订阅或监视的ID
+ * @details 递增订阅表版本号,并检查当前生效的列表滤波器是否包含该ID;
+ *          不包含时先把规划标记为全部接收,硬件由调用者在临界区外退回
+ * @return true 表示需要退回全部接收
+ */
+bool CanManager::NoteRxId(USE_CanBus bus, uint32_t canId){
+   RxIdEpoch[bus]++;
+   CanFilterPlan& applied = AppliedFilter[bus];
+   if(applied.acceptAll){
+      return false;
+   }
+   for(uint8_t i = 0; i < applied.idCount; i++){
+      if(applied.ids[i] == canId){
+         return false;
+      }
+   }
+   applied.acceptAll = true;
+   return true;
+}
+
+/**
+ * @brief 把指定总线的滤波器退回全部接收
+ * @details 只改写该总线的第一个滤波器组,其余列表组接收的ID是全部接收的子集,保留不动
+ */
+void CanManager::RevertRxFilter(USE_CanBus bus){
+   __disable_irq();
+   AppliedFilter[bus].acceptAll = true;
+   __enable_irq();
+   if(CanIsInit[bus]){
+      CanResource[bus]->ConfigFilterAcceptAll();
+   }
+}
+
 
 
 /**
@@ -334,29 +880,7 @@ MW_Status CanManager::sendMessage(USE_CanBus bus, const CanMessage& msg){
  * @param len 收到的CAN数据长度
  */
 void CanManager::CAN1_RxCallback(uint32_t canId,  uint8_t* data, uint8_t len){
-   /*获取单例*/
-   CanManager& CanManagerInstance = CanManager::GetInstance(); 
-   
-   /*最多可能有 CAN_RXCALLBACK_ARRAYSIZE 个订阅者*/
-    CanRxCallback_t callbacks_to_run[MAX_CAN_SUBSCRIPTIONS];
-    uint8_t callbacks_count = 0;
-
-    /*进入临界区, 快速查找并复制所有匹配的回调函数指针*/
-    __disable_irq();
-    for(uint8_t i = 0; i < CanManagerInstance.Can1CallbackArrayIndex; i++){
-        if(canId == CanManagerInstance.Can1CallbackArray[i].canId){
-                callbacks_to_run[callbacks_count++] = CanManagerInstance.Can1CallbackArray[i].callback;
-        }
-    }
-    /*立即退出临界区, 恢复中断响应*/
-    __enable_irq();
-
-    /*在临界区外执行所有找到的回调*/
-    for (uint8_t i = 0; i < callbacks_count; ++i) {
-        if (callbacks_to_run[i] != nullptr) {
-            callbacks_to_run[i](canId, data, len);
-        }
-    }
+   DispatchRxMessage(USE_CAN1, canId, data, len);
 }
 
 
@@ -367,46 +891,588 @@ void CanManager::CAN1_RxCallback(uint32_t canId,  uint8_t* data, uint8_t len){
  * @param len 收到的CAN数据长度
  */
 void CanManager::CAN2_RxCallback(uint32_t canId,  uint8_t* data, uint8_t len){
-    /*获取单例*/
-    CanManager& CanManagerInstance = CanManager::GetInstance();
-
-    /*最多可能有 CAN_RXCALLBACK_ARRAYSIZE 个订阅者*/
-    CanRxCallback_t callbacks_to_run[MAX_CAN_SUBSCRIPTIONS];
-    uint8_t callbacks_count = 0;
-
-    /*进入临界区, 快速查找并复制所有匹配的回调函数指针*/
-    __disable_irq();
-    /*遍历CAN2CallbackArray查找匹配的回调函数*/
-    for(uint8_t i = 0; i < CanManagerInstance.Can2CallbackArrayIndex; i++){
-        if(canId == CanManagerInstance.Can2CallbackArray[i].canId){
-                callbacks_to_run[callbacks_count++] = CanManagerInstance.Can2CallbackArray[i].callback;
-        }
-    }
-    /*立即退出临界区, 恢复中断响应*/
-    __enable_irq();
-
-    /*在临界区外执行所有找到的回调*/
-    for (uint8_t i = 0; i < callbacks_count; ++i) {
-        if (callbacks_to_run[i] != nullptr) {
-            callbacks_to_run[i](canId, data, len);
-        }
-    }
-}
-
-/**
- * @brief TIM定时器中的回调函数，负责处理CAN消息队列中的待发送消息,发送周期1ms
+   DispatchRxMessage(USE_CAN2, canId, data, len);
+}
+
+/**
+ * @brief 注册在BSP层的CAN1发送邮箱结束回调
+ * @param mailbox 结束发送的邮箱序号
+ * @param result 发送结果
+ */
+void CanManager::CAN1_TxDoneCallback(uint32_t mailbox, CanTxResult result){
+   CompleteTxToken(USE_CAN1, mailbox, result);
+}
+
+/**
+ * @brief 注册在BSP层的CAN2发送邮箱结束回调
+ * @param mailbox 结束发送的邮箱序号
+ * @param result 发送结果
+ */
+void CanManager::CAN2_TxDoneCallback(uint32_t mailbox, CanTxResult result){
+   CompleteTxToken(USE_CAN2, mailbox, result);
+}
+
+/**
+ * @brief 两路CAN共用的发送结束处理
+ * @param bus 发送结束的总线
+ * @param mailbox 结束发送的邮箱序号
+ * @param result 发送结果
+ * @details 取出该邮箱上登记的令牌,写入结束时刻和结果后解除登记
+ */
+void CanManager::CompleteTxToken(USE_CanBus bus, uint32_t mailbox, CanTxResult result){
+   if(mailbox >= CAN_TXMAILBOX_NUM){
+      return;
+   }
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   uint32_t now = DWT->CYCCNT;
+
+   __disable_irq();
+   CanTxToken* token = CanManagerInstance.MailboxToken[bus][mailbox];
+   CanManagerInstance.MailboxToken[bus][mailbox] = nullptr;
+   __enable_irq();
+
+   if(token == nullptr){
+      return;
+   }
+   token->completeCycles = now;
+   switch(result){
+   case CAN_TX_RESULT_OK:
+      token->failure = CAN_TX_FAIL_NONE;
+      break;
+   case CAN_TX_RESULT_ABORTED:
+      token->failure = CAN_TX_FAIL_ABORTED;
+      break;
+   case CAN_TX_RESULT_ARB_LOST:
+      token->failure = CAN_TX_FAIL_ARB_LOST;
+      break;
+   default:
+      token->failure = CAN_TX_FAIL_BUS_ERROR;
+      break;
+   }
+   token->state = (result == CAN_TX_RESULT_OK) ? CAN_TX_TOKEN_DONE : CAN_TX_TOKEN_FAILED;
+}
+
+/**
+ * @brief 两路CAN共用的接收分发函数,在接收中断中调用
+ * @param bus 收到消息的总线
+ * @param canId 收到的CAN ID
+ * @param data 收到的CAN数据指针
+ * @param len 收到的CAN数据长度
+ * @details 1. 在临界区内复制所有中断方式订阅者的回调,并记录哪些延迟队列有订阅者
+ *          2. 在临界区外执行中断方式的回调,每个回调执行前检查 CAN_RX_ISR_BUDGET_CYCLES 预算
+ *          3. 每个有订阅者的延迟队列只推入一次帧,队列满时丢弃并计数。
+ *             预算用完时帧带着已执行的回调个数推入高优先级队列,剩余回调由工作任务执行;
+ *             工作任务未创建或队列已满时仍在中断中执行完并计数
+ *          4. 用DWT记录本次分发耗时的最大值
+ */
+void CanManager::DispatchRxMessage(USE_CanBus bus, uint32_t canId, uint8_t* data, uint8_t len){
+   uint32_t startCycles = DWT->CYCCNT;
+   /*获取单例*/
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   CanRxStats& stats = CanManagerInstance.RxStats[bus];
+
+   /*根据收到消息的BUS选择操作资源*/
+   const Subscription* CallbackArray = (bus == USE_CAN1) ? CanManagerInstance.Can1CallbackArray : CanManagerInstance.Can2CallbackArray;
+   const uint8_t& CallbackArrayIndex = (bus == USE_CAN1) ? CanManagerInstance.Can1CallbackArrayIndex : CanManagerInstance.Can2CallbackArrayIndex;
+
+   /*最多可能有 MAX_CAN_SUBSCRIPTIONS 个订阅者*/
+   CanRxCallback_t callbacks_to_run[MAX_CAN_SUBSCRIPTIONS];
+   uint8_t callbacks_count = 0;
+   /*记录需要推入的延迟队列*/
+   bool need_defer[CAN_DEFER_QUEUE_NUM] = {false};
+
+   /*进入临界区, 快速查找并复制所有匹配的回调函数指针*/
+   __disable_irq();
+   stats.isrFrames++;
+   for(uint8_t i = 0; i < CallbackArrayIndex; i++){
+      if(canId == CallbackArray[i].canId){
+         if(CallbackArray[i].delivery == CAN_DELIVERY_ISR){
+            callbacks_to_run[callbacks_count++] = CallbackArray[i].callback;
+         }else{
+            need_defer[CallbackArray[i].delivery - CAN_DELIVERY_TASK_HIGH] = true;
+         }
+      }
+   }
+   /*立即退出临界区, 恢复中断响应*/
+   __enable_irq();
+
+   /*刷新该 CAN ID 的在线监视*/
+   FeedWatch(bus, canId);
+
+   /*在临界区外执行找到的回调,预算用完后停止*/
+   uint8_t ran = 0;
+   for (; ran < callbacks_count; ++ran) {
+      if (DWT->CYCCNT - startCycles > CAN_RX_ISR_BUDGET_CYCLES) {
+         break;
+      }
+      if (callbacks_to_run[ran] != nullptr) {
+         callbacks_to_run[ran](canId, data, len);
+      }
+   }
+   bool overBudget = (ran < callbacks_count);
+
+   /*将帧推入延迟队列,由CAN工作任务投递,剩余的中断方式回调随高优先级队列的帧一起转入*/
+   BaseType_t higherPriorityTaskWoken = pdFALSE;
+   bool queued = false;
+   for(uint8_t q = 0; q < CAN_DEFER_QUEUE_NUM; q++){
+      bool carryIsr = (q == 0 && overBudget);
+      if((!need_defer[q] && !carryIsr) || CanManagerInstance.DeferQueue[q] == nullptr){
+         continue;
+      }
+      DeferredFrame frame;
+      frame.canId = canId;
+      frame.len = (len > 8) ? 8 : len;
+      frame.bus = bus;
+      frame.isrSkip = carryIsr ? ran : CAN_ISR_SKIP_NONE;
+      memcpy(frame.data, data, frame.len);
+
+      if(xQueueSendFromISR(CanManagerInstance.DeferQueue[q], &frame, &higherPriorityTaskWoken) == pdPASS){
+         stats.deferredQueued[q]++;
+         UBaseType_t waiting = uxQueueMessagesWaitingFromISR(CanManagerInstance.DeferQueue[q]);
+         if(waiting > stats.queueHighWater[q]){
+            stats.queueHighWater[q] = waiting;
+         }
+         if(carryIsr){
+            stats.isrBudgetDeferred++;
+            overBudget = false;
+         }
+         queued = true;
+      }else if(need_defer[q]){
+         stats.deferredDropped[q]++;
+      }
+   }
+   if(queued){
+      vTaskNotifyGiveFromISR(CanManagerInstance.RxTaskHandle, &higherPriorityTaskWoken);
+   }
+
+   /*无法转入工作任务时不丢弃回调,在中断中执行完*/
+   if(overBudget){
+      stats.isrOverBudget++;
+      for (; ran < callbacks_count; ++ran) {
+         if (callbacks_to_run[ran] != nullptr) {
+            callbacks_to_run[ran](canId, data, len);
+         }
+      }
+   }
+
+   /*统计中断分发耗时*/
+   uint32_t elapsed = DWT->CYCCNT - startCycles;
+   if(elapsed > stats.maxIsrCycles){
+      stats.maxIsrCycles = elapsed;
+   }
+
+   portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/**
+ * @brief 创建CAN工作任务及其延迟投递队列
+ * @details 1. 用 RxTaskCreating 标记保证只创建一次,创建期间其他调用者返回资源忙
+ *          2. 队列和任务使用静态存储,创建不会因为堆内存不足而失败
+ *          3. 任务句柄和队列句柄在同一个临界区内发布,最后才置位 RxTaskIsInit,
+ *             中断看到队列时任务句柄一定已经就绪
+ * @return 创建操作的状态
+ *         返回值:
+ *         RESOURCE_BUSY 表示工作任务正在被其他线程创建,
+ *         SUCCESS 表示工作任务已经在运行
+ */
+MW_Status CanManager::StartRxTask(){
+   static StaticQueue_t queueBuffer[CAN_DEFER_QUEUE_NUM];
+   static uint8_t queueStorage[CAN_DEFER_QUEUE_NUM][CAN_RX_DEFER_QUEUE_SIZE * sizeof(DeferredFrame)];
+   static StaticTask_t taskBuffer;
+   static StackType_t taskStack[CAN_RX_TASK_STACK_SIZE];
+
+   /* 检查并更新工作任务的创建状态，此部分需要原子操作 */
+   __disable_irq();
+   if(RxTaskIsInit){
+      __enable_irq();
+      return MW_Status::SUCCESS;
+   }
+   if(RxTaskCreating){
+      __enable_irq();
+      return MW_Status::RESOURCE_BUSY;
+   }
+   RxTaskCreating = true;
+   __enable_irq();
+
+   QueueHandle_t queues[CAN_DEFER_QUEUE_NUM];
+   for(uint8_t q = 0; q < CAN_DEFER_QUEUE_NUM; q++){
+      queues[q] = xQueueCreateStatic(CAN_RX_DEFER_QUEUE_SIZE, sizeof(DeferredFrame), queueStorage[q], &queueBuffer[q]);
+   }
+   /*任务启动后先阻塞等待通知,通知只会在队列发布之后到来*/
+   TaskHandle_t handle = xTaskCreateStatic(RxTask, "CanRxTask", CAN_RX_TASK_STACK_SIZE, nullptr, CAN_RX_TASK_PRIORITY,
+                                           taskStack, &taskBuffer);
+
+   __disable_irq();
+   RxTaskHandle = handle;
+   for(uint8_t q = 0; q < CAN_DEFER_QUEUE_NUM; q++){
+      DeferQueue[q] = queues[q];
+   }
+   RxTaskIsInit = true;
+   RxTaskCreating = false;
+   __enable_irq();
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief CAN 工作任务
+ * @param arg 未使用
+ * @details 1. 阻塞等待中断发来的任务通知
+ *          2. 每处理一帧都先检查高优先级队列,高优先级队列为空才处理低优先级队列
+ *          3. 两个队列都为空后重新进入阻塞
+ */
+void CanManager::RxTask(void* arg){
+   (void)arg;
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   DeferredFrame frame;
+
+   for(;;){
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      for(;;){
+         if(xQueueReceive(CanManagerInstance.DeferQueue[0], &frame, 0) == pdPASS){
+            DispatchDeferredFrame(frame, CAN_DELIVERY_TASK_HIGH);
+            continue;
+         }
+         if(xQueueReceive(CanManagerInstance.DeferQueue[1], &frame, 0) == pdPASS){
+            DispatchDeferredFrame(frame, CAN_DELIVERY_TASK_LOW);
+            continue;
+         }
+         break;
+      }
+   }
+}
+
+/**
+ * @brief 在任务上下文中调用指定投递方式的订阅者
+ * @param frame 从延迟队列中取出的帧
+ * @param delivery 该帧所在队列对应的投递方式
+ * @details 1. 与中断分发相同,先在临界区内复制回调,再在临界区外执行
+ *          2. 帧带有剩余的中断方式回调时,按订阅数组顺序跳过中断中已执行的个数后先执行它们。
+ *             两次之间订阅发生变化时,按变化后的数组重新匹配
+ */
+void CanManager::DispatchDeferredFrame(DeferredFrame& frame, CanRxDelivery delivery){
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+
+   const Subscription* CallbackArray = (frame.bus == USE_CAN1) ? CanManagerInstance.Can1CallbackArray : CanManagerInstance.Can2CallbackArray;
+   const uint8_t& CallbackArrayIndex = (frame.bus == USE_CAN1) ? CanManagerInstance.Can1CallbackArrayIndex : CanManagerInstance.Can2CallbackArrayIndex;
+
+   CanRxCallback_t callbacks_to_run[MAX_CAN_SUBSCRIPTIONS];
+   uint8_t callbacks_count = 0;
+
+   /*进入临界区, 快速查找并复制所有匹配的回调函数指针*/
+   __disable_irq();
+   if(frame.isrSkip != CAN_ISR_SKIP_NONE){
+      uint8_t skip = frame.isrSkip;
+      for(uint8_t i = 0; i < CallbackArrayIndex; i++){
+         if(frame.canId == CallbackArray[i].canId && CallbackArray[i].delivery == CAN_DELIVERY_ISR){
+            if(skip > 0){
+               skip--;
+            }else{
+               callbacks_to_run[callbacks_count++] = CallbackArray[i].callback;
+            }
+         }
+      }
+   }
+   for(uint8_t i = 0; i < CallbackArrayIndex; i++){
+      if(frame.canId == CallbackArray[i].canId && CallbackArray[i].delivery == delivery){
+         callbacks_to_run[callbacks_count++] = CallbackArray[i].callback;
+      }
+   }
+   __enable_irq();
+
+   for (uint8_t i = 0; i < callbacks_count; ++i) {
+      if (callbacks_to_run[i] != nullptr) {
+         callbacks_to_run[i](frame.canId, frame.data, frame.len);
+      }
+   }
+}
+
+/**
+ * @brief 计算 (总线, CAN ID) 在哈希表中的起始探测位置
+ * @details 使用乘法哈希,取高位作为下标
+ */
+uint8_t CanManager::WatchHashOf(USE_CanBus bus, uint32_t canId){
+   uint32_t key = (static_cast<uint32_t>(bus) << 11) | canId;
+   return static_cast<uint8_t>((key * 2654435761U) >> 24) & (CAN_WATCH_HASH_SIZE - 1);
+}
+
+/**
+ * @brief 在哈希表中查找 (总线, CAN ID) 对应的监视项
+ * @return 监视项下标,找不到时返回 CAN_WATCH_NONE
+ * @note 必须在临界区内调用
+ */
+uint8_t CanManager::FindWatch(USE_CanBus bus, uint32_t canId) const{
+   uint8_t pos = WatchHashOf(bus, canId);
+   for(uint8_t probe = 0; probe < CAN_WATCH_HASH_SIZE; probe++){
+      uint8_t index = WatchHash[pos];
+      if(index == CAN_WATCH_NONE){
+         return CAN_WATCH_NONE;
+      }
+      if(index != CAN_WATCH_DELETED && WatchPool[index].bus == bus && WatchPool[index].canId == canId){
+         return index;
+      }
+      pos = (pos + 1) & (CAN_WATCH_HASH_SIZE - 1);
+   }
+   return CAN_WATCH_NONE;
+}
+
+/**
+ * @brief 把监视项挂到 deadlineMs 所在的时间轮槽的链表头
+ * @note 必须在临界区内调用
+ */
+void CanManager::LinkWatch(uint8_t index, uint32_t deadlineMs){
+   OnlineWatch& w = WatchPool[index];
+   uint8_t slot = deadlineMs & (CAN_WATCH_WHEEL_SIZE - 1);
+   w.deadlineMs = deadlineMs;
+   w.prev = CAN_WATCH_NONE;
+   w.next = WatchWheel[slot];
+   if(w.next != CAN_WATCH_NONE){
+      WatchPool[w.next].prev = index;
+   }
+   WatchWheel[slot] = index;
+   w.inWheel = true;
+}
+
+/**
+ * @brief 把监视项从所在的时间轮槽上摘下
+ * @note 必须在临界区内调用
+ */
+void CanManager::UnlinkWatch(uint8_t index){
+   OnlineWatch& w = WatchPool[index];
+   if(w.prev != CAN_WATCH_NONE){
+      WatchPool[w.prev].next = w.next;
+   }else{
+      WatchWheel[w.deadlineMs & (CAN_WATCH_WHEEL_SIZE - 1)] = w.next;
+   }
+   if(w.next != CAN_WATCH_NONE){
+      WatchPool[w.next].prev = w.prev;
+   }
+   w.prev = CAN_WATCH_NONE;
+   w.next = CAN_WATCH_NONE;
+   w.inWheel = false;
+}
+
+/**
+ * @brief 在接收中断中刷新 CAN ID 的最近接收时间
+ * @details 1. 在线设备只更新 lastRxMs,不移动链表,到期时由时间轮按 lastRxMs 重新挂载
+ *          2. 离线设备重新挂到时间轮上,并在临界区外触发上线通知
+ */
+void CanManager::FeedWatch(USE_CanBus bus, uint32_t canId){
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   CanOnlineCallback_t callback = nullptr;
+   bool cameOnline = false;
+
+   __disable_irq();
+   uint8_t index = CanManagerInstance.FindWatch(bus, canId);
+   if(index != CAN_WATCH_NONE){
+      OnlineWatch& w = CanManagerInstance.WatchPool[index];
+      uint32_t now = CanManagerInstance.WatchNowMs;
+      w.lastRxMs = now;
+      if(!w.online){
+         w.online = true;
+         if(!w.inWheel){
+            CanManagerInstance.LinkWatch(index, now + w.timeoutMs);
+         }
+         cameOnline = true;
+         callback = w.callback;
+      }
+   }
+   __enable_irq();
+
+   if(cameOnline && callback != nullptr){
+      callback(bus, canId, true);
+   }
+}
+
+/**
+ * @brief 处理当前毫秒对应的时间轮槽
+ * @details 1. 取下整个槽的链表,逐个检查到期时间
+ *          2. 到期时间还没到(超时大于时间轮一圈)的监视项原样挂回
+ *          3. 期间收到过消息的监视项按 lastRxMs + timeoutMs 重新挂载
+ *          4. 真正超时的监视项标记为离线,在临界区外触发离线通知
+ */
+void CanManager::ProcessWatchWheel(){
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+
+   /*记录本次需要通知离线的设备*/
+   struct OfflineEvent{
+      CanOnlineCallback_t callback;
+      uint32_t canId;
+      USE_CanBus bus;
+   };
+   OfflineEvent events[MAX_CAN_WATCHES];
+   uint8_t eventCount = 0;
+
+   __disable_irq();
+   uint32_t now = ++CanManagerInstance.WatchNowMs;
+   uint8_t slot = now & (CAN_WATCH_WHEEL_SIZE - 1);
+   uint8_t index = CanManagerInstance.WatchWheel[slot];
+   CanManagerInstance.WatchWheel[slot] = CAN_WATCH_NONE;
+
+   while(index != CAN_WATCH_NONE){
+      OnlineWatch& w = CanManagerInstance.WatchPool[index];
+      uint8_t next = w.next;
+      w.inWheel = false;
+      w.prev = CAN_WATCH_NONE;
+      w.next = CAN_WATCH_NONE;
+
+      if(static_cast<int32_t>(w.deadlineMs - now) > 0){
+         /*还要再转几圈才到期*/
+         CanManagerInstance.LinkWatch(index, w.deadlineMs);
+      }else{
+         uint32_t due = w.lastRxMs + w.timeoutMs;
+         if(static_cast<int32_t>(due - now) > 0){
+            /*期间收到过消息,按最新的接收时间重新计时*/
+            CanManagerInstance.LinkWatch(index, due);
+         }else{
+            /*超时,判定为离线,等待下一帧消息再挂回时间轮*/
+            w.online = false;
+            events[eventCount].callback = w.callback;
+            events[eventCount].canId = w.canId;
+            events[eventCount].bus = w.bus;
+            eventCount++;
+         }
+      }
+      index = next;
+   }
+   __enable_irq();
+
+   for(uint8_t i = 0; i < eventCount; i++){
+      if(events[i].callback != nullptr){
+         events[i].callback(events[i].bus, events[i].canId, false);
+      }
+   }
+}
+
+/**
+ * @brief 按帧源表快照为新帧源选择冲突最少的相位
+ * @param periodSlots 新帧源以时隙为单位的周期
+ * @param refs 同一总线上已注册帧源的快照
+ * @param refCount 快照项数
+ * @details 周期为 P 和 Q 的两个帧源,相位差为 gcd(P,Q) 的整数倍时必然在同一时隙发送,
+ *          因此对每个候选相位统计 (phase - phase_i) % gcd(P, P_i) == 0 的帧源,
+ *          按各帧源的发送频率加权后取冲突最小者
+ * @note 在临界区外调用。最大公约数对每个帧源只求一次,候选相位不超过
+ *       CAN_CYCLIC_PHASE_CANDIDATES 个,找到零冲突相位时提前结束
+ */
+uint16_t CanManager::PickCyclicPhase(uint32_t periodSlots, const CyclicPhaseRef* refs, uint8_t refCount){
+   uint32_t gcds[MAX_CAN_CYCLIC_TX];
+   uint32_t offsets[MAX_CAN_CYCLIC_TX];
+   uint32_t weights[MAX_CAN_CYCLIC_TX];
+   for(uint8_t i = 0; i < refCount; i++){
+      /*辗转相除求最大公约数*/
+      uint32_t a = periodSlots, b = refs[i].periodSlots;
+      while(b != 0){
+         uint32_t t = a % b;
+         a = b;
+         b = t;
+      }
+      gcds[i] = a;
+      offsets[i] = refs[i].phaseSlot % a;
+      /*周期越短的帧源冲突代价越高, 权重取每秒发送次数*/
+      weights[i] = (1000U * CAN_TX_SLOTS_PER_MS) / refs[i].periodSlots + 1;
+   }
+
+   /*限制候选数,保证计算时间有界*/
+   uint32_t candidates = (periodSlots < CAN_CYCLIC_PHASE_CANDIDATES) ? periodSlots : CAN_CYCLIC_PHASE_CANDIDATES;
+   uint16_t best = 0;
+   uint32_t bestLoad = UINT32_MAX;
+   for(uint32_t phase = 0; phase < candidates; phase++){
+      uint32_t load = 0;
+      for(uint8_t i = 0; i < refCount; i++){
+         if(phase % gcds[i] == offsets[i]){
+            load += weights[i];
+         }
+      }
+      if(load < bestLoad){
+         bestLoad = load;
+         best = static_cast<uint16_t>(phase);
+         if(load == 0){
+            break;
+         }
+      }
+   }
+   return best;
+}
+
+/**
+ * @brief 把当前时隙到期的周期帧推入发送队列
+ * @param slot 当前时隙
+ * @details 1. 帧源表只有 MAX_CAN_CYCLIC_TX 项,逐项比较到期时隙
+ *          2. 帧源回调在临界区外调用,入队时才进入临界区
+ *          3. 队列已满时本周期的帧被丢弃并计数,不补发
+ */
+void CanManager::ProcessCyclicTx(uint32_t slot){
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+
+   for(uint8_t i = 0; i < MAX_CAN_CYCLIC_TX; i++){
+      CyclicTx& c = CanManagerInstance.CyclicTable[i];
+      if(!c.used || static_cast<int32_t>(slot - c.nextSlot) < 0){
+         continue;
+      }
+      c.nextSlot += c.periodSlots;
+      /*落后超过一个周期(例如中断被长时间屏蔽)时直接对齐到下一周期*/
+      if(static_cast<int32_t>(slot - c.nextSlot) >= 0){
+         c.nextSlot = slot + c.periodSlots;
+      }
+
+      CanCyclicSource_t source = c.source;
+      USE_CanBus bus = c.bus;
+      /*每个帧源都从全零的消息开始填充,不会带上一个帧源留下的字段*/
+      CanMessage msg{};
+      if(source == nullptr || !source(msg)){
+         continue;
+      }
+      if(msg.id > CAN_STANDARD_ID_MAX){
+         continue;
+      }
+      CanTxItem item;
+      item.msg = msg;
+      item.token = nullptr;
+      __disable_irq();
+      MW_Status res = CanManagerInstance.CanMsgSendQueue[bus].push(item);
+      __enable_irq();
+      if(res != MW_Status::SUCCESS){
+         c.dropped++;
+      }
+   }
+}
+
+/**
+ * @brief 在 TimManger 上订阅的定时器回调,每个发送时隙调用一次
+ * @details 1. 时隙计数每满 CAN_TX_SLOTS_PER_MS 推进一次在线监视时间轮
+ *          2. 把到期的周期帧推入发送队列
+ *          3. 处理CAN发送队列,每个时隙都会尝试把队列中的帧装入空闲邮箱
+ */
+void CanManager::OnTimerTick(void* arg){
+   (void)arg;
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   uint32_t slot = ++CanManagerInstance.TxSlotNow;
+   if(slot % CAN_TX_SLOTS_PER_MS == 0){
+      ProcessWatchWheel();
+   }
+   ProcessCyclicTx(slot);
+   processCanSendQueue();
+}
+
+/**
+ * @brief TIM定时器中的回调函数，负责处理CAN消息队列中的待发送消息,每个发送时隙调用一次
  * @details 1. 检查CAN消息队列中是否存在待发送的消息
  *          2. 如果存在，尝试从队列中取出消息并发送
- *          3. 如果CAN邮箱空闲，将消息发送到邮箱
+ *          3. 如果CAN邮箱空闲，将消息发送到邮箱,并把令牌登记到该邮箱上
  *          4. 如果CAN邮箱非空闲，就什么都不做
+ * @note 取出、装入邮箱和登记令牌在同一个临界区内完成,
+ *       避免发送结束中断先于令牌登记到达
  */
 void CanManager::processCanSendQueue(){
    /*获取单例*/
    CanManager& CanManagerInstance = CanManager::GetInstance();
    /*临时变量*/
-   CanMessage msg;
+   CanTxItem item;
+   uint32_t mailbox = 0;
    /*用于存储CAN邮箱空闲数量的变量*/
    BspResult<uint32_t> FreeMailboxes;
+   BspResult<bool> SendResult;
    /*遍历所有Can总线，如果队列存在消息且CAN邮箱空闲，就从队列中取出一条消息发送*/
    for(uint8_t i = 0;i<USE_CAN_END;++i){
 
@@ -416,22 +1482,31 @@ void CanManager::processCanSendQueue(){
             __disable_irq();        
             /*获取空闲邮箱数目*/
             FreeMailboxes = CanManagerInstance.CanResource[i]->GetFreeTxMailboxes();
-            /*如果存在空闲邮箱就从队列中取出一条消息发送*/
-            if(FreeMailboxes.value>0 && !CanManagerInstance.CanMsgSendQueue[i].is_empty()){
-               /*从队列中取出一条消息*/
-               CanManagerInstance.CanMsgSendQueue[i].pop(msg); 
-               /*退出临界区*/
-               __enable_irq();
-               /*尝试发送消息到CAN邮箱*/
-               CanManagerInstance.CanResource[i]->SendMessage(msg);
-            }else{
-               /*如果CAN邮箱非空闲或者队列为空直接退出*/
+            /*如果CAN邮箱非空闲或者队列为空直接退出*/
+            if(FreeMailboxes.value == 0 || CanManagerInstance.CanMsgSendQueue[i].is_empty()){
                /*退出临界区*/
                __enable_irq();
                break;
-            }   
+            }
+            /*从队列中取出一条消息并尝试发送到CAN邮箱*/
+            CanManagerInstance.CanMsgSendQueue[i].pop(item);
+            SendResult = CanManagerInstance.CanResource[i]->SendMessage(item.msg, &mailbox);
+            if(SendResult.ok() && mailbox < CAN_TXMAILBOX_NUM){
+               CanManagerInstance.MailboxToken[i][mailbox] = item.token;
+               if(item.token != nullptr){
+                  item.token->mailboxCycles = DWT->CYCCNT;
+                  item.token->state = CAN_TX_TOKEN_IN_MAILBOX;
+               }
+            }
+            /*退出临界区*/
+            __enable_irq();
+
+            if(!SendResult.ok() && item.token != nullptr){
+               item.token->failure = CAN_TX_FAIL_MAILBOX;
+               item.token->completeCycles = DWT->CYCCNT;
+               item.token->state = CAN_TX_TOKEN_FAILED;
+            }
          }
       }
    }
 };
-
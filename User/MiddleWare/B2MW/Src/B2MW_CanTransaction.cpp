@@ -0,0 +1,448 @@
+/*===========================================================
+* @file      B2MW_CanTransaction.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* B2MW_CanTransaction.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了CanTransaction类的成员函数
+* 2.实现了按窗口流水线发送请求、O(1)匹配应答、超时重发
+* ===========================================================
+* @version   1.1
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "B2MW_CanTransaction.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+/**
+ * @brief 哈希表中的空下标
+ */
+static constexpr uint8_t CAN_TXN_NONE = 0xFF;
+
+static_assert((CAN_TXN_MAX_WINDOW & (CAN_TXN_MAX_WINDOW - 1)) == 0, "CAN_TXN_MAX_WINDOW must be a power of two");
+static_assert((CAN_TXN_HASH_SIZE & (CAN_TXN_HASH_SIZE - 1)) == 0, "CAN_TXN_HASH_SIZE must be a power of two");
+static_assert(CAN_TXN_HASH_SIZE >= 2 * MAX_CAN_TXN_DEVICES, "CAN_TXN_HASH_SIZE is too small");
+
+/*================= CanTransaction的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数,初始化CanTransaction的成员变量
+ */
+CanTransaction::CanTransaction()
+{
+   for(uint8_t i = 0; i < MAX_CAN_TXN_DEVICES; i++){
+      Devices[i].used = false;
+      Devices[i].inFlight = 0;
+      memset(Devices[i].slots, 0, sizeof(Devices[i].slots));
+      memset(&Devices[i].stats, 0, sizeof(Devices[i].stats));
+   }
+   DeviceCount = 0;
+   memset(ReplyHash, CAN_TXN_NONE, sizeof(ReplyHash));
+   NowMs = 0;
+   TickIsInit = false;
+}
+
+/**
+ * @brief 获取CAN事务管理器的单例实例
+ * @return CanTransaction& 当前CAN事务管理器的引用
+ */
+CanTransaction& CanTransaction::GetInstance()
+{
+    static CanTransaction instance;
+    return instance;
+}
+
+/**
+ * @brief 注册一个应答设备
+ * @param config 设备配置
+ * @details 1. 第一次注册时向 TimManger 订阅毫秒定时器
+ *          2. 以中断方式订阅设备的应答ID
+ *          3. 把 (总线, 应答ID) 插入哈希表
+ * @return result 为设备句柄,
+ *         status 为 INVALID_PARAM 表示参数无效或总线未启动,
+ *         INVALID_OPERATION 表示该应答ID已被注册,
+ *         RESOURCE_BUSY 表示设备表或 CanManager 的资源已满,
+ *         SUCCESS 表示注册成功
+ * @note 只能在任务上下文中调用
+ */
+MW_FuncStatus<uint8_t> CanTransaction::AddDevice(const CanTxnDeviceConfig& config){
+   /*校验参数*/
+   if(config.bus >= USE_CanBus::USE_CAN_END){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   if(config.replyId > CAN_STANDARD_ID_MAX){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   if(config.timeoutMs == 0){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   uint8_t window = (config.replyKey == nullptr) ? 1 : config.window;
+   if(window == 0 || window > CAN_TXN_MAX_WINDOW || (window & (window - 1)) != 0){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   if(DeviceCount >= MAX_CAN_TXN_DEVICES){
+      return {0, MW_Status::RESOURCE_BUSY};
+   }
+   if(FindDevice(config.bus, config.replyId) != CAN_TXN_NONE){
+      return {0, MW_Status::INVALID_OPERATION};
+   }
+
+   CanManager& canManager = CanManager::GetInstance();
+
+   /*所有设备共用一个毫秒定时器,硬件定时器由 CanManager 启动总线时启动*/
+   if(TickIsInit == false){
+      MW_FuncStatus<TimHandle_t> res = TimManger::GetInstance().Subscribe(TIM_MS_TO_TICKS(1), OnTick, nullptr);
+      if(res.status != MW_Status::SUCCESS){
+         return {0, res.status};
+      }
+      TickIsInit = true;
+   }
+
+   /*订阅应答ID,总线未启动时 Subscribe 返回 INVALID_PARAM*/
+   CanRxCallback_t replyCallback = (config.bus == USE_CAN1) ? OnCan1Reply : OnCan2Reply;
+   MW_Status res = canManager.Subscribe(config.bus, config.replyId, replyCallback);
+   if(res != MW_Status::SUCCESS){
+      return {0, res};
+   }
+
+   uint8_t index = DeviceCount;
+   TxnDevice& dev = Devices[index];
+   dev.config = config;
+   dev.config.window = window;
+   memset(dev.slots, 0, sizeof(dev.slots));
+   memset(&dev.stats, 0, sizeof(dev.stats));
+   dev.inFlight = 0;
+   dev.used = true;
+
+   /*进入临界区, 哈希表和设备数量会在中断中被读取*/
+   __disable_irq();
+   uint8_t pos = ReplyHashOf(config.bus, config.replyId);
+   while(ReplyHash[pos] != CAN_TXN_NONE){
+      pos = (pos + 1) & (CAN_TXN_HASH_SIZE - 1);
+   }
+   ReplyHash[pos] = index;
+   DeviceCount = index + 1;
+   __enable_irq();
+
+   return {index, MW_Status::SUCCESS};
+}
+
+/**
+ * @brief 向设备发起一个请求
+ * @param device 设备句柄
+ * @param request 请求帧
+ * @param seqKey 序号键
+ * @param callback 事务结束回调
+ * @param ctx 透传给回调的上下文
+ * @details 1. 等待队列为空且 seqKey 对应的槽位空闲时直接占用槽位并发送
+ *          2. 否则推入等待队列,由应答或超时释放槽位后按顺序补入窗口
+ * @return 请求操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示参数无效,
+ *         RESOURCE_BUSY 表示等待队列已满,
+ *         SUCCESS 表示请求已进入窗口或等待队列
+ */
+MW_Status CanTransaction::Request(uint8_t device, const CanMessage& request, uint16_t seqKey, CanTxnReplyCallback_t callback, void* ctx){
+   /*校验参数*/
+   if(device >= DeviceCount){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(request.id > CAN_STANDARD_ID_MAX || request.len > 8){
+      return MW_Status::INVALID_PARAM;
+   }
+
+   TxnDevice& dev = Devices[device];
+   uint8_t slotIndex = seqKey & (dev.config.window - 1);
+   MW_Status res = MW_Status::SUCCESS;
+   bool sendNow = false;
+
+   /*进入临界区, 窗口和等待队列会在中断中被修改*/
+   __disable_irq();
+   TxnSlot& slot = dev.slots[slotIndex];
+   if(dev.pending.is_empty() && slot.busy == false){
+      slot.msg = request;
+      slot.callback = callback;
+      slot.ctx = ctx;
+      slot.seqKey = seqKey;
+      slot.retriesLeft = dev.config.maxRetries;
+      slot.busy = true;
+      slot.unsent = true;
+      dev.inFlight++;
+      sendNow = true;
+   }else{
+      PendingReq pending;
+      pending.msg = request;
+      pending.callback = callback;
+      pending.ctx = ctx;
+      pending.seqKey = seqKey;
+      res = dev.pending.push(pending);
+   }
+   /*退出临界区*/
+   __enable_irq();
+
+   if(sendNow){
+      SendSlot(device, slotIndex);
+   }
+   return res;
+}
+
+/**
+ * @brief 查询设备尚未结束的请求数量
+ * @param device 设备句柄
+ * @return result 为窗口中和等待队列中的请求数量之和,
+ *         status 为 INVALID_PARAM 表示句柄无效, SUCCESS 表示查询成功
+ */
+MW_FuncStatus<uint8_t> CanTransaction::GetOutstanding(uint8_t device){
+   if(device >= DeviceCount){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   __disable_irq();
+   uint8_t count = Devices[device].inFlight + static_cast<uint8_t>(Devices[device].pending.size());
+   __enable_irq();
+   return {count, MW_Status::SUCCESS};
+}
+
+/**
+ * @brief 获取设备的事务统计
+ * @param device 设备句柄
+ * @param stats 用于接收统计数据的引用
+ * @return 查询操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示句柄无效,
+ *         SUCCESS 表示查询成功
+ */
+MW_Status CanTransaction::GetStats(uint8_t device, CanTxnStats& stats){
+   if(device >= DeviceCount){
+      return MW_Status::INVALID_PARAM;
+   }
+   __disable_irq();
+   stats = Devices[device].stats;
+   __enable_irq();
+   return MW_Status::SUCCESS;
+}
+
+/*==================== 私有函数实现 ====================*/
+
+/**
+ * @brief 计算 (总线, 应答ID) 在哈希表中的起始探测位置
+ * @details 使用乘法哈希,取高位作为下标
+ */
+uint8_t CanTransaction::ReplyHashOf(USE_CanBus bus, uint32_t canId){
+   uint32_t key = (static_cast<uint32_t>(bus) << 11) | canId;
+   return static_cast<uint8_t>((key * 2654435761U) >> 24) & (CAN_TXN_HASH_SIZE - 1);
+}
+
+/**
+ * @brief 在哈希表中查找应答ID对应的设备下标
+ * @return 设备下标,找不到时返回 CAN_TXN_NONE
+ * @note 设备只能追加,哈希表没有删除位,中断中读取不需要临界区
+ */
+uint8_t CanTransaction::FindDevice(USE_CanBus bus, uint32_t canId) const{
+   uint8_t pos = ReplyHashOf(bus, canId);
+   for(uint8_t probe = 0; probe < CAN_TXN_HASH_SIZE; probe++){
+      uint8_t index = ReplyHash[pos];
+      if(index == CAN_TXN_NONE){
+         return CAN_TXN_NONE;
+      }
+      if(Devices[index].config.bus == bus && Devices[index].config.replyId == canId){
+         return index;
+      }
+      pos = (pos + 1) & (CAN_TXN_HASH_SIZE - 1);
+   }
+   return CAN_TXN_NONE;
+}
+
+/**
+ * @brief 把等待队列头部的请求依次放入空闲槽位
+ * @note 必须在临界区内调用,放入的槽位标记为 unsent,由调用者在临界区外发送
+ */
+void CanTransaction::PromotePending(TxnDevice& dev){
+   PendingReq head;
+   while(dev.pending.peek(head) == MW_Status::SUCCESS){
+      TxnSlot& slot = dev.slots[head.seqKey & (dev.config.window - 1)];
+      if(slot.busy){
+         break;
+      }
+      dev.pending.pop(head);
+      slot.msg = head.msg;
+      slot.callback = head.callback;
+      slot.ctx = head.ctx;
+      slot.seqKey = head.seqKey;
+      slot.retriesLeft = dev.config.maxRetries;
+      slot.busy = true;
+      slot.unsent = true;
+      dev.inFlight++;
+   }
+}
+
+/**
+ * @brief 把槽位中标记为 unsent 的请求推入 CanManager 的发送队列
+ * @param device 设备下标
+ * @param slot 槽位下标
+ * @details 1. 在临界区内认领 unsent 标记并复制请求帧,避免定时器中断重复发送
+ *          2. 发送队列已满时恢复 unsent 标记,下一毫秒由钩子重新发送,不消耗重发次数
+ *          3. 超时从推入发送队列的时刻开始计算
+ */
+void CanTransaction::SendSlot(uint8_t device, uint8_t slot){
+   TxnDevice& dev = Devices[device];
+   TxnSlot& s = dev.slots[slot];
+   CanMessage msg;
+   uint16_t seqKey;
+
+   __disable_irq();
+   if(s.busy == false || s.unsent == false){
+      __enable_irq();
+      return;
+   }
+   s.unsent = false;
+   s.deadlineMs = NowMs + dev.config.timeoutMs;
+   msg = s.msg;
+   seqKey = s.seqKey;
+   __enable_irq();
+
+   if(CanManager::GetInstance().sendMessage(dev.config.bus, msg) != MW_Status::SUCCESS){
+      __disable_irq();
+      /*槽位仍然是同一个请求时才恢复标记*/
+      if(s.busy && s.seqKey == seqKey){
+         s.unsent = true;
+      }
+      dev.stats.sendDeferred++;
+      __enable_irq();
+   }
+}
+
+/**
+ * @brief 发送设备窗口中所有标记为 unsent 的请求
+ * @param device 设备下标
+ */
+void CanTransaction::FlushDevice(uint8_t device){
+   for(uint8_t i = 0; i < Devices[device].config.window; i++){
+      SendSlot(device, i);
+   }
+}
+
+/**
+ * @brief 两路CAN共用的应答处理
+ * @param bus 收到应答的总线
+ * @param canId 应答ID
+ * @param data 应答数据
+ * @param len 应答数据长度
+ * @details 1. 哈希表找到设备,replyKey 提取序号键直接定位槽位
+ *          2. 槽位中的序号键一致时结束该事务,并把等待队列中的请求补入窗口
+ *          3. 在临界区外调用事务回调并发送补入的请求
+ */
+void CanTransaction::OnReply(USE_CanBus bus, uint32_t canId, uint8_t* data, uint8_t len){
+   CanTransaction& txn = CanTransaction::GetInstance();
+   uint8_t device = txn.FindDevice(bus, canId);
+   if(device == CAN_TXN_NONE){
+      return;
+   }
+   TxnDevice& dev = txn.Devices[device];
+   uint16_t key = (dev.config.replyKey != nullptr) ? dev.config.replyKey(data, len) : 0;
+
+   CanTxnReplyCallback_t callback = nullptr;
+   void* ctx = nullptr;
+   bool matched = false;
+
+   __disable_irq();
+   TxnSlot& slot = dev.slots[key & (dev.config.window - 1)];
+   /*请求还没有推入发送队列时收到的应答一定不是它的*/
+   if(slot.busy && slot.unsent == false && (dev.config.replyKey == nullptr || slot.seqKey == key)){
+      callback = slot.callback;
+      ctx = slot.ctx;
+      slot.busy = false;
+      dev.inFlight--;
+      dev.stats.completed++;
+      matched = true;
+      txn.PromotePending(dev);
+   }else{
+      dev.stats.staleReplies++;
+   }
+   __enable_irq();
+
+   if(matched){
+      if(callback != nullptr){
+         callback(ctx, MW_Status::SUCCESS, data, len);
+      }
+      txn.FlushDevice(device);
+   }
+}
+
+/**
+ * @brief 注册在 CanManager 上的 CAN1 应答回调
+ */
+void CanTransaction::OnCan1Reply(uint32_t canId, uint8_t* data, uint8_t len){
+   OnReply(USE_CAN1, canId, data, len);
+}
+
+/**
+ * @brief 注册在 CanManager 上的 CAN2 应答回调
+ */
+void CanTransaction::OnCan2Reply(uint32_t canId, uint8_t* data, uint8_t len){
+   OnReply(USE_CAN2, canId, data, len);
+}
+
+/**
+ * @brief 在 TimManger 上订阅的毫秒定时器回调
+ * @details 1. 推进事务层的毫秒时基
+ *          2. 只检查每个设备窗口中的槽位,到期的请求还有重发次数就重新标记为 unsent,
+ *             否则结束事务并通知超时
+ *          3. 在临界区外调用超时回调,再发送所有 unsent 的请求
+ */
+void CanTransaction::OnTick(void* arg){
+   (void)arg;
+   CanTransaction& txn = CanTransaction::GetInstance();
+   uint32_t now = ++txn.NowMs;
+
+   struct TimeoutEvent{
+      CanTxnReplyCallback_t callback;
+      void* ctx;
+   };
+
+   for(uint8_t d = 0; d < txn.DeviceCount; d++){
+      TxnDevice& dev = txn.Devices[d];
+      TimeoutEvent events[CAN_TXN_MAX_WINDOW];
+      uint8_t eventCount = 0;
+
+      __disable_irq();
+      for(uint8_t i = 0; i < dev.config.window; i++){
+         TxnSlot& slot = dev.slots[i];
+         if(slot.busy == false || slot.unsent || static_cast<int32_t>(now - slot.deadlineMs) < 0){
+            continue;
+         }
+         if(slot.retriesLeft > 0){
+            /*重发同一个请求*/
+            slot.retriesLeft--;
+            slot.unsent = true;
+            dev.stats.retries++;
+         }else{
+            /*重发用尽,结束事务*/
+            events[eventCount].callback = slot.callback;
+            events[eventCount].ctx = slot.ctx;
+            eventCount++;
+            slot.busy = false;
+            dev.inFlight--;
+            dev.stats.timeouts++;
+         }
+      }
+      if(eventCount > 0){
+         txn.PromotePending(dev);
+      }
+      __enable_irq();
+
+      for(uint8_t i = 0; i < eventCount; i++){
+         if(events[i].callback != nullptr){
+            events[i].callback(events[i].ctx, MW_Status::TIMEOUT, nullptr, 0);
+         }
+      }
+      txn.FlushDevice(d);
+   }
+}
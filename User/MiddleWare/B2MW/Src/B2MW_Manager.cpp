@@ -0,0 +1,258 @@
+/*===========================================================
+* @file      B2MW_Manager.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* B2MW_Manager.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了B2MWManager类的成员函数
+* 2.实现了 规划 -> 中断优先级 -> 定时器 -> CAN 的启动顺序与分阶段计时
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "B2MW_Manager.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+static_assert(B2MW_IRQ_PRIO_CAN_RX0 >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, "CAN RX0 priority must allow FreeRTOS FromISR calls");
+static_assert(B2MW_IRQ_PRIO_CAN_TX >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, "CAN TX priority must allow FreeRTOS FromISR calls");
+static_assert(B2MW_IRQ_PRIO_TIMER >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, "timer priority must allow FreeRTOS FromISR calls");
+static_assert(B2MW_IRQ_PRIO_CAN_ERR >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, "CAN error priority must allow FreeRTOS FromISR calls");
+static_assert(B2MW_IRQ_PRIO_CAN_ERR <= configLIBRARY_LOWEST_INTERRUPT_PRIORITY, "CAN error priority is out of range");
+
+/*================= B2MWManager的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数,清空规划与启动报告
+ */
+B2MWManager::B2MWManager()
+{
+   memset(FilterPlan, 0, sizeof(FilterPlan));
+   memset(IrqTable, 0, sizeof(IrqTable));
+   memset(&Report, 0, sizeof(Report));
+   NeedTimer = false;
+   IsBooting = false;
+   ReportValid = false;
+}
+
+/**
+ * @brief 获取启动管理器的单例实例
+ * @return B2MWManager& 当前启动管理器的引用
+ */
+B2MWManager& B2MWManager::GetInstance()
+{
+    static B2MWManager instance;
+    return instance;
+}
+
+/**
+ * @brief 规划并启动全部被申请的资源
+ * @details 1. 采用预先标记的方式,保证只启动一次
+ *          2. 各阶段按 规划 -> 中断优先级 -> 定时器 -> CAN 的依赖顺序执行,用 DWT 计时
+ *          3. 任一阶段失败时停止启动并清除标记,允许排查后重新调用
+ * @return 启动操作的状态
+ *         返回值:
+ *         SUCCESS 表示启动成功或已经启动,
+ *         其他值为失败阶段返回的状态
+ */
+MW_Status B2MWManager::Boot(){
+   /* 检查并更新启动状态，此部分需要原子操作 */
+   __disable_irq();
+   bool should_boot = (IsBooting == false);
+   if (should_boot) {
+      IsBooting = true; // 预先标记，防止其他线程重复启动
+   }
+   __enable_irq();
+
+   if(!should_boot){
+      return MW_Status::SUCCESS;
+   }
+
+   ReportValid = false;
+   memset(&Report, 0, sizeof(Report));
+   MW_Status (B2MWManager::*phases[BOOT_PHASE_END])() = {
+      &B2MWManager::PlanPhase,
+      &B2MWManager::NvicPhase,
+      &B2MWManager::TimerPhase,
+      &B2MWManager::CanPhase,
+   };
+
+   uint32_t bootStart = DWT->CYCCNT;
+   MW_Status res = MW_Status::SUCCESS;
+   for(uint8_t i = 0; i < BOOT_PHASE_END; i++){
+      uint32_t phaseStart = DWT->CYCCNT;
+      res = (this->*phases[i])();
+      Report.phaseCycles[i] = DWT->CYCCNT - phaseStart;
+      Report.phaseStatus[i] = res;
+      if(res != MW_Status::SUCCESS){
+         break;
+      }
+   }
+   Report.totalCycles = DWT->CYCCNT - bootStart;
+   Report.booted = (res == MW_Status::SUCCESS);
+   ReportValid = true;
+
+   if(res != MW_Status::SUCCESS){
+      IsBooting = false;
+      return res;
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 获取启动报告
+ * @param report 用于接收报告的引用
+ * @return 获取操作的状态
+ *         返回值:
+ *         UNINITIALIZED 表示还没有调用过 Boot,
+ *         SUCCESS 表示获取成功
+ */
+MW_Status B2MWManager::GetBootReport(B2MWBootReport& report){
+   if(ReportValid == false){
+      return MW_Status::UNINITIALIZED;
+   }
+   report = Report;
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 获取启动阶段的名称
+ * @param phase 启动阶段
+ * @return const char* 阶段名称
+ */
+const char* B2MWManager::PhaseName(B2MWBootPhase phase){
+   switch (phase)
+   {
+      case BOOT_PHASE_PLAN:  return "PLAN";
+      case BOOT_PHASE_NVIC:  return "NVIC";
+      case BOOT_PHASE_TIMER: return "TIMER";
+      case BOOT_PHASE_CAN:   return "CAN";
+      default:               return "UNKNOWN";
+   }
+}
+
+/*==================== 私有函数实现 ====================*/
+
+/**
+ * @brief 向中断规划表追加一项
+ * @param irq 中断号
+ * @param priority 抢占优先级
+ */
+void B2MWManager::AddIrq(IRQn_Type irq, uint8_t priority){
+   if(Report.irqCount < B2MW_MAX_IRQ_PLANS){
+      IrqTable[Report.irqCount].irq = irq;
+      IrqTable[Report.irqCount].priority = priority;
+      Report.irqCount++;
+   }
+}
+
+/**
+ * @brief 规划阶段
+ * @details 1. 对每路被申请的CAN,由订阅表和在线监视表规划滤波器组,并规划其4个中断
+ *          2. 有CAN被申请或已有软件定时器订阅时,才需要启动 TimManger 并规划其中断
+ *          3. 只读取注册表,不触碰硬件
+ * @return 规划操作的状态
+ */
+MW_Status B2MWManager::PlanPhase(){
+   static const IRQn_Type CanIrq[USE_CAN_END][4] = {
+      {CAN1_RX0_IRQn, CAN1_TX_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn},
+      {CAN2_RX0_IRQn, CAN2_TX_IRQn, CAN2_RX1_IRQn, CAN2_SCE_IRQn},
+   };
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   bool anyCan = false;
+
+   for(uint8_t i = USE_CAN_BEGIN; i < USE_CAN_END; i++){
+      USE_CanBus bus = static_cast<USE_CanBus>(i);
+      MW_FuncStatus<bool> asked = CanManagerInstance.IsResourceAsked(bus);
+      if(asked.status != MW_Status::SUCCESS){
+         return asked.status;
+      }
+      Report.canStarted[i] = asked.result;
+      if(!asked.result){
+         continue;
+      }
+      anyCan = true;
+
+      MW_Status res = CanManagerInstance.PlanRxFilter(bus, FilterPlan[i]);
+      if(res != MW_Status::SUCCESS){
+         return res;
+      }
+      Report.filterBanks[i] = FilterPlan[i].bankCount;
+      Report.filterIds[i] = FilterPlan[i].idCount;
+      Report.filterAcceptAll[i] = FilterPlan[i].acceptAll;
+
+      AddIrq(CanIrq[i][0], B2MW_IRQ_PRIO_CAN_RX0);
+      AddIrq(CanIrq[i][1], B2MW_IRQ_PRIO_CAN_TX);
+      AddIrq(CanIrq[i][2], B2MW_IRQ_PRIO_CAN_ERR);
+      AddIrq(CanIrq[i][3], B2MW_IRQ_PRIO_CAN_ERR);
+   }
+
+   NeedTimer = anyCan || (TimManger::GetInstance().GetActiveCount() > 0);
+   if(NeedTimer){
+      AddIrq(B2MW_TIMER_IRQN, B2MW_IRQ_PRIO_TIMER);
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 中断优先级阶段
+ * @details 在外设启动之前写入,外设的中断从第一次触发起就处于规划的优先级
+ * @return 配置操作的状态
+ */
+MW_Status B2MWManager::NvicPhase(){
+   for(uint8_t i = 0; i < Report.irqCount; i++){
+      HAL_NVIC_SetPriority(IrqTable[i].irq, IrqTable[i].priority, 0);
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 定时器阶段
+ * @details CAN 的发送时隙依赖 TimManger,因此定时器先于CAN启动
+ * @return 启动操作的状态
+ */
+MW_Status B2MWManager::TimerPhase(){
+   if(!NeedTimer){
+      return MW_Status::SUCCESS;
+   }
+   MW_Status res = TimManger::GetInstance().Start();
+   Report.timerStarted = (res == MW_Status::SUCCESS);
+   return res;
+}
+
+/**
+ * @brief CAN 阶段
+ * @details 1. 每路被申请的CAN只启动一次,启动时为全部接收
+ *          2. 启动后立即写入规划的滤波器组
+ *          3. 规划之后又有新ID注册时,ApplyRxFilter 已退回全部接收,不视为启动失败
+ * @return 启动操作的状态
+ */
+MW_Status B2MWManager::CanPhase(){
+   CanManager& CanManagerInstance = CanManager::GetInstance();
+   for(uint8_t i = USE_CAN_BEGIN; i < USE_CAN_END; i++){
+      if(!Report.canStarted[i]){
+         continue;
+      }
+      USE_CanBus bus = static_cast<USE_CanBus>(i);
+      MW_Status res = CanManagerInstance.StartResource(bus);
+      if(res != MW_Status::SUCCESS){
+         Report.canStarted[i] = false;
+         return res;
+      }
+      res = CanManagerInstance.ApplyRxFilter(bus, FilterPlan[i]);
+      if(res == MW_Status::INVALID_OPERATION){
+         Report.filterAcceptAll[i] = true;
+      }else if(res != MW_Status::SUCCESS){
+         return res;
+      }
+   }
+   return MW_Status::SUCCESS;
+}
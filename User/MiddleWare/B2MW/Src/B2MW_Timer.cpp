@@ -0,0 +1,383 @@
+/*===========================================================
+* @file      B2MW_Timer.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* B2MW_Timer.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了TimManger类的成员函数
+* 2.实现了挂在一个硬件定时器上的分层时间轮
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "B2MW_Timer.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+/**
+ * @brief 链表和空闲链表中的空下标
+ */
+static constexpr uint16_t TIM_ENTRY_NONE = 0xFFFF;
+
+/**
+ * @brief 时间轮能表示的最大延时(节拍)
+ */
+static constexpr uint32_t TIM_MAX_DELAY_TICKS = (1UL << (TIM_WHEEL_BITS * TIM_WHEEL_LEVELS)) - 1;
+
+static_assert(MAX_TIME_SUBSCRIPTIONS < TIM_ENTRY_NONE, "MAX_TIME_SUBSCRIPTIONS is too large");
+static_assert(TIM_WHEEL_BITS * TIM_WHEEL_LEVELS < 32, "timer wheel range exceeds 32 bits");
+static_assert(TIM_TICK_HZ % 1000 == 0, "TIM_TICK_HZ must be a multiple of 1000");
+
+/*================= TimManger的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数,初始化存储池、空闲链表和时间轮
+ */
+TimManger::TimManger():Tim(TIM_MANAGER_DEVICE)
+{
+   memset(Pool, 0, sizeof(Pool));
+   for(uint16_t i = 0; i < MAX_TIME_SUBSCRIPTIONS; i++){
+      Pool[i].prev = TIM_ENTRY_NONE;
+      Pool[i].next = (i + 1 < MAX_TIME_SUBSCRIPTIONS) ? (i + 1) : TIM_ENTRY_NONE;
+   }
+   FreeHead = 0;
+   ActiveCount = 0;
+   for(uint8_t level = 0; level < TIM_WHEEL_LEVELS; level++){
+      for(uint16_t slot = 0; slot < TIM_WHEEL_SIZE; slot++){
+         Wheel[level][slot] = TIM_ENTRY_NONE;
+      }
+   }
+   Now = 0;
+   CyclesPerTick = 0;
+   TimIsInit = false;
+}
+
+/**
+ * @brief 获取定时器管理器的单例实例
+ * @return TimManger& 当前定时器管理器的引用
+ */
+TimManger& TimManger::GetInstance()
+{
+    static TimManger instance;
+    return instance;
+}
+
+/**
+ * @brief 启动硬件定时器
+ * @details 1. 以 TIM_TICK_HZ 初始化 TIM_MANAGER_DEVICE 并注册节拍回调
+ *          2. 启动前订阅的定时器从第一个节拍开始计时
+ * @return 启动操作的状态
+ *         返回值:
+ *         INVALID_OPERATION 表示硬件定时器已被其他地方占用,
+ *         SUCCESS 表示启动成功或已经启动
+ */
+MW_Status TimManger::Start(){
+   /* 检查并更新定时器的初始化状态，此部分需要原子操作 */
+   __disable_irq();
+   bool should_init_tim = (TimIsInit == false);
+   if (should_init_tim) {
+      TimIsInit = true; // 预先标记，防止其他线程重复初始化
+   }
+   __enable_irq();
+
+   if(should_init_tim){
+      CyclesPerTick = SystemCoreClock / TIM_TICK_HZ;
+      BspResult<bool> OperationSuccess = Tim.Init(TIM_TICK_HZ);
+      if(!OperationSuccess.ok()){
+         TimIsInit = false;
+         /*能跑到这里说明用户在其他地方使用了Bsp层的Timer资源,导致初始化失败*/
+         return MW_Status::INVALID_OPERATION;
+      }
+      Tim.SetCallback(OnTick);
+      Tim.Start();
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 订阅一个周期软件定时器
+ * @param periodTicks 周期(节拍)
+ * @param callback 回调函数
+ * @param ctx 透传给回调的上下文
+ * @param firstDelayTicks 第一次触发前的延时(节拍),为 0 时等于周期
+ * @return result 为定时器句柄,
+ *         status 为 INVALID_PARAM 表示参数无效,
+ *         RESOURCE_BUSY 表示存储池已满,
+ *         SUCCESS 表示订阅成功
+ */
+MW_FuncStatus<TimHandle_t> TimManger::Subscribe(uint32_t periodTicks, TimCallback_t callback, void* ctx, uint32_t firstDelayTicks){
+   if(periodTicks == 0 || periodTicks > TIM_MAX_DELAY_TICKS){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+   return Add((firstDelayTicks == 0) ? periodTicks : firstDelayTicks, periodTicks, callback, ctx);
+}
+
+/**
+ * @brief 订阅一个单次软件定时器
+ * @param delayTicks 延时(节拍),为 0 时在下一个节拍触发
+ * @param callback 回调函数
+ * @param ctx 透传给回调的上下文
+ * @return result 为定时器句柄,
+ *         status 为 INVALID_PARAM 表示参数无效,
+ *         RESOURCE_BUSY 表示存储池已满,
+ *         SUCCESS 表示订阅成功
+ */
+MW_FuncStatus<TimHandle_t> TimManger::OneShot(uint32_t delayTicks, TimCallback_t callback, void* ctx){
+   return Add((delayTicks == 0) ? 1 : delayTicks, 0, callback, ctx);
+}
+
+/**
+ * @brief 取消一个软件定时器
+ * @param handle 定时器句柄
+ * @details 从所在槽的双向链表上摘下并放回空闲链表,O(1)
+ * @return 取消操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示句柄无效或定时器已经结束,
+ *         SUCCESS 表示取消成功
+ */
+MW_Status TimManger::Cancel(TimHandle_t handle){
+   MW_Status res = MW_Status::INVALID_PARAM;
+   __disable_irq();
+   uint16_t index = IndexOf(handle);
+   if(index != TIM_ENTRY_NONE){
+      if(Pool[index].linked){
+         Unlink(index);
+      }
+      Release(index);
+      res = MW_Status::SUCCESS;
+   }
+   __enable_irq();
+   return res;
+}
+
+/**
+ * @brief 获取软件定时器的抖动统计
+ * @param handle 定时器句柄
+ * @param stats 用于接收统计数据的引用
+ * @return 查询操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示句柄无效,
+ *         SUCCESS 表示查询成功
+ */
+MW_Status TimManger::GetStats(TimHandle_t handle, TimJitterStats& stats){
+   MW_Status res = MW_Status::INVALID_PARAM;
+   __disable_irq();
+   uint16_t index = IndexOf(handle);
+   if(index != TIM_ENTRY_NONE){
+      stats = Pool[index].stats;
+      res = MW_Status::SUCCESS;
+   }
+   __enable_irq();
+   return res;
+}
+
+/*==================== 私有函数实现 ====================*/
+
+/**
+ * @brief 分配存储池并挂入时间轮
+ * @param delayTicks 第一次触发前的延时(节拍),至少为 1
+ * @param periodTicks 周期(节拍),0 表示单次定时器
+ * @param callback 回调函数
+ * @param ctx 透传给回调的上下文
+ * @return 定时器句柄和订阅操作的状态
+ */
+MW_FuncStatus<TimHandle_t> TimManger::Add(uint32_t delayTicks, uint32_t periodTicks, TimCallback_t callback, void* ctx){
+   if(callback == nullptr || delayTicks == 0 || delayTicks > TIM_MAX_DELAY_TICKS){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+
+   MW_FuncStatus<TimHandle_t> res = {0, MW_Status::RESOURCE_BUSY};
+
+   /*进入临界区, 存储池和时间轮会在节拍中断中被访问*/
+   __disable_irq();
+   uint16_t index = FreeHead;
+   if(index != TIM_ENTRY_NONE){
+      TimEntry& e = Pool[index];
+      FreeHead = e.next;
+      e.callback = callback;
+      e.ctx = ctx;
+      e.periodTicks = periodTicks;
+      e.expiry = Now + delayTicks;
+      e.lastFireCycles = 0;
+      memset(&e.stats, 0, sizeof(e.stats));
+      e.used = true;
+      ActiveCount++;
+      Link(index);
+      res = {(static_cast<uint32_t>(e.generation) << 16) | index, MW_Status::SUCCESS};
+   }
+   /*退出临界区*/
+   __enable_irq();
+
+   return res;
+}
+
+/**
+ * @brief 按到期节拍把定时器挂到对应层的槽上
+ * @details 剩余节拍小于 64 挂在第 0 层,小于 64^2 挂在第 1 层,以此类推,
+ *          第 n 层的槽号取到期节拍的第 n 组 6 位
+ * @note 必须在临界区内调用
+ */
+void TimManger::Link(uint16_t index){
+   TimEntry& e = Pool[index];
+   int32_t delta = static_cast<int32_t>(e.expiry - Now);
+   uint8_t level = 0;
+   if(delta < 0){
+      /*防御: 已经过期的定时器挂在当前槽上*/
+      e.expiry = Now;
+   }else{
+      while(level < TIM_WHEEL_LEVELS - 1 && static_cast<uint32_t>(delta) >= (1UL << (TIM_WHEEL_BITS * (level + 1)))){
+         level++;
+      }
+   }
+   uint8_t slot = (e.expiry >> (TIM_WHEEL_BITS * level)) & (TIM_WHEEL_SIZE - 1);
+
+   e.level = level;
+   e.slot = slot;
+   e.prev = TIM_ENTRY_NONE;
+   e.next = Wheel[level][slot];
+   if(e.next != TIM_ENTRY_NONE){
+      Pool[e.next].prev = index;
+   }
+   Wheel[level][slot] = index;
+   e.linked = true;
+}
+
+/**
+ * @brief 把定时器从所在的槽上摘下
+ * @note 必须在临界区内调用
+ */
+void TimManger::Unlink(uint16_t index){
+   TimEntry& e = Pool[index];
+   if(e.prev != TIM_ENTRY_NONE){
+      Pool[e.prev].next = e.next;
+   }else{
+      Wheel[e.level][e.slot] = e.next;
+   }
+   if(e.next != TIM_ENTRY_NONE){
+      Pool[e.next].prev = e.prev;
+   }
+   e.prev = TIM_ENTRY_NONE;
+   e.next = TIM_ENTRY_NONE;
+   e.linked = false;
+}
+
+/**
+ * @brief 把定时器放回空闲链表,代数加一使旧句柄失效
+ * @note 必须在临界区内调用
+ */
+void TimManger::Release(uint16_t index){
+   TimEntry& e = Pool[index];
+   e.used = false;
+   e.callback = nullptr;
+   e.generation++;
+   ActiveCount--;
+   e.next = FreeHead;
+   FreeHead = index;
+}
+
+/**
+ * @brief 校验句柄并返回存储池下标
+ * @note 必须在临界区内调用
+ */
+uint16_t TimManger::IndexOf(TimHandle_t handle) const{
+   uint16_t index = handle & 0xFFFF;
+   uint16_t generation = handle >> 16;
+   if(index >= MAX_TIME_SUBSCRIPTIONS || !Pool[index].used || Pool[index].generation != generation){
+      return TIM_ENTRY_NONE;
+   }
+   return index;
+}
+
+/**
+ * @brief 把第 level 层当前槽上的定时器重新挂到更低的层
+ * @note 必须在临界区内调用
+ */
+void TimManger::Cascade(uint8_t level){
+   uint8_t slot = (Now >> (TIM_WHEEL_BITS * level)) & (TIM_WHEEL_SIZE - 1);
+   uint16_t index = Wheel[level][slot];
+   Wheel[level][slot] = TIM_ENTRY_NONE;
+   while(index != TIM_ENTRY_NONE){
+      uint16_t next = Pool[index].next;
+      Link(index);
+      index = next;
+   }
+}
+
+/**
+ * @brief 硬件定时器的中断回调,推进一个节拍
+ * @details 1. 第 0 层转满一圈时依次向下级联高层的当前槽
+ *          2. 逐个取下第 0 层当前槽上的定时器,周期定时器先按下一次到期重新挂入,
+ *             单次定时器先释放,再在临界区外调用回调,回调中可以安全地取消或订阅定时器
+ *          3. 周期定时器用 DWT 统计相邻两次触发的间隔相对标称周期的抖动
+ */
+void TimManger::OnTick(){
+   TimManger& TimMangerInstance = TimManger::GetInstance();
+
+   __disable_irq();
+   uint32_t now = ++TimMangerInstance.Now;
+   if((now & (TIM_WHEEL_SIZE - 1)) == 0){
+      for(uint8_t level = 1; level < TIM_WHEEL_LEVELS; level++){
+         TimMangerInstance.Cascade(level);
+         if(((now >> (TIM_WHEEL_BITS * level)) & (TIM_WHEEL_SIZE - 1)) != 0){
+            break;
+         }
+      }
+   }
+   __enable_irq();
+
+   uint8_t slot = now & (TIM_WHEEL_SIZE - 1);
+   for(;;){
+      __disable_irq();
+      uint16_t index = TimMangerInstance.Wheel[0][slot];
+      if(index == TIM_ENTRY_NONE){
+         __enable_irq();
+         break;
+      }
+      TimEntry& e = TimMangerInstance.Pool[index];
+      TimMangerInstance.Unlink(index);
+      TimCallback_t callback = e.callback;
+      void* ctx = e.ctx;
+      uint32_t period = e.periodTicks;
+      uint16_t generation = e.generation;
+      if(period != 0){
+         e.expiry += period;
+         TimMangerInstance.Link(index);
+      }else{
+         TimMangerInstance.Release(index);
+      }
+      __enable_irq();
+
+      uint32_t start = DWT->CYCCNT;
+      if(period != 0){
+         /*统计相邻两次触发的间隔相对标称周期的抖动*/
+         if(e.stats.fires > 0){
+            uint32_t interval = start - e.lastFireCycles;
+            uint32_t expected = period * TimMangerInstance.CyclesPerTick;
+            uint32_t jitter = (interval > expected) ? (interval - expected) : (expected - interval);
+            e.stats.lastJitterCycles = jitter;
+            if(jitter > e.stats.maxJitterCycles){
+               e.stats.maxJitterCycles = jitter;
+            }
+            e.stats.avgJitterCycles = e.stats.avgJitterCycles - (e.stats.avgJitterCycles >> 4) + (jitter >> 4);
+         }
+         e.lastFireCycles = start;
+         e.stats.fires++;
+      }
+
+      callback(ctx);
+
+      /*回调中可能取消了自身,代数不变时才更新耗时*/
+      uint32_t run = DWT->CYCCNT - start;
+      if(e.used && e.generation == generation && run > e.stats.maxRunCycles){
+         e.stats.maxRunCycles = run;
+      }
+   }
+}
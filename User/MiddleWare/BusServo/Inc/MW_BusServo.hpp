@@ -0,0 +1,295 @@
+/*===========================================================
+* @file      MW_BusServo.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* BspUart.h
+* B2MW_Timer.hpp
+* MW_Common.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 构建在 Uart 之上的半双工总线舵机事务调度器(飞特 SCS/STS、Dynamixel 1.0 帧格式)
+* 一条总线上的同步写、同步读按批次排队,报文在提交时编码,总线上只剩DMA发送;
+* 发送完成中断中切换为接收方向,应答在接收中断中解析并逐个舵机计时,
+* 最后一个应答到达(或超时)时立即启动下一批,不经过任务调度。
+* 1. 声明了 BusServoBus 类，作为一条舵机总线的调度器。
+* 2. 定义了 BusServoBatch 结构体，用于描述一次同步写或同步读。
+* 3. 定义了 BusServoConfig 结构体，用于描述总线的方向控制与超时。
+* 4. 定义了 BusServoStats 结构体，用于统计应答与超时。
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+#ifndef MW_BUSSERVO_HPP
+#define MW_BUSSERVO_HPP
+
+/*========================= 文件依赖 =========================*/
+
+#include "BspUart.h"
+#include "B2MW_Timer.hpp"
+#include "MW_Common.hpp"
+
+/*========================== 宏定义 ==========================*/
+
+/**
+ * @brief 一个批次最多包含的舵机数量(不超过32,应答结果按位记录)
+ */
+#define BUS_SERVO_MAX_IDS 16
+
+/**
+ * @brief 每个舵机最多读写的字节数
+ */
+#define BUS_SERVO_MAX_DATA 8
+
+/**
+ * @brief 每条总线排队的批次数量(含正在进行的一批)
+ */
+#define BUS_SERVO_QUEUE_DEPTH 4
+
+/**
+ * @brief 一个报文的最大长度: FF FF ID LEN INST ADDR L + 每个舵机(ID + L) + CHK
+ */
+#define BUS_SERVO_MAX_PACKET (8 + BUS_SERVO_MAX_IDS * (BUS_SERVO_MAX_DATA + 1))
+
+/**
+ * @brief 广播ID与指令
+ */
+#define BUS_SERVO_BROADCAST_ID 0xFE
+#define BUS_SERVO_INST_SYNC_READ 0x82
+#define BUS_SERVO_INST_SYNC_WRITE 0x83
+
+/*==================== 舵机总线数据类型 ====================*/
+
+/**
+ * @brief 批次类型
+ * @details
+ *  BusServoOp::SyncWrite-同步写,广播,舵机不应答,发送完成即结束
+ *  BusServoOp::SyncRead-同步读,舵机按ID列表的顺序逐个应答(飞特 STS/SMS 支持, Dynamixel 1.0 不支持)
+ */
+enum class BusServoOp : uint8_t
+{
+    SyncWrite = 0,
+    SyncRead
+};
+
+struct BusServoBatch;
+
+/**
+ * @brief 批次结束回调
+ * @param ctx 提交时传入的上下文
+ * @param batch 结束的批次,replyMask/errorMask 已经更新
+ * @note 在串口中断或定时器中断中调用,此时下一批已经开始发送
+ */
+typedef void (*BusServoDoneCallback_t)(void* ctx, BusServoBatch& batch);
+
+/**
+ * @brief 一次同步写或同步读,由调用者持有,在结束回调之前必须保持有效
+ */
+struct BusServoBatch
+{
+    BusServoOp op = BusServoOp::SyncWrite;
+    const uint8_t* ids = nullptr;            /*!< 舵机ID列表 */
+    uint8_t count = 0;                       /*!< 舵机数量,不超过 BUS_SERVO_MAX_IDS */
+    uint8_t addr = 0;                        /*!< 寄存器地址 */
+    uint8_t len = 0;                         /*!< 每个舵机读写的字节数,不超过 BUS_SERVO_MAX_DATA */
+    const uint8_t* writeData = nullptr;      /*!< 同步写: count * len 字节,按ID列表顺序排列,提交时即被编码 */
+    uint8_t* readData = nullptr;             /*!< 同步读: count * len 字节,第 i 个舵机的数据写在 i * len 处 */
+    BusServoDoneCallback_t done = nullptr;   /*!< 结束回调,可以为 nullptr */
+    void* ctx = nullptr;                     /*!< 透传给结束回调的上下文 */
+
+    // 以下由调度器写入
+    volatile uint32_t replyMask = 0;         /*!< 第 i 位表示第 i 个舵机的应答校验通过 */
+    volatile uint32_t errorMask = 0;         /*!< 第 i 位表示第 i 个舵机的应答带错误状态 */
+    volatile bool pending = false;           /*!< 已提交且尚未结束 */
+};
+
+/**
+ * @brief 总线配置
+ * @details dirPort 为 nullptr 时使用单线半双工(HDSEL),发送期间关闭接收器;
+ *          否则由 dirPin 控制外部收发器(如 74HC126)的方向
+ */
+struct BusServoConfig
+{
+    uint32_t baud = 1000000;                 /*!< 波特率 */
+    GPIO_TypeDef* dirPort = nullptr;         /*!< 方向控制引脚所在的端口 */
+    uint16_t dirPin = 0;                     /*!< 方向控制引脚 */
+    GPIO_PinState dirTxLevel = GPIO_PIN_SET; /*!< 发送时方向引脚的电平 */
+    uint16_t replyTimeoutUs = 1000;          /*!< 每个舵机的应答超时,从发送完成或上一个应答开始计时 */
+};
+
+/**
+ * @brief 总线统计
+ */
+struct BusServoStats
+{
+    uint32_t batches;                        /*!< 结束的批次数 */
+    uint32_t replies;                        /*!< 校验通过的应答数 */
+    uint32_t timeouts;                       /*!< 没有应答的舵机数 */
+    uint32_t checksumErrors;                 /*!< 校验错误的应答数 */
+    uint32_t unexpected;                     /*!< 不在等待列表中的应答数 */
+    uint32_t txErrors;                       /*!< 启动DMA发送失败的批次数 */
+};
+
+/*==================== 舵机总线调度器类 ====================*/
+
+/**
+ * @brief 舵机总线调度器
+ * @details
+ * 1. 一个 Uart 只服务一条总线,该串口不再用于其他收发。
+ * 2. 批次按提交顺序执行,报文在 Submit 时编码到调度器的槽位中,中断里只启动DMA。
+ * 3. 超时由 TimManger 的一个节拍定时器检查,精度为一个节拍(100us)。
+ * 4. 串口中断的优先级必须不低于 TimManger 的定时器中断(B2MW_IRQ_PRIO_TIMER)。
+ * 5. 全部使用静态存储,不进行动态内存分配。
+ */
+class BusServoBus
+{
+public:
+
+    /**
+     * @brief 构造函数
+     * @param uart 总线所在的串口
+     * @param config 总线配置
+     */
+    BusServoBus(Uart& uart, const BusServoConfig& config);
+
+    /**
+     * @brief 配置串口与方向控制,启动接收并订阅超时检查定时器
+     * @return 启动操作的状态
+     * @note 在 B2MWManager::Boot 之前调用,由 Boot 启动 TimManger
+     */
+    MW_Status Start();
+
+    /**
+     * @brief 提交一个批次
+     * @param batch 批次,在结束回调之前必须保持有效
+     * @return RESOURCE_BUSY 表示队列已满或该批次尚未结束, SUCCESS 表示已排队
+     * @details 总线空闲时立即开始发送
+     */
+    MW_Status Submit(BusServoBatch& batch);
+
+    /**
+     * @brief 是否还有未结束的批次
+     */
+    bool IsBusy() const { return QueueUsed != 0; }
+
+    /**
+     * @brief 获取总线统计
+     */
+    const BusServoStats& GetStats() const { return Stats; }
+
+private:
+
+/*==================== 舵机总线私有成员变量 ====================*/
+
+    /**
+     * @brief 总线阶段
+     */
+    enum BusPhase : uint8_t{
+        PHASE_IDLE = 0,                      /*!< 没有正在进行的批次 */
+        PHASE_SENDING,                       /*!< 正在发送报文 */
+        PHASE_RECEIVING                      /*!< 正在等待同步读的应答 */
+    };
+
+    /**
+     * @brief 应答解析状态
+     */
+    enum ParseState : uint8_t{
+        PARSE_HEADER1 = 0,
+        PARSE_HEADER2,
+        PARSE_ID,
+        PARSE_LEN,
+        PARSE_BODY
+    };
+
+    /**
+     * @brief 队列中的一个槽位,报文在提交时编码
+     */
+    struct BatchSlot{
+        BusServoBatch* batch;
+        uint8_t packet[BUS_SERVO_MAX_PACKET];
+        UartTxSegment segment;
+        UartTxRequest request;
+        volatile bool ready;                 /*!< 报文已编码完成 */
+    };
+
+    Uart& Port;                                     /*!< 总线所在的串口 */
+    BusServoConfig Config;                          /*!< 总线配置 */
+    uint32_t TimeoutTicks;                          /*!< 每个舵机的应答超时(节拍) */
+    bool IsStarted;                                 /*!< 是否已经调用过 Start */
+
+    BatchSlot Slots[BUS_SERVO_QUEUE_DEPTH];         /*!< 批次队列 */
+    volatile uint8_t QueueHead;                     /*!< 队头槽位,即正在进行的批次 */
+    volatile uint8_t QueueUsed;                     /*!< 已占用的槽位数 */
+    volatile BusPhase Phase;                        /*!< 总线阶段 */
+    volatile uint8_t Cursor;                        /*!< 等待应答的舵机下标 */
+    volatile uint32_t DeadlineTicks;                /*!< 当前舵机的应答截止时间 */
+
+    ParseState Parse;                               /*!< 应答解析状态 */
+    uint8_t ParseId;
+    uint8_t ParseLen;
+    uint8_t ParsePos;
+    uint8_t ParseSum;
+    uint8_t ParseBody[BUS_SERVO_MAX_DATA + 2];      /*!< 错误状态 + 数据 + 校验和 */
+
+    BusServoStats Stats;                            /*!< 总线统计 */
+
+/*==================== 舵机总线私有成员函数 ====================*/
+
+    BusServoBus(const BusServoBus&) = delete;
+    BusServoBus& operator=(const BusServoBus&) = delete;
+
+    /**
+     * @brief 把批次编码为同步写或同步读报文,返回报文长度
+     */
+    static uint16_t Encode(const BusServoBatch& batch, uint8_t* packet);
+
+    /**
+     * @brief 切换总线方向
+     */
+    void SetDirection(bool tx);
+
+    /**
+     * @brief 切换为发送方向并启动槽位的DMA发送,在临界区外调用
+     */
+    void Transmit(BatchSlot& slot);
+
+    /**
+     * @brief 结束队头批次并取出下一个已编码的槽位,必须在临界区内调用
+     * @return 下一个要发送的槽位,没有时返回 nullptr
+     */
+    BatchSlot* FinishLocked(BusServoBatch*& finished);
+
+    /**
+     * @brief 启动下一批并调用结束回调,在临界区外调用
+     */
+    void Complete(BusServoBatch* finished, BatchSlot* next);
+
+    /**
+     * @brief 解析一个应答字节
+     */
+    void ParseByte(uint8_t byte);
+
+    /**
+     * @brief 处理一个校验通过的应答
+     */
+    void OnReply(uint8_t id, uint8_t error, const uint8_t* data, uint8_t len);
+
+    /**
+     * @brief 注册在 Uart 上的发送完成回调,切换方向并开始等待应答
+     */
+    static void OnTxDone(void* ctx, bool ok);
+
+    /**
+     * @brief 注册在 Uart 上的接收事件回调
+     */
+    static void OnRxEvent(void* ctx, uint16_t size);
+
+    /**
+     * @brief 在 TimManger 上订阅的节拍定时器回调,检查应答超时
+     */
+    static void OnTick(void* ctx);
+};
+
+#endif /* MW_BUSSERVO_HPP */
@@ -0,0 +1,446 @@
+/*===========================================================
+* @file      MW_BusServo.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* MW_BusServo.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了BusServoBus类的成员函数
+* 2.实现了 提交编码 -> DMA发送 -> 发送完成切换方向 -> 逐个应答计时 -> 立即启动下一批 的流水
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "MW_BusServo.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+static_assert(BUS_SERVO_MAX_IDS <= 32, "replyMask holds at most 32 servos");
+static_assert(BUS_SERVO_MAX_IDS * (BUS_SERVO_MAX_DATA + 1) + 4 <= 0xFF, "sync packet LEN field overflows");
+
+/**
+ * @brief 报文头
+ */
+static constexpr uint8_t BusServoHeader = 0xFF;
+
+/*================= BusServoBus的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数
+ * @param uart 总线所在的串口
+ * @param config 总线配置
+ */
+BusServoBus::BusServoBus(Uart& uart, const BusServoConfig& config)
+   : Port(uart), Config(config), IsStarted(false), Slots(), QueueHead(0), QueueUsed(0),
+     Phase(PHASE_IDLE), Cursor(0), DeadlineTicks(0), Parse(PARSE_HEADER1),
+     ParseId(0), ParseLen(0), ParsePos(0), ParseSum(0)
+{
+   /*向上取整到节拍,再加一个节拍抵消节拍定时器的相位*/
+   TimeoutTicks = ((uint32_t)config.replyTimeoutUs * TIM_TICK_HZ + 999999U) / 1000000U + 1U;
+   memset(ParseBody, 0, sizeof(ParseBody));
+   memset(&Stats, 0, sizeof(Stats));
+}
+
+/**
+ * @brief 配置串口与方向控制,启动接收并订阅超时检查定时器
+ * @details 1. 没有方向控制引脚时打开单线半双工
+ *          2. 超时检查定时器每个节拍检查一次,不在等待应答时直接返回
+ * @return 启动操作的状态
+ *         返回值:
+ *         INVALID_OPERATION 表示串口初始化或启动接收失败,
+ *         TimManger 订阅失败时返回其状态,
+ *         SUCCESS 表示启动成功或已经启动
+ */
+MW_Status BusServoBus::Start(){
+   if(IsStarted){
+      return MW_Status::SUCCESS;
+   }
+   if(!Port.Init(Config.baud).ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+   if(Config.dirPort == nullptr && !Port.SetHalfDuplex(true).ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+   if(!Port.SetRxEventCallback(OnRxEvent, this).ok() || !Port.EnableRxDMA().ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+   MW_FuncStatus<TimHandle_t> res = TimManger::GetInstance().Subscribe(1, OnTick, this);
+   if(res.status != MW_Status::SUCCESS){
+      return res.status;
+   }
+   SetDirection(false);
+   IsStarted = true;
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 提交一个批次
+ * @details 1. 在临界区内占用队尾槽位,在临界区外编码报文
+ *          2. 编码完成后发布槽位,总线空闲且队头已就绪时立即开始发送
+ * @param batch 批次
+ * @return 提交操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示批次参数非法,
+ *         UNINITIALIZED 表示还没有调用 Start,
+ *         RESOURCE_BUSY 表示队列已满或该批次尚未结束,
+ *         SUCCESS 表示已排队
+ */
+MW_Status BusServoBus::Submit(BusServoBatch& batch){
+   if(batch.ids == nullptr || batch.count == 0 || batch.count > BUS_SERVO_MAX_IDS
+      || batch.len == 0 || batch.len > BUS_SERVO_MAX_DATA){
+      return MW_Status::INVALID_PARAM;
+   }
+   if((batch.op == BusServoOp::SyncWrite && batch.writeData == nullptr)
+      || (batch.op == BusServoOp::SyncRead && batch.readData == nullptr)){
+      return MW_Status::INVALID_PARAM;
+   }
+   if(!IsStarted){
+      return MW_Status::UNINITIALIZED;
+   }
+
+   /* 占用队尾槽位，此部分需要原子操作 */
+   __disable_irq();
+   if(batch.pending || QueueUsed >= BUS_SERVO_QUEUE_DEPTH){
+      __enable_irq();
+      return MW_Status::RESOURCE_BUSY;
+   }
+   BatchSlot& slot = Slots[(QueueHead + QueueUsed) % BUS_SERVO_QUEUE_DEPTH];
+   QueueUsed++;
+   slot.ready = false;
+   slot.batch = &batch;
+   batch.replyMask = 0;
+   batch.errorMask = 0;
+   batch.pending = true;
+   __enable_irq();
+
+   slot.segment.data = slot.packet;
+   slot.segment.len = Encode(batch, slot.packet);
+   slot.request.segments = &slot.segment;
+   slot.request.count = 1;
+   slot.request.done = OnTxDone;
+   slot.request.ctx = this;
+
+   /* 发布槽位，总线空闲时由提交者启动队头 */
+   BatchSlot* next = nullptr;
+   __disable_irq();
+   slot.ready = true;
+   if(Phase == PHASE_IDLE && Slots[QueueHead].ready){
+      Phase = PHASE_SENDING;
+      next = &Slots[QueueHead];
+   }
+   __enable_irq();
+
+   if(next != nullptr){
+      Transmit(*next);
+   }
+   return MW_Status::SUCCESS;
+}
+
+/*==================== 私有函数实现 ====================*/
+
+/**
+ * @brief 把批次编码为同步写或同步读报文
+ * @details 同步写: FF FF FE LEN 83 ADDR L (ID D0..DL-1)*N CHK
+ *          同步读: FF FF FE LEN 82 ADDR L ID*N CHK
+ *          CHK 为 ID 到最后一个参数之和取反
+ * @param batch 批次
+ * @param packet 报文缓冲区,至少 BUS_SERVO_MAX_PACKET 字节
+ * @return 报文长度
+ */
+uint16_t BusServoBus::Encode(const BusServoBatch& batch, uint8_t* packet){
+   bool write = (batch.op == BusServoOp::SyncWrite);
+   uint8_t perServo = write ? (uint8_t)(batch.len + 1) : 1;
+
+   packet[0] = BusServoHeader;
+   packet[1] = BusServoHeader;
+   packet[2] = BUS_SERVO_BROADCAST_ID;
+   packet[3] = (uint8_t)(perServo * batch.count + 4);
+   packet[4] = write ? BUS_SERVO_INST_SYNC_WRITE : BUS_SERVO_INST_SYNC_READ;
+   packet[5] = batch.addr;
+   packet[6] = batch.len;
+
+   uint16_t pos = 7;
+   for(uint8_t i = 0; i < batch.count; i++){
+      packet[pos++] = batch.ids[i];
+      if(write){
+         memcpy(&packet[pos], &batch.writeData[i * batch.len], batch.len);
+         pos += batch.len;
+      }
+   }
+
+   uint8_t sum = 0;
+   for(uint16_t i = 2; i < pos; i++){
+      sum += packet[i];
+   }
+   packet[pos++] = (uint8_t)~sum;
+   return pos;
+}
+
+/**
+ * @brief 切换总线方向
+ * @param tx true 为发送
+ * @details 有方向引脚时只写引脚;单线半双工时发送期间关闭接收器,不收到自己发出的字节
+ */
+void BusServoBus::SetDirection(bool tx){
+   if(Config.dirPort != nullptr){
+      GPIO_PinState rxLevel = (Config.dirTxLevel == GPIO_PIN_SET) ? GPIO_PIN_RESET : GPIO_PIN_SET;
+      HAL_GPIO_WritePin(Config.dirPort, Config.dirPin, tx ? Config.dirTxLevel : rxLevel);
+   }else{
+      Port.SetReceiverEnabled(!tx);
+   }
+}
+
+/**
+ * @brief 切换为发送方向并启动槽位的DMA发送
+ * @param slot 队头槽位
+ * @details DMA 启动失败时按发送失败结束该批次
+ */
+void BusServoBus::Transmit(BatchSlot& slot){
+   SetDirection(true);
+   if(!Port.SendSegments(slot.request).ok()){
+      Stats.txErrors++;
+      OnTxDone(this, false);
+   }
+}
+
+/**
+ * @brief 结束队头批次并取出下一个已编码的槽位
+ * @param finished 用于接收结束的批次
+ * @return 下一个要发送的槽位,没有时返回 nullptr 并进入空闲
+ */
+BusServoBus::BatchSlot* BusServoBus::FinishLocked(BusServoBatch*& finished){
+   BatchSlot& slot = Slots[QueueHead];
+   finished = slot.batch;
+   slot.batch = nullptr;
+   slot.ready = false;
+   QueueHead = (QueueHead + 1) % BUS_SERVO_QUEUE_DEPTH;
+   QueueUsed--;
+   Stats.batches++;
+
+   if(QueueUsed > 0 && Slots[QueueHead].ready){
+      Phase = PHASE_SENDING;
+      return &Slots[QueueHead];
+   }
+   Phase = PHASE_IDLE;
+   return nullptr;
+}
+
+/**
+ * @brief 启动下一批并调用结束回调
+ * @details 先启动DMA再调用回调,回调的耗时不占用总线时间
+ * @param finished 结束的批次
+ * @param next 下一个要发送的槽位,可以为 nullptr
+ */
+void BusServoBus::Complete(BusServoBatch* finished, BatchSlot* next){
+   if(next != nullptr){
+      Transmit(*next);
+   }
+   finished->pending = false;
+   if(finished->done != nullptr){
+      finished->done(finished->ctx, *finished);
+   }
+}
+
+/**
+ * @brief 解析一个应答字节
+ * @details 应答格式: FF FF ID LEN ERR D0..DL-1 CHK, LEN = L + 2。
+ *          不在等待应答时丢弃;LEN 超出范围时重新搜索帧头
+ * @param byte 接收到的字节
+ */
+void BusServoBus::ParseByte(uint8_t byte){
+   if(Phase != PHASE_RECEIVING){
+      Parse = PARSE_HEADER1;
+      return;
+   }
+
+   switch(Parse){
+      case PARSE_HEADER1:
+         if(byte == BusServoHeader){
+            Parse = PARSE_HEADER2;
+         }
+         break;
+      case PARSE_HEADER2:
+         Parse = (byte == BusServoHeader) ? PARSE_ID : PARSE_HEADER1;
+         break;
+      case PARSE_ID:
+         if(byte != BusServoHeader){   // 多余的帧头字节
+            ParseId = byte;
+            ParseSum = byte;
+            Parse = PARSE_LEN;
+         }
+         break;
+      case PARSE_LEN:
+         if(byte < 2 || byte > BUS_SERVO_MAX_DATA + 2){
+            Parse = PARSE_HEADER1;
+            break;
+         }
+         ParseLen = byte;
+         ParseSum += byte;
+         ParsePos = 0;
+         Parse = PARSE_BODY;
+         break;
+      case PARSE_BODY:
+         ParseBody[ParsePos++] = byte;
+         if(ParsePos < ParseLen){
+            ParseSum += byte;
+            break;
+         }
+         Parse = PARSE_HEADER1;
+         if((uint8_t)~ParseSum != byte){
+            Stats.checksumErrors++;
+            break;
+         }
+         OnReply(ParseId, ParseBody[0], &ParseBody[1], (uint8_t)(ParseLen - 2));
+         break;
+      default:
+         Parse = PARSE_HEADER1;
+         break;
+   }
+}
+
+/**
+ * @brief 处理一个校验通过的应答
+ * @details 1. 应答ID在等待列表中当前舵机之后时,中间的舵机记为超时
+ *          2. 最后一个舵机应答后立即启动下一批
+ *          3. 单线半双工下收到的广播报文是自己发出的回显,直接忽略
+ * @param id 舵机ID
+ * @param error 舵机的错误状态
+ * @param data 应答数据
+ * @param len 应答数据长度
+ */
+void BusServoBus::OnReply(uint8_t id, uint8_t error, const uint8_t* data, uint8_t len){
+   if(id == BUS_SERVO_BROADCAST_ID){
+      return;
+   }
+
+   BusServoBatch* finished = nullptr;
+   BatchSlot* next = nullptr;
+   __disable_irq();
+   BusServoBatch* batch = Slots[QueueHead].batch;
+   uint8_t k = Cursor;
+   while(k < batch->count && batch->ids[k] != id){
+      k++;
+   }
+   if(k >= batch->count || len != batch->len){
+      Stats.unexpected++;
+      __enable_irq();
+      return;
+   }
+
+   Stats.timeouts += k - Cursor;
+   Stats.replies++;
+   memcpy(&batch->readData[k * len], data, len);
+   batch->replyMask |= (1UL << k);
+   if(error != 0){
+      batch->errorMask |= (1UL << k);
+   }
+   Cursor = k + 1;
+   if(Cursor < batch->count){
+      DeadlineTicks = TimManger::GetInstance().NowTicks() + TimeoutTicks;
+   }else{
+      next = FinishLocked(finished);
+   }
+   __enable_irq();
+
+   if(finished != nullptr){
+      Complete(finished, next);
+   }
+}
+
+/**
+ * @brief 发送完成回调,在串口发送完成中断中调用(最后一个停止位已经发出)
+ * @details 1. 立即切换为接收方向
+ *          2. 同步写没有应答,直接结束并启动下一批
+ *          3. 同步读丢弃发送期间收到的字节,从第一个舵机开始计时
+ * @param ctx 调度器
+ * @param ok false 表示发送被取消或DMA启动失败
+ */
+void BusServoBus::OnTxDone(void* ctx, bool ok){
+   BusServoBus* self = static_cast<BusServoBus*>(ctx);
+   self->SetDirection(false);
+
+   bool read = ok && (self->Slots[self->QueueHead].batch->op == BusServoOp::SyncRead);
+   if(read){
+      self->Port.ClearRxBuffer();
+   }
+
+   BusServoBatch* finished = nullptr;
+   BatchSlot* next = nullptr;
+   __disable_irq();
+   if(read){
+      self->Cursor = 0;
+      self->Parse = PARSE_HEADER1;
+      self->DeadlineTicks = TimManger::GetInstance().NowTicks() + self->TimeoutTicks;
+      self->Phase = PHASE_RECEIVING;
+   }else{
+      next = self->FinishLocked(finished);
+   }
+   __enable_irq();
+
+   if(finished != nullptr){
+      self->Complete(finished, next);
+   }
+}
+
+/**
+ * @brief 接收事件回调,在串口接收中断中调用
+ * @details 就地读取接收环形缓冲区,逐字节解析后释放
+ * @param ctx 调度器
+ * @param size 新到达的字节数
+ */
+void BusServoBus::OnRxEvent(void* ctx, uint16_t size){
+   (void)size;
+   BusServoBus* self = static_cast<BusServoBus*>(ctx);
+   const uint8_t* data = nullptr;
+   while(true){
+      BspResult<uint32_t> span = self->Port.PeekRx(data);
+      if(!span.ok() || span.value == 0){
+         break;
+      }
+      for(uint32_t i = 0; i < span.value; i++){
+         self->ParseByte(data[i]);
+      }
+      self->Port.ReleaseRx(span.value);
+   }
+}
+
+/**
+ * @brief 节拍定时器回调,检查当前舵机的应答是否超时
+ * @details 超时的舵机计数后转向下一个舵机,最后一个舵机超时时结束批次并启动下一批
+ * @param ctx 调度器
+ */
+void BusServoBus::OnTick(void* ctx){
+   BusServoBus* self = static_cast<BusServoBus*>(ctx);
+   if(self->Phase != PHASE_RECEIVING){
+      return;
+   }
+
+   BusServoBatch* finished = nullptr;
+   BatchSlot* next = nullptr;
+   __disable_irq();
+   uint32_t now = TimManger::GetInstance().NowTicks();
+   if(self->Phase != PHASE_RECEIVING || (int32_t)(now - self->DeadlineTicks) < 0){
+      __enable_irq();
+      return;
+   }
+   self->Stats.timeouts++;
+   self->Cursor++;
+   self->Parse = PARSE_HEADER1;
+   if(self->Cursor < self->Slots[self->QueueHead].batch->count){
+      self->DeadlineTicks = now + self->TimeoutTicks;
+   }else{
+      next = self->FinishLocked(finished);
+   }
+   __enable_irq();
+
+   if(finished != nullptr){
+      self->Complete(finished, next);
+   }
+}
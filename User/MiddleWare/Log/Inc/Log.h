@@ -30,28 +30,112 @@ extern "C" {
 #endif
 
 #ifdef __cplusplus
+
+// 延迟日志模式: 为 1 时 LOG_INFO/WARN/ERROR 不在目标端格式化,
+// 只发送 格式串ID + 时间戳 + 参数原始字节,由 Tools/log_decode.py 在主机端还原
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 0
+#endif
+
+// 延迟日志记录: 格式串只能是字符串字面量,ID 在编译期由格式串的 FNV-1a 哈希得到,
+// 主机端的 Tools/log_ids.py 扫描源码用同样的哈希生成 ID 表。
+// sizeof 里的 printf 不会执行,只让编译器照常检查格式串与参数是否匹配。
+// Usage: LOG_DEFER(LogLevel::Info, "speed %d rpm, err %f", rpm, err);
+#define LOG_DEFER(level, fmt, ...) \
+  do { (void)sizeof(printf(fmt, ##__VA_ARGS__)); Log::Defer<LogFmtId(fmt)>(level, ##__VA_ARGS__); } while (0)
+
 // Log Macros
 // Usage: LOG_INFO("System Ready, ID: %d", 1);
+#if LOG_DEFERRED
+#define LOG_INFO(fmt, ...)  LOG_DEFER(LogLevel::Info, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_DEFER(LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_DEFER(LogLevel::Error, fmt, ##__VA_ARGS__)
+#else
 #define LOG_INFO(fmt, ...)  Log::GetInstance().Print(ANSI_B_GREEN "[INFO] " ANSI_RESET fmt "\r\n", ##__VA_ARGS__)
 #define LOG_WARN(fmt, ...)  Log::GetInstance().Print(ANSI_B_YELLOW "[WARN] " ANSI_RESET fmt "\r\n", ##__VA_ARGS__)
 #define LOG_ERROR(fmt, ...) Log::GetInstance().Print(ANSI_B_RED   "[ERROR] " ANSI_RESET fmt "\r\n", ##__VA_ARGS__)
+#endif
 
 
 // Raw Printf with color
 #define LOG_COLOR(color, fmt, ...) Printf(color fmt ANSI_RESET, ##__VA_ARGS__)
 
 
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
 #include "common_inc.h"
 #include "BspUart.h"
 
 static const uint8_t LOG_CMD_LIST_SIZE = 16;
 
+// 日志记录环形缓冲区的大小,每条记录只占 2 字节长度 + 实际文本长度
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 2048U
+#endif
+
+// LogTask 的栈深度(字),栈和控制块都是静态分配
+#ifndef LOG_TASK_STACK_WORDS
+#define LOG_TASK_STACK_WORDS 1024U
+#endif
+
+// 单条延迟日志参数的字节上限,超出的参数不发送,记录带截断标记
+#ifndef LOG_DEFER_MAX_ARGS
+#define LOG_DEFER_MAX_ARGS 32U
+#endif
+
+// 延迟日志 %s 参数最多拷贝的字节数,字符串在调用时拷贝,之后可以被修改
+#ifndef LOG_DEFER_STR_MAX
+#define LOG_DEFER_STR_MAX 16U
+#endif
+
+// 延迟日志帧: [LOG_FRAME_SYNC][长度][等级][ID 4字节][时间戳 4字节][参数...][CRC-8/MAXIM],多字节均为小端
+#define LOG_FRAME_SYNC 0xA5U
+
+// 延迟日志的等级,最高位表示参数被截断
+enum class LogLevel : uint8_t
+{
+  Raw = 0,
+  Info = 1,
+  Warn = 2,
+  Error = 3,
+};
+static constexpr uint8_t LOG_LEVEL_TRUNCATED = 0x80U;
+
+// 格式串ID: 字符串字面量的 32 位 FNV-1a 哈希,与 Tools/log_ids.py 的 fnv1a 一致
+constexpr uint32_t LogFmtId(const char* fmt)
+{
+  uint32_t h = 2166136261U;
+  while (*fmt != '\0')
+  {
+    h = (h ^ (uint8_t)*fmt++) * 16777619U;
+  }
+  return h;
+}
+
 struct VofaCmdTypedef
 {
   float *controlData_float; 
   const char *dataName;
 };
 
+// 环形缓冲区放不下新消息时的处理方式
+enum class LogDropPolicy : uint8_t
+{
+  DropNewest, // 丢弃新消息,保留已经排队的日志(默认)
+  DropOldest, // 丢弃最旧的消息腾出空间,保留最新的日志
+};
+
+// 日志统计,由 Log::GetStats 获取
+struct LogStats
+{
+  uint32_t messages = 0;     // 成功写入的消息数
+  uint32_t dropped = 0;      // 被丢弃的消息数(按丢弃策略,新的或旧的)
+  uint32_t droppedBytes = 0; // 被丢弃消息的文本字节数
+  uint32_t truncated = 0;    // 超过 LOG_MSG_MAX_SIZE 被截断的消息数
+  uint32_t highWater = 0;    // 环形缓冲区占用的最大字节数
+};
+
 class Log
 {
 private:
@@ -61,10 +145,90 @@ private:
 
   static void LogTask(void *arg);
   static constexpr size_t LOG_MSG_MAX_SIZE = 128;
+  static_assert(LOG_RING_SIZE >= 4U * (LOG_MSG_MAX_SIZE + 2U), "LOG_RING_SIZE must hold several full-size messages");
+  static constexpr uint32_t LOG_DEFER_HEADER = 9; // 等级 + ID + 时间戳
+  static constexpr uint16_t LOG_RECORD_BINARY = 0x8000; // 记录头的最高位: 延迟日志记录
+  static constexpr uint16_t LOG_RECORD_BUSY = 0x4000;   // 记录头的次高位: 已预留、正在拷贝
+  static constexpr uint16_t LOG_RECORD_LEN_MASK = 0x3FFF;
+  static_assert(LOG_DEFER_HEADER + LOG_DEFER_MAX_ARGS <= LOG_MSG_MAX_SIZE, "LOG_DEFER_MAX_ARGS too large for a frame");
 
   VofaCmdTypedef cmdList[LOG_CMD_LIST_SIZE] = {0};
-  static QueueHandle_t logQueue;
+  static TaskHandle_t logTask;
   void HandleCommand(char* cmdStr);
+
+  // 变长记录环形缓冲区: [2字节长度][文本],放不下时在末尾写回绕标记从头开始
+  // 关中断只用于预留和提交,记录内容在临界区外拷入拷出
+  uint8_t ring[LOG_RING_SIZE] = {0};
+  uint32_t ringHead = 0;   // 下一条记录的写入位置
+  uint32_t ringTail = 0;   // 最旧一条记录的位置
+  uint32_t ringUsed = 0;   // 占用的字节数,包含回绕浪费的末尾
+  bool ringReading = false; // LogTask 正在拷出最旧的记录
+  bool ringStalled = false; // LogTask 因最旧的记录还在写入而停下,提交时需要唤醒
+  LogDropPolicy dropPolicy = LogDropPolicy::DropNewest;
+  LogStats stats;
+  bool PushRecord(const void* data, uint16_t len, bool binary); // 写入一条记录,返回是否需要唤醒 LogTask
+  bool ReserveRecord(uint16_t len, bool binary, uint32_t& pos, bool& wasEmpty); // 关中断预留一条记录的空间
+  bool CommitRecord(uint32_t pos, bool wasEmpty); // 清除占用标记,返回是否需要唤醒 LogTask
+  bool DropRecord();       // 关中断时调用,丢弃最旧的一条记录,记录正在写入或读出时返回 false
+  uint16_t PopRecord(uint8_t* out, bool& binary); // 取出最旧的一条记录,没有或还在写入时返回 0
+  static void Wake();      // 唤醒 LogTask,任务和中断中都可以调用
+  uint8_t txLine[LOG_MSG_MAX_SIZE + 3] = {0}; // 发送缓冲,延迟日志在前后加帧头和校验,只在 LogTask 中访问
+
+  static bool PackBytes(uint8_t* rec, uint32_t& n, const void* data, uint32_t len)
+  {
+    if (n + len > LOG_DEFER_HEADER + LOG_DEFER_MAX_ARGS) return false;
+    memcpy(&rec[n], data, len);
+    n += len;
+    return true;
+  }
+
+  // 整数不超过 32 位时按 4 字节发送(与 printf 的整数提升一致),64 位按 8 字节
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, bool>::type
+  PackArg(uint8_t* rec, uint32_t& n, T v)
+  {
+    if (sizeof(T) > 4U)
+    {
+      uint64_t u = (uint64_t)v;
+      return PackBytes(rec, n, &u, 8);
+    }
+    uint32_t u = (uint32_t)v;
+    return PackBytes(rec, n, &u, 4);
+  }
+
+  // 浮点按 float 发送,主机端按 %f/%e/%g 解码
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+  PackArg(uint8_t* rec, uint32_t& n, T v)
+  {
+    float f = (float)v;
+    return PackBytes(rec, n, &f, 4);
+  }
+
+  // 字符串按 [长度][字节] 拷贝,最多 LOG_DEFER_STR_MAX 字节
+  static bool PackArg(uint8_t* rec, uint32_t& n, const char* s)
+  {
+    uint8_t len = 0;
+    if (s != nullptr)
+    {
+      while (len < LOG_DEFER_STR_MAX && s[len] != '\0') len++;
+    }
+    return PackBytes(rec, n, &len, 1) && PackBytes(rec, n, s, len);
+  }
+  static bool PackArg(uint8_t* rec, uint32_t& n, char* s) { return PackArg(rec, n, (const char*)s); }
+
+  // 其他指针按 %p 发送地址
+  template <typename T>
+  static bool PackArg(uint8_t* rec, uint32_t& n, T* p)
+  {
+    uint32_t u = (uint32_t)(uintptr_t)p;
+    return PackBytes(rec, n, &u, 4);
+  }
+
+  char rxLine[32] = {0};   // 命令行累加缓冲区,只在 LogTask 中访问
+  uint8_t rxLineLen = 0;
+  void PollRx();           // 在任务中解析DMA环形缓冲区中的新数据
+  void FlushRxLine();      // 处理累加的一行命令
   Uart* debugUart = nullptr; // 内部还是存指针比较方便，因为引用必须在构造时初始化
 public:
 
@@ -78,7 +242,33 @@ public:
   static void ProcessRxData(uint8_t* data, uint16_t len);
 
   static void Init(Uart& uartInstance);
-  static void Print(const char* fmt, ...);
+  static void Print(const char* fmt, ...); // 只能在任务中调用,不使用堆
+
+  // 写入一条延迟日志,不格式化,任务和中断中都可以调用。通过 LOG_DEFER 使用,Id 由 LogFmtId 在编译期计算
+  template <uint32_t Id, typename... Args>
+  static void Defer(LogLevel level, Args... args)
+  {
+    uint8_t rec[LOG_DEFER_HEADER + LOG_DEFER_MAX_ARGS];
+    uint32_t id = Id;
+    uint32_t ts = DWT->CYCCNT; // 时间戳为 DWT 周期,主机端按主频换算并处理回绕
+    rec[0] = (uint8_t)level;
+    memcpy(&rec[1], &id, 4);
+    memcpy(&rec[5], &ts, 4);
+
+    uint32_t n = LOG_DEFER_HEADER;
+    bool fit = true;
+    int expand[] = {0, (fit = fit && PackArg(rec, n, args), 0)...}; // 放不下之后的参数都不再写入
+    (void)expand;
+    if (!fit) rec[0] |= LOG_LEVEL_TRUNCATED;
+
+    if (GetInstance().PushRecord(rec, (uint16_t)n, true))
+    {
+      Wake();
+    }
+  }
+
+  static void SetDropPolicy(LogDropPolicy policy);
+  static LogStats GetStats();
   
 };
 
@@ -4,8 +4,15 @@
 #include <cstring>
 #include <cstdlib>
 #include "BspUart.h"
+#include "BspCrc.h"
+
+TaskHandle_t Log::logTask = nullptr;
+static StaticTask_t logTaskTcb;
+static StackType_t logTaskStack[LOG_TASK_STACK_WORDS];
+
+// 记录头为 2 字节长度,回绕标记表示本条之后到缓冲区末尾都是空的
+static constexpr uint16_t LOG_WRAP_MARK = 0xFFFF;
 
-QueueHandle_t Log::logQueue = nullptr;
 Log& Log::GetInstance()
 {
     static Log instance;
@@ -13,66 +20,268 @@ Log& Log::GetInstance()
 }
 void Log::Init(Uart& uartInstance)
 {
-  if (logQueue != nullptr) return; // 防止重复初始化
+  if (logTask != nullptr) return; // 防止重复初始化
 
   Log& instance = GetInstance();
   instance.debugUart = &uartInstance; // 取地址保存
 
   instance.debugUart->Init(115200); // 初始化UART波特率
-  instance.debugUart->EnableRxDMA(false); // 启用DMA接收
 
-  instance.debugUart->SetRxCallback([](uint16_t dmaCurrentPos)
+  // 中断里只唤醒 LogTask,数据留在DMA环形缓冲区中由任务就地解析
+  instance.debugUart->SetRxCallback([](uint16_t newBytes)
   {
-    uint8_t rxData[64] = {0};
-    auto receiveResult = Log::GetInstance().debugUart->ReceiveData(rxData, dmaCurrentPos);
-    
-    // 确保字符串以 \0 结尾，防止 strtof 越界
-    rxData[receiveResult.value] = '\0';
-
-    Log::ProcessRxData(rxData, receiveResult.value);
+    (void)newBytes;
+    Wake();
   }); // 设置接收回调
 
-  logQueue = xQueueCreate(20, sizeof(char*)); // 创建日志队列
-  xTaskCreate(LogTask, "LogTask", 1024, nullptr, osPriorityBelowNormal, nullptr);
+  instance.debugUart->EnableRxDMA(); // 启用环形DMA接收
+  logTask = xTaskCreateStatic(LogTask, "LogTask", LOG_TASK_STACK_WORDS, nullptr, osPriorityBelowNormal,
+                              logTaskStack, &logTaskTcb);
 
 }
 
 void Log::Print(const char* fmt, ...)
 {
-  if (logQueue == nullptr) return; // 未初始化日志系统
+  if (logTask == nullptr) return; // 未初始化日志系统
 
-  // 格式化日志消息
-  char* logMsg = (char*)pvPortMalloc(LOG_MSG_MAX_SIZE); // 分配内存
-  if (logMsg == nullptr) return; // 内存分配失败
+  // 先在栈上格式化,再按实际长度写入环形缓冲区
+  char logMsg[LOG_MSG_MAX_SIZE];
 
   va_list args;
   va_start(args, fmt);
-  vsnprintf(logMsg, LOG_MSG_MAX_SIZE, fmt, args);
+  int len = vsnprintf(logMsg, LOG_MSG_MAX_SIZE, fmt, args);
   va_end(args);
+  if (len <= 0) return;
+
+  Log& instance = GetInstance();
+  if ((size_t)len >= LOG_MSG_MAX_SIZE)
+  {
+    len = LOG_MSG_MAX_SIZE - 1;
+    __disable_irq();
+    instance.stats.truncated++;
+    __enable_irq();
+  }
+
+  if (instance.PushRecord(logMsg, (uint16_t)len, false))
+  {
+    Wake();
+  }
+}
 
-  // 将日志消息发送到队列
-  if (xQueueSend(logQueue, &logMsg, 0) != pdPASS) 
+void Log::Wake()
+{
+  if (logTask == nullptr) return;
+  if (__get_IPSR() != 0U)
   {
-    vPortFree(logMsg); // 队列满则丢弃并释放
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(logTask, &woken);
+    portYIELD_FROM_ISR(woken);
   }
+  else
+  {
+    xTaskNotifyGive(logTask);
+  }
+}
+
+void Log::SetDropPolicy(LogDropPolicy policy)
+{
+  GetInstance().dropPolicy = policy;
+}
+
+LogStats Log::GetStats()
+{
+  Log& instance = GetInstance();
+  __disable_irq();
+  LogStats copy = instance.stats;
+  __enable_irq();
+  return copy;
+}
+
+bool Log::PushRecord(const void* data, uint16_t len, bool binary)
+{
+  uint32_t pos = 0;
+  bool wasEmpty = false;
+  if (!ReserveRecord(len, binary, pos, wasEmpty)) return false;
+
+  // 拷贝在临界区外,记录头带占用标记,LogTask 和丢弃最旧策略都不会越过这条记录
+  memcpy(&ring[pos + 2], data, len);
+  return CommitRecord(pos, wasEmpty);
+}
+
+bool Log::ReserveRecord(uint16_t len, bool binary, uint32_t& pos, bool& wasEmpty)
+{
+  const uint32_t need = 2U + len;
+
+  for (;;)
+  {
+    __disable_irq();
+    // LogTask 每次被唤醒都会取空缓冲区,只有从空变为非空时才需要唤醒,省掉大部分通知的开销
+    wasEmpty = (ringUsed == 0);
+    if (ringUsed == 0)
+    {
+      // 空的时候从头开始,整个缓冲区都是连续的
+      ringHead = 0;
+      ringTail = 0;
+    }
+
+    bool fits = false;
+    uint32_t free = LOG_RING_SIZE - ringUsed;
+    if (ringHead >= ringTail && ringUsed < LOG_RING_SIZE)
+    {
+      uint32_t toEnd = LOG_RING_SIZE - ringHead;
+      if (need <= toEnd)
+      {
+        fits = true;
+      }
+      else if (need <= free - toEnd)
+      {
+        // 末尾放不下,浪费末尾从头开始,头部必须放得下
+        if (toEnd >= 2U)
+        {
+          ring[ringHead] = (uint8_t)(LOG_WRAP_MARK & 0xFF);
+          ring[ringHead + 1] = (uint8_t)(LOG_WRAP_MARK >> 8);
+        }
+        ringUsed += toEnd;
+        ringHead = 0;
+        fits = true;
+      }
+    }
+    else if (need <= free)
+    {
+      fits = true; // 写入位置在读取位置之前,空闲区间是连续的
+    }
+
+    if (fits)
+    {
+      pos = ringHead;
+      uint16_t header = (uint16_t)(len | LOG_RECORD_BUSY | (binary ? LOG_RECORD_BINARY : 0U));
+      ring[pos] = (uint8_t)(header & 0xFF);
+      ring[pos + 1] = (uint8_t)(header >> 8);
+      ringHead += need;
+      if (ringHead == LOG_RING_SIZE) ringHead = 0;
+      ringUsed += need;
+      stats.messages++;
+      if (ringUsed > stats.highWater) stats.highWater = ringUsed;
+      __enable_irq();
+      return true;
+    }
+
+    // 每次临界区最多丢弃一条最旧的记录,关中断时间与需要丢弃的条数无关
+    if (dropPolicy == LogDropPolicy::DropNewest || !DropRecord())
+    {
+      stats.dropped++;
+      stats.droppedBytes += len;
+      __enable_irq();
+      return false;
+    }
+    __enable_irq();
+  }
+}
+
+bool Log::CommitRecord(uint32_t pos, bool wasEmpty)
+{
+  __disable_irq();
+  ring[pos + 1] = (uint8_t)(ring[pos + 1] & ~(LOG_RECORD_BUSY >> 8));
+  // LogTask 停在这条(或更早的)未完成记录上时也要唤醒
+  bool wake = wasEmpty || ringStalled;
+  ringStalled = false;
+  __enable_irq();
+  return wake;
+}
+
+bool Log::DropRecord()
+{
+  // 末尾不足一个记录头或者是回绕标记时,跳过末尾
+  uint32_t toEnd = LOG_RING_SIZE - ringTail;
+  if (toEnd < 2U || (ring[ringTail] | (ring[ringTail + 1] << 8)) == LOG_WRAP_MARK)
+  {
+    ringUsed -= toEnd;
+    ringTail = 0;
+    return true;
+  }
+
+  // 正在写入或正在被 LogTask 拷出的记录不能回收
+  uint16_t header = (uint16_t)(ring[ringTail] | (ring[ringTail + 1] << 8));
+  if (ringReading || (header & LOG_RECORD_BUSY) != 0) return false;
+
+  uint16_t len = (uint16_t)(header & LOG_RECORD_LEN_MASK);
+  ringTail += 2U + len;
+  if (ringTail == LOG_RING_SIZE) ringTail = 0;
+  ringUsed -= 2U + len;
+  stats.dropped++;
+  stats.droppedBytes += len;
+  return true;
+}
+
+uint16_t Log::PopRecord(uint8_t* out, bool& binary)
+{
+  __disable_irq();
+  if (ringUsed != 0)
+  {
+    uint32_t toEnd = LOG_RING_SIZE - ringTail;
+    if (toEnd < 2U || (ring[ringTail] | (ring[ringTail + 1] << 8)) == LOG_WRAP_MARK)
+    {
+      ringUsed -= toEnd;
+      ringTail = 0;
+    }
+  }
+  if (ringUsed == 0)
+  {
+    __enable_irq();
+    return 0;
+  }
+
+  uint32_t pos = ringTail;
+  uint16_t header = (uint16_t)(ring[pos] | (ring[pos + 1] << 8));
+  if ((header & LOG_RECORD_BUSY) != 0)
+  {
+    // 最旧的记录还在写入,写完时由 CommitRecord 唤醒
+    ringStalled = true;
+    __enable_irq();
+    return 0;
+  }
+  ringReading = true;
+  __enable_irq();
+
+  // 在临界区外拷出,拷贝期间丢弃最旧策略不会回收这条记录
+  uint16_t len = (uint16_t)(header & LOG_RECORD_LEN_MASK);
+  binary = (header & LOG_RECORD_BINARY) != 0;
+  memcpy(out, &ring[pos + 2], len);
+
+  __disable_irq();
+  ringTail = pos + 2U + len;
+  if (ringTail == LOG_RING_SIZE) ringTail = 0;
+  ringUsed -= 2U + len;
+  ringReading = false;
+  __enable_irq();
+  return len;
 }
 
 void Log::LogTask(void *arg)
 {
-  char* logMsg = nullptr;
+  (void)arg;
+  Log& instance = Log::GetInstance();
 
   for (;;) 
   {
-    // 等待日志消息
-    if (xQueueReceive(logQueue, &logMsg, portMAX_DELAY) == pdPASS) 
+    // 先发完所有排队的日志,再处理接收,最后等待下一次通知
+    uint16_t len = 0;
+    bool binary = false;
+    while ((len = instance.PopRecord(&instance.txLine[2], binary)) > 0)
     {
-      if (logMsg != nullptr)
+      if (!binary)
       {
-        // 通过UART发送日志消息
-        Log::GetInstance().debugUart->SendData((uint8_t*)logMsg, strlen(logMsg));
+        instance.debugUart->SendData(&instance.txLine[2], len);
+        continue;
       }
-      vPortFree(logMsg); // 释放内存
+      // 延迟日志在发送时才加帧头和校验,写日志的一方只做拷贝
+      instance.txLine[0] = LOG_FRAME_SYNC;
+      instance.txLine[1] = (uint8_t)len;
+      instance.txLine[2 + len] = Crc::Crc8Maxim(&instance.txLine[1], len + 1U, 0x00);
+      instance.debugUart->SendData(instance.txLine, len + 3U);
     }
+    instance.PollRx();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
   }
 }
 
@@ -99,6 +308,45 @@ void Log::RegisterData_Vofa(const char* name, float* data)
 
 
 
+void Log::PollRx()
+{
+  const uint8_t* span = nullptr;
+  uint32_t len = 0;
+
+  // 逐段读取环形缓冲区,回绕处分为两段
+  while ((len = debugUart->PeekRx(span).value) > 0)
+  {
+    for (uint32_t i = 0; i < len; i++)
+    {
+      char c = (char)span[i];
+      if (c == '\n' || c == '\r')
+      {
+        FlushRxLine();
+      }
+      else if (rxLineLen < sizeof(rxLine) - 1)
+      {
+        rxLine[rxLineLen++] = c;
+      }
+    }
+    debugUart->ReleaseRx(len);
+  }
+
+  // 总线空闲说明一帧已经结束,没有换行符的命令也在这里处理
+  if (debugUart->IsRxIdle())
+  {
+    FlushRxLine();
+  }
+}
+
+void Log::FlushRxLine()
+{
+  if (rxLineLen == 0) return;
+
+  rxLine[rxLineLen] = '\0'; // 确保字符串以 \0 结尾，防止 strtof 越界
+  ProcessRxData((uint8_t*)rxLine, rxLineLen);
+  rxLineLen = 0;
+}
+
 void Log::ProcessRxData(uint8_t* data, uint16_t len)
 {
   auto& instance = GetInstance();
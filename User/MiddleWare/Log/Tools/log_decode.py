@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+@file      log_decode.py
+@brief     延迟日志的主机端解码工具
+
+从串口或文件读取调试串口的字节流:
+普通文本(Log::Print)原样输出;延迟日志帧按 ID 表还原格式串,
+用帧中的参数字节格式化,加上时间戳与等级颜色后输出。
+
+帧格式(与 Log.h 一致,多字节均为小端):
+    [0xA5][长度 N][等级][ID 4字节][时间戳 4字节][参数 N-9 字节][CRC-8/MAXIM(长度+负载)]
+
+用法:
+    python log_decode.py --table build/Keil/log_ids.json --port COM5
+    python log_decode.py --src User capture.bin
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+import log_ids
+
+FRAME_SYNC = 0xA5
+HEADER_LEN = 9
+LEVEL_TRUNCATED = 0x80
+LEVELS = {
+    0: '',
+    1: '\033[1;32m[INFO] \033[0m',
+    2: '\033[1;33m[WARN] \033[0m',
+    3: '\033[1;31m[ERROR] \033[0m',
+}
+
+_SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcsp%])')
+
+
+def _crc8_maxim_table():
+    table = []
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8C if crc & 1 else crc >> 1
+        table.append(crc)
+    return table
+
+
+_CRC8 = _crc8_maxim_table()
+
+
+def crc8_maxim(data, crc=0):
+    for b in data:
+        crc = _CRC8[crc ^ b]
+    return crc
+
+
+class ArgReader:
+    """按目标端 Log::PackArg 的规则读取参数"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise IndexError
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def int32(self, signed):
+        return struct.unpack('<i' if signed else '<I', self.take(4))[0]
+
+    def int64(self, signed):
+        return struct.unpack('<q' if signed else '<Q', self.take(8))[0]
+
+    def float32(self):
+        return struct.unpack('<f', self.take(4))[0]
+
+    def string(self):
+        n = self.take(1)[0]
+        return self.take(n).decode('utf-8', 'replace')
+
+
+def render(fmt, args):
+    """用参数字节格式化 printf 风格的格式串,参数不足时以 <?> 结束"""
+    reader = ArgReader(args)
+    out = []
+    pos = 0
+    try:
+        for m in _SPEC.finditer(fmt):
+            out.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, prec, length, conv = m.groups()
+            if conv == '%':
+                out.append('%')
+                continue
+            if width == '*':
+                width = str(reader.int32(True))
+            if prec == '*':
+                prec = str(reader.int32(True))
+            spec = '%' + flags + (width or '') + ('.' + prec if prec is not None else '')
+            wide = length in ('ll', 'j') and conv not in 'eEfFgGaAcsp'
+            if conv in 'di':
+                value = reader.int64(True) if wide else reader.int32(True)
+                out.append((spec + 'd') % value)
+            elif conv in 'ouxX':
+                value = reader.int64(False) if wide else reader.int32(False)
+                out.append((spec + conv) % value)
+            elif conv in 'eEfFgG':
+                out.append((spec + conv) % reader.float32())
+            elif conv in 'aA':
+                out.append(float.hex(reader.float32()))
+            elif conv == 'c':
+                out.append((spec + 'c') % chr(reader.int32(False) & 0xFF))
+            elif conv == 's':
+                out.append((spec + 's') % reader.string())
+            elif conv == 'p':
+                out.append('0x%08x' % reader.int32(False))
+        out.append(fmt[pos:])
+    except IndexError:
+        out.append('<?>')
+    return ''.join(out)
+
+
+class Decoder:
+    """字节流状态机: 帧之外的字节按文本输出,帧校验失败时其首字节也按文本处理"""
+
+    def __init__(self, table, cpu_mhz, color, write):
+        self.table = table
+        self.cpu_hz = cpu_mhz * 1e6
+        self.color = color
+        self.write = write
+        self.buf = bytearray()
+        self.text = bytearray()
+        self.last_cycles = None
+        self.epoch = 0
+
+    def feed(self, data):
+        self.buf += data
+        while self.buf:
+            if self.buf[0] != FRAME_SYNC:
+                self._text_byte(self.buf.pop(0))
+                continue
+            if len(self.buf) < 2:
+                return
+            n = self.buf[1]
+            if n < HEADER_LEN:
+                self._text_byte(self.buf.pop(0))
+                continue
+            if len(self.buf) < n + 3:
+                return
+            frame = bytes(self.buf[:n + 3])
+            if crc8_maxim(frame[1:n + 2]) != frame[n + 2]:
+                self._text_byte(self.buf.pop(0))
+                continue
+            del self.buf[:n + 3]
+            self._flush_text()
+            self._record(frame[2:n + 2])
+
+    def _text_byte(self, b):
+        self.text.append(b)
+        if b == 0x0A:
+            self._flush_text()
+
+    def _flush_text(self):
+        if self.text:
+            self.write(self.text.decode('utf-8', 'replace'))
+            self.text.clear()
+
+    def _seconds(self, cycles):
+        # DWT 周期计数 32 位回绕,180MHz 时约 23.8s 一圈,两条日志之间超过一圈时无法区分
+        if self.last_cycles is not None and cycles < self.last_cycles:
+            self.epoch += 1 << 32
+        self.last_cycles = cycles
+        return (self.epoch + cycles) / self.cpu_hz
+
+    def _record(self, payload):
+        level, fid, cycles = struct.unpack('<BII', payload[:HEADER_LEN])
+        truncated = bool(level & LEVEL_TRUNCATED)
+        prefix = LEVELS.get(level & 0x7F, '')
+        if not self.color:
+            prefix = re.sub(r'\033\[[0-9;]*m', '', prefix)
+        entry = self.table.get(fid)
+        if entry is None:
+            text = '<unknown format 0x%08X, %d arg bytes>' % (fid, len(payload) - HEADER_LEN)
+        else:
+            text = render(entry['fmt'], payload[HEADER_LEN:])
+        if truncated:
+            text += ' <truncated>'
+        self.write('[%12.6f] %s%s\n' % (self._seconds(cycles), prefix, text.rstrip('\r\n')))
+
+
+def load_table(path, src_roots):
+    if path:
+        with open(path, encoding='utf-8') as f:
+            return {int(k, 16): v for k, v in json.load(f).items()}
+    table, collisions = log_ids.build_table(src_roots)
+    for c in collisions:
+        print('log_decode: ID collision ' + c, file=sys.stderr)
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the deferred log stream from the debug UART')
+    parser.add_argument('input', nargs='?', default='-', help='captured byte stream file, - for stdin')
+    parser.add_argument('--table', help='ID table generated by log_ids.py')
+    parser.add_argument('--src', action='append', help='scan sources instead of loading --table (repeatable)')
+    parser.add_argument('--port', help='read from a serial port (needs pyserial)')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--cpu-mhz', type=float, default=180.0, help='core clock for DWT timestamps')
+    parser.add_argument('--no-color', action='store_true')
+    args = parser.parse_args()
+
+    if not args.table and not args.src:
+        parser.error('one of --table or --src is required')
+    table = load_table(args.table, args.src)
+
+    def write(s):
+        sys.stdout.write(s)
+        sys.stdout.flush()
+
+    decoder = Decoder(table, args.cpu_mhz, not args.no_color, write)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                decoder.feed(port.read(4096))
+    else:
+        stream = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb')
+        with stream:
+            while True:
+                chunk = stream.read(4096)
+                if not chunk:
+                    break
+                decoder.feed(chunk)
+        decoder._flush_text()
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,13 @@
+@echo off
+rem Keil Before Build step for the deferred log ID table.
+rem Without Python the step only warns and returns 0, so the build goes on
+rem with the old log_ids.json. A format-string ID collision makes log_ids.py
+rem return 2 and fails the build.
+
+where python >nul 2>nul
+if errorlevel 1 (
+  echo log_ids: warning: python not found, log_ids.json was not updated
+  exit /b 0
+)
+python "%~dp0log_ids.py" %*
+exit /b %errorlevel%
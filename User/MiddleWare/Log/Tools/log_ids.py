@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""
+@file      log_ids.py
+@brief     延迟日志的格式串ID表生成工具
+
+扫描源码中 LOG_INFO / LOG_WARN / LOG_ERROR / LOG_DEFER 的格式串字面量,
+按与 Log.h 中 LogFmtId 相同的 32 位 FNV-1a 哈希生成 ID 表(JSON)。
+由 Keil 的 Before Build 通过 log_ids.bat 运行:ID 冲突时打印冲突的格式串并返回
+EXIT_COLLISION,构建失败;没有安装 Python 时 log_ids.bat 只给出警告,构建继续,
+ID 表不会更新。
+
+用法:
+    python log_ids.py --root User --out build/Keil/log_ids.json
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+LOG_MACROS = ("LOG_INFO", "LOG_WARN", "LOG_ERROR", "LOG_DEFER")
+SOURCE_EXTS = (".c", ".cpp", ".h", ".hpp")
+EXIT_COLLISION = 2
+
+# 注释与字面量一起匹配,保证字符串里的 // 和 /* 不会被当作注释
+_COMMENT_OR_LITERAL = re.compile(
+    r'//[^\n]*|/\*.*?\*/|\'(?:\\.|[^\\\'\n])*\'|"(?:\\.|[^\\"\n])*"', re.S)
+_MACRO_CALL = re.compile(r'\b(' + '|'.join(LOG_MACROS) + r')\s*\(')
+_STRING = re.compile(r'\s*"((?:\\.|[^\\"\n])*)"')
+
+_SIMPLE_ESCAPES = {
+    'n': 0x0A, 'r': 0x0D, 't': 0x09, '0': 0x00, 'a': 0x07, 'b': 0x08,
+    'f': 0x0C, 'v': 0x0B, '\\': 0x5C, '"': 0x22, '\'': 0x27, '?': 0x3F,
+}
+
+
+def fnv1a(data):
+    """32 位 FNV-1a,与 LogFmtId 一致"""
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def unescape(body):
+    """把 C 字符串字面量的内容转换为编译器生成的字节
+
+    body 按 latin-1 解码,每个字符对应源文件中的一个字节,
+    因此 UTF-8 与 GBK 源文件都按原始字节计算哈希,与编译器一致
+    """
+    out = bytearray()
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c != '\\':
+            out += c.encode('latin-1')
+            i += 1
+            continue
+        i += 1
+        e = body[i]
+        if e == 'x':
+            m = re.match(r'[0-9a-fA-F]+', body[i + 1:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif e in '01234567':
+            m = re.match(r'[0-7]{1,3}', body[i:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += len(m.group(0))
+        else:
+            out.append(_SIMPLE_ESCAPES.get(e, ord(e)))
+            i += 1
+    return bytes(out)
+
+
+def _strip_comments(text):
+    """注释替换为等长的空白,保留行号"""
+    def repl(m):
+        s = m.group(0)
+        if s.startswith('/'):
+            return re.sub(r'[^\n]', ' ', s)
+        return s
+    return _COMMENT_OR_LITERAL.sub(repl, text)
+
+
+def _skip_argument(text, pos):
+    """跳过一个宏参数,返回其后逗号之后的位置,找不到时返回 None"""
+    depth = 0
+    while pos < len(text):
+        c = text[pos]
+        if c == '"' or c == '\'':
+            m = _COMMENT_OR_LITERAL.match(text, pos)
+            pos = m.end() if m else pos + 1
+            continue
+        if c in '([{':
+            depth += 1
+        elif c in ')]}':
+            if depth == 0:
+                return None
+            depth -= 1
+        elif c == ',' and depth == 0:
+            return pos + 1
+        pos += 1
+    return None
+
+
+def scan_file(path):
+    """返回 [(格式串字节, 行号)],格式串不是字面量(例如宏定义本身)的调用被跳过"""
+    with open(path, 'rb') as f:
+        text = _strip_comments(f.read().decode('latin-1'))
+
+    found = []
+    for m in _MACRO_CALL.finditer(text):
+        pos = m.end()
+        if m.group(1) == 'LOG_DEFER':
+            pos = _skip_argument(text, pos)
+            if pos is None:
+                continue
+        # 相邻的字符串字面量由编译器拼接
+        parts = []
+        while True:
+            s = _STRING.match(text, pos)
+            if not s:
+                break
+            parts.append(s.group(1))
+            pos = s.end()
+        if not parts:
+            continue
+        fmt = b''.join(unescape(p) for p in parts)
+        found.append((fmt, text.count('\n', 0, m.start()) + 1))
+    return found
+
+
+def build_table(roots):
+    """扫描目录,返回 ({id: 条目}, [冲突描述])"""
+    table = {}
+    raw = {}
+    collisions = []
+    for root in roots:
+        for dirpath, _, files in os.walk(root):
+            for name in sorted(files):
+                if not name.endswith(SOURCE_EXTS):
+                    continue
+                path = os.path.join(dirpath, name)
+                for fmt, line in scan_file(path):
+                    fid = fnv1a(fmt)
+                    where = '%s:%d' % (path.replace('\\', '/'), line)
+                    entry = table.get(fid)
+                    if entry is None:
+                        table[fid] = {'fmt': fmt.decode('utf-8', 'replace'), 'where': [where]}
+                        raw[fid] = fmt
+                    elif raw[fid] == fmt:
+                        entry['where'].append(where)
+                    else:
+                        collisions.append('0x%08X: "%s" (%s) vs "%s" (%s)' % (
+                            fid, entry['fmt'], entry['where'][0], fmt.decode('utf-8', 'replace'), where))
+    return table, collisions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the deferred log format-string ID table')
+    parser.add_argument('--root', action='append', default=None, help='source directory to scan (repeatable)')
+    parser.add_argument('--out', default='log_ids.json', help='output JSON file')
+    args = parser.parse_args()
+
+    roots = args.root or ['User']
+    table, collisions = build_table(roots)
+    if collisions:
+        for c in collisions:
+            print('log_ids: ID collision ' + c, file=sys.stderr)
+        return EXIT_COLLISION
+
+    out_dir = os.path.dirname(args.out)
+    if out_dir:
+        os.makedirs(out_dir, exist_ok=True)
+    with open(args.out, 'w', encoding='utf-8') as f:
+        json.dump({'%08X' % k: v for k, v in sorted(table.items())}, f, ensure_ascii=False, indent=1)
+    print('log_ids: %d format strings -> %s' % (len(table), args.out))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,303 @@
+/*===========================================================
+* @file      MW_FrameParser.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* BspUart.h
+* MW_Common.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 构建在 Uart 环形DMA接收之上的增量帧解析框架
+* 解析器在任务中按段读取接收环形缓冲区,一次处理一整段数据,
+* 同步搜索用 memchr,数据搬运用 memcpy,不在中断中逐字节回调,
+* 完整的帧校验通过后按类型ID查表分发。
+* 1. 声明了 FrameParser 基类，负责分发表、统计和读取 Uart。
+* 2. 声明了 CobsFrameParser 类，以 0x00 分隔的 COBS 帧。
+* 3. 声明了 HeaderFrameParser 类，帧头 + 长度 + CRC 的帧。
+* 4. 定义了 FrameHandler_t 类型，用于处理一种类型的帧。
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+#ifndef MW_FRAMEPARSER_HPP
+#define MW_FRAMEPARSER_HPP
+
+/*========================= 文件依赖 =========================*/
+
+#include "BspUart.h"
+#include "MW_Common.hpp"
+
+/*========================== 宏定义 ==========================*/
+
+/**
+ * @brief 每个解析器最多可以注册的帧类型数量
+ */
+#define FRAME_MAX_HANDLERS 16
+
+/**
+ * @brief 帧尾 CRC16 的字节数
+ */
+#define FRAME_CRC_SIZE 2
+
+/**
+ * @brief 帧校验 CRC16 的初值
+ */
+#define FRAME_CRC_INIT 0xFFFF
+
+/*==================== 帧解析回调类型 ====================*/
+
+/**
+ * @brief 帧处理函数
+ * @param ctx 注册时传入的上下文
+ * @param type 帧类型ID
+ * @param payload 负载数据,只在回调期间有效
+ * @param len 负载长度
+ * @note 在调用 Poll/Feed 的任务中调用
+ */
+typedef void (*FrameHandler_t)(void* ctx, uint8_t type, const uint8_t* payload, uint16_t len);
+
+/**
+ * @brief 帧校验使用的 CRC16 函数
+ * @param init 初值,传入上一段的结果即可按段连续计算,整帧从 FRAME_CRC_INIT 开始
+ */
+typedef uint16_t (*FrameCrc16Fn_t)(const uint8_t* data, uint32_t len, uint16_t init);
+
+/**
+ * @brief 默认的 CRC16 (CRC-16/CCITT-FALSE, 多项式 0x1021, 初值 0xFFFF)
+ */
+uint16_t MW_FrameCrc16(const uint8_t* data, uint32_t len, uint16_t init);
+
+/*==================== 帧解析统计 ====================*/
+
+/**
+ * @brief 帧解析统计
+ */
+struct FrameParserStats
+{
+    uint32_t frames;             /*!< 校验通过并分发的帧数 */
+    uint32_t crcErrors;          /*!< CRC 错误的帧数 */
+    uint32_t lengthErrors;       /*!< 长度非法或超出帧缓冲区的帧数 */
+    uint32_t formatErrors;       /*!< 编码错误的帧数(COBS) */
+    uint32_t unknownTypes;       /*!< 没有注册处理函数的帧数 */
+    uint32_t droppedBytes;       /*!< 同步搜索中丢弃的字节数 */
+};
+
+/*==================== 帧解析基类 ====================*/
+
+/**
+ * @brief 帧解析基类
+ * @details
+ * 1. 帧缓冲区由使用者提供(通常为静态数组),解析器不进行动态内存分配。
+ * 2. 分发表按注册顺序线性查找,类型数量不超过 FRAME_MAX_HANDLERS。
+ * 3. 同一个解析器只能在一个任务中使用。
+ */
+class FrameParser
+{
+public:
+
+    /**
+     * @brief 注册一种帧类型的处理函数,重复注册时替换
+     * @param type 帧类型ID
+     * @param handler 处理函数
+     * @param ctx 透传给处理函数的上下文
+     * @return 注册操作的状态
+     */
+    MW_Status Register(uint8_t type, FrameHandler_t handler, void* ctx);
+
+    /**
+     * @brief 输入一段连续的数据
+     */
+    void Feed(const uint8_t* data, uint32_t len);
+
+    /**
+     * @brief 读取 Uart 接收环形缓冲区中的全部数据并解析
+     * @param uart 已经调用过 EnableRxDMA 的串口
+     * @return 本次处理的字节数
+     */
+    uint32_t Poll(Uart& uart);
+
+    /**
+     * @brief 丢弃未完成的帧,重新开始同步
+     */
+    void Reset();
+
+    /**
+     * @brief 获取解析统计
+     */
+    const FrameParserStats& GetStats() const { return Stats; }
+
+protected:
+
+    /**
+     * @brief 一种帧类型的分发表项
+     */
+    struct HandlerEntry{
+        FrameHandler_t handler;
+        void* ctx;
+        uint8_t type;
+    };
+
+    uint8_t* Buffer;                                /*!< 帧缓冲区 */
+    uint16_t BufferSize;                            /*!< 帧缓冲区大小 */
+    uint16_t Length;                                /*!< 帧缓冲区中的字节数 */
+    FrameCrc16Fn_t Crc;                             /*!< CRC16 函数 */
+    FrameParserStats Stats;                         /*!< 解析统计 */
+    HandlerEntry Handlers[FRAME_MAX_HANDLERS];      /*!< 分发表 */
+    uint8_t HandlerCount;                           /*!< 分发表项数 */
+
+    /**
+     * @brief 构造函数
+     * @param buffer 帧缓冲区
+     * @param size 帧缓冲区大小,至少容纳一个最长的完整帧
+     * @param crc CRC16 函数,为 nullptr 时使用 MW_FrameCrc16
+     */
+    FrameParser(uint8_t* buffer, uint16_t size, FrameCrc16Fn_t crc);
+
+    /**
+     * @brief 析构默认
+     */
+    virtual ~FrameParser() = default;
+
+    /**
+     * @brief 拷贝构造私有
+     */
+    FrameParser(const FrameParser&) = delete;
+
+    /**
+     * @brief 赋值运算私有
+     */
+    FrameParser& operator=(const FrameParser&) = delete;
+
+    /**
+     * @brief 解析一段连续的数据,由派生类实现
+     */
+    virtual void FeedSpan(const uint8_t* data, uint32_t len) = 0;
+
+    /**
+     * @brief 重置派生类的解析状态
+     */
+    virtual void ResetState() = 0;
+
+    /**
+     * @brief 检查帧尾的 CRC16(小端),CRC 覆盖 data 中除最后两个字节外的全部数据
+     */
+    bool CheckCrc(const uint8_t* data, uint16_t len) const;
+
+    /**
+     * @brief 按类型ID查表分发一个校验通过的帧
+     */
+    void Dispatch(uint8_t type, const uint8_t* payload, uint16_t len);
+};
+
+/*==================== COBS 帧解析类 ====================*/
+
+/**
+ * @brief COBS 帧解析类
+ * @details
+ * 线路格式: COBS(类型 | 负载 | CRC16) | 0x00
+ * 1. 0x00 只出现在帧尾,任何时刻从下一个 0x00 之后即可重新同步。
+ * 2. 边接收边解码,每个编码块用一次 memcpy 拷贝,帧缓冲区存放解码后的数据。
+ * 3. CRC16 覆盖类型和负载,小端存放。
+ */
+class CobsFrameParser : public FrameParser
+{
+public:
+
+    /**
+     * @brief 构造函数
+     * @param buffer 帧缓冲区,大小至少为 最大负载 + 3
+     * @param size 帧缓冲区大小
+     * @param crc CRC16 函数,为 nullptr 时使用 MW_FrameCrc16
+     */
+    CobsFrameParser(uint8_t* buffer, uint16_t size, FrameCrc16Fn_t crc = nullptr);
+
+    /**
+     * @brief 把一帧编码成线路格式
+     * @param type 帧类型ID
+     * @param payload 负载
+     * @param len 负载长度
+     * @param out 输出缓冲区,大小至少为 len + 3 + (len + 3) / 254 + 2
+     * @param outSize 输出缓冲区大小
+     * @return result 为编码后的字节数(含帧尾 0x00), status 为编码操作的状态
+     */
+    MW_FuncStatus<uint16_t> Encode(uint8_t type, const uint8_t* payload, uint16_t len, uint8_t* out, uint16_t outSize) const;
+
+protected:
+
+    void FeedSpan(const uint8_t* data, uint32_t len) override;
+    void ResetState() override;
+
+private:
+
+    uint8_t Code;                /*!< 当前编码块的码字,0 表示还没有收到码字 */
+    uint8_t Left;                /*!< 当前编码块剩余的字面字节数 */
+    bool Overflow;               /*!< 当前帧超出帧缓冲区,丢弃到帧尾 */
+
+    /**
+     * @brief 把解码后的数据追加到帧缓冲区
+     */
+    void Append(const uint8_t* data, uint16_t len);
+
+    /**
+     * @brief 收到帧尾 0x00,校验并分发
+     */
+    void EndFrame();
+};
+
+/*==================== 帧头帧解析类 ====================*/
+
+/**
+ * @brief 帧头 + 长度 + CRC 帧解析类
+ * @details
+ * 线路格式: SOF | 长度(1或2字节,小端,负载长度) | 类型 | 负载 | CRC16
+ * 1. 同步搜索用 memchr 查找帧头,一次跳过整段无效数据。
+ * 2. CRC16 覆盖从帧头到负载的全部字节,小端存放。
+ * 3. 长度或 CRC 错误时丢弃当前帧头,从它之后已经缓冲的字节开始重新搜索帧头,
+ *    误同步到负载中的帧头字节时不会丢掉紧随其后的真实帧。
+ */
+class HeaderFrameParser : public FrameParser
+{
+public:
+
+    /**
+     * @brief 构造函数
+     * @param buffer 帧缓冲区,大小至少为 最大负载 + lenBytes + 4
+     * @param size 帧缓冲区大小
+     * @param sof 帧头字节
+     * @param lenBytes 长度字段的字节数,1 或 2
+     * @param crc CRC16 函数,为 nullptr 时使用 MW_FrameCrc16
+     */
+    HeaderFrameParser(uint8_t* buffer, uint16_t size, uint8_t sof, uint8_t lenBytes, FrameCrc16Fn_t crc = nullptr);
+
+    /**
+     * @brief 把一帧编码成线路格式
+     * @param type 帧类型ID
+     * @param payload 负载
+     * @param len 负载长度
+     * @param out 输出缓冲区,大小至少为 len + lenBytes + 4
+     * @param outSize 输出缓冲区大小
+     * @return result 为编码后的字节数, status 为编码操作的状态
+     */
+    MW_FuncStatus<uint16_t> Encode(uint8_t type, const uint8_t* payload, uint16_t len, uint8_t* out, uint16_t outSize) const;
+
+protected:
+
+    void FeedSpan(const uint8_t* data, uint32_t len) override;
+    void ResetState() override;
+
+private:
+
+    uint8_t Sof;                 /*!< 帧头字节 */
+    uint8_t LenBytes;            /*!< 长度字段的字节数 */
+    uint16_t Need;               /*!< 当前阶段需要累计到的字节数 */
+    bool HeaderDone;             /*!< 帧头已经解析,正在接收负载 */
+
+    /**
+     * @brief 帧头(含类型)的字节数
+     */
+    uint16_t HeaderSize() const { return 2 + LenBytes; }
+};
+
+#endif /* MW_FRAMEPARSER_HPP */
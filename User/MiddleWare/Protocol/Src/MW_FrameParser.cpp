@@ -0,0 +1,459 @@
+/*===========================================================
+* @file      MW_FrameParser.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* MW_FrameParser.hpp
+* BspCrc.h
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了FrameParser、CobsFrameParser、HeaderFrameParser类的成员函数
+* 2.实现了按段增量解析、校验与查表分发
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "MW_FrameParser.hpp"
+#include "BspCrc.h"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+/**
+ * @brief 默认的 CRC16 (CRC-16/CCITT-FALSE)
+ * @param data 数据
+ * @param len 数据长度
+ * @param init 初值
+ * @return CRC16
+ * @note 查表实现在 BSP 层的 Crc 中,与其他协议共用
+ */
+uint16_t MW_FrameCrc16(const uint8_t* data, uint32_t len, uint16_t init){
+   return Crc::Crc16Ccitt(data, len, init);
+}
+
+/*================= FrameParser的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数
+ * @param buffer 帧缓冲区
+ * @param size 帧缓冲区大小
+ * @param crc CRC16 函数
+ */
+FrameParser::FrameParser(uint8_t* buffer, uint16_t size, FrameCrc16Fn_t crc)
+   : Buffer(buffer), BufferSize(size), Length(0), Crc(crc != nullptr ? crc : MW_FrameCrc16), HandlerCount(0)
+{
+   memset(&Stats, 0, sizeof(Stats));
+   memset(Handlers, 0, sizeof(Handlers));
+}
+
+/**
+ * @brief 注册一种帧类型的处理函数
+ * @param type 帧类型ID
+ * @param handler 处理函数
+ * @param ctx 透传给处理函数的上下文
+ * @return 注册操作的状态
+ *         返回值:
+ *         INVALID_PARAM 表示处理函数为空,
+ *         RESOURCE_BUSY 表示分发表已满,
+ *         SUCCESS 表示注册成功
+ */
+MW_Status FrameParser::Register(uint8_t type, FrameHandler_t handler, void* ctx){
+   if(handler == nullptr){
+      return MW_Status::INVALID_PARAM;
+   }
+   for(uint8_t i = 0; i < HandlerCount; i++){
+      if(Handlers[i].type == type){
+         Handlers[i].handler = handler;
+         Handlers[i].ctx = ctx;
+         return MW_Status::SUCCESS;
+      }
+   }
+   if(HandlerCount >= FRAME_MAX_HANDLERS){
+      return MW_Status::RESOURCE_BUSY;
+   }
+   Handlers[HandlerCount].type = type;
+   Handlers[HandlerCount].handler = handler;
+   Handlers[HandlerCount].ctx = ctx;
+   HandlerCount++;
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 输入一段连续的数据
+ * @param data 数据
+ * @param len 数据长度
+ */
+void FrameParser::Feed(const uint8_t* data, uint32_t len){
+   if(data == nullptr || len == 0 || Buffer == nullptr){
+      return;
+   }
+   FeedSpan(data, len);
+}
+
+/**
+ * @brief 读取 Uart 接收环形缓冲区中的全部数据并解析
+ * @details 直接解析环形缓冲区中的数据段,回绕处分两段处理,处理完一段就释放
+ * @param uart 串口
+ * @return 本次处理的字节数
+ */
+uint32_t FrameParser::Poll(Uart& uart){
+   uint32_t total = 0;
+   const uint8_t* span = nullptr;
+   uint32_t len = 0;
+   while((len = uart.PeekRx(span).value) > 0){
+      Feed(span, len);
+      uart.ReleaseRx(len);
+      total += len;
+   }
+   return total;
+}
+
+/**
+ * @brief 丢弃未完成的帧,重新开始同步
+ */
+void FrameParser::Reset(){
+   Length = 0;
+   ResetState();
+}
+
+/**
+ * @brief 检查帧尾的 CRC16
+ * @param data 帧数据,最后两个字节为小端 CRC16
+ * @param len 帧长度
+ * @return 校验是否通过
+ */
+bool FrameParser::CheckCrc(const uint8_t* data, uint16_t len) const{
+   if(len < FRAME_CRC_SIZE){
+      return false;
+   }
+   uint16_t received = (uint16_t)(data[len - 2] | (data[len - 1] << 8));
+   return Crc(data, len - FRAME_CRC_SIZE, FRAME_CRC_INIT) == received;
+}
+
+/**
+ * @brief 按类型ID查表分发
+ * @param type 帧类型ID
+ * @param payload 负载
+ * @param len 负载长度
+ */
+void FrameParser::Dispatch(uint8_t type, const uint8_t* payload, uint16_t len){
+   for(uint8_t i = 0; i < HandlerCount; i++){
+      if(Handlers[i].type == type){
+         Stats.frames++;
+         Handlers[i].handler(Handlers[i].ctx, type, payload, len);
+         return;
+      }
+   }
+   Stats.unknownTypes++;
+}
+
+/*================= CobsFrameParser的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数
+ * @param buffer 帧缓冲区
+ * @param size 帧缓冲区大小
+ * @param crc CRC16 函数
+ */
+CobsFrameParser::CobsFrameParser(uint8_t* buffer, uint16_t size, FrameCrc16Fn_t crc)
+   : FrameParser(buffer, size, crc), Code(0), Left(0), Overflow(false)
+{
+}
+
+/**
+ * @brief 重置COBS解码状态
+ */
+void CobsFrameParser::ResetState(){
+   Code = 0;
+   Left = 0;
+   Overflow = false;
+}
+
+/**
+ * @brief 把解码后的数据追加到帧缓冲区
+ * @details 超出帧缓冲区时标记溢出,丢弃到帧尾
+ */
+void CobsFrameParser::Append(const uint8_t* data, uint16_t len){
+   if(Overflow){
+      return;
+   }
+   if(len > BufferSize - Length){
+      Overflow = true;
+      return;
+   }
+   memcpy(&Buffer[Length], data, len);
+   Length += len;
+}
+
+/**
+ * @brief 收到帧尾,校验并分发
+ * @details 连续的 0x00 产生的空帧直接忽略
+ */
+void CobsFrameParser::EndFrame(){
+   if(Overflow){
+      Stats.lengthErrors++;
+   }else if(Length > 0){
+      if(Length < 1 + FRAME_CRC_SIZE){
+         Stats.lengthErrors++;
+      }else if(!CheckCrc(Buffer, Length)){
+         Stats.crcErrors++;
+      }else{
+         Dispatch(Buffer[0], &Buffer[1], Length - 1 - FRAME_CRC_SIZE);
+      }
+   }
+   Length = 0;
+   ResetState();
+}
+
+/**
+ * @brief 解析一段连续的数据
+ * @details 1. 等待码字时读取一个字节,码字小于 0xFF 的块在下一个码字到来时补一个 0x00
+ *          2. 块内的字面字节用 memchr 检查帧尾后整段拷贝
+ *          3. 块未结束就遇到 0x00 说明帧被截断,丢弃当前帧并从这里重新同步
+ * @param data 数据
+ * @param len 数据长度
+ */
+void CobsFrameParser::FeedSpan(const uint8_t* data, uint32_t len){
+   static const uint8_t zero = 0;
+   const uint8_t* p = data;
+   const uint8_t* end = data + len;
+
+   while(p < end){
+      if(Left == 0){
+         uint8_t code = *p++;
+         if(code == 0){
+            EndFrame();
+            continue;
+         }
+         if(Code != 0 && Code != 0xFF){
+            Append(&zero, 1);
+         }
+         Code = code;
+         Left = code - 1;
+         continue;
+      }
+
+      uint32_t n = (uint32_t)(end - p);
+      if(n > Left){
+         n = Left;
+      }
+      const uint8_t* z = static_cast<const uint8_t*>(memchr(p, 0, n));
+      if(z != nullptr){
+         // 编码块被帧尾截断
+         Stats.formatErrors++;
+         Length = 0;
+         ResetState();
+         p = z + 1;
+         continue;
+      }
+      Append(p, (uint16_t)n);
+      Left -= n;
+      p += n;
+   }
+}
+
+/**
+ * @brief 把一帧编码成COBS线路格式
+ * @param type 帧类型ID
+ * @param payload 负载
+ * @param len 负载长度
+ * @param out 输出缓冲区
+ * @param outSize 输出缓冲区大小
+ * @return 编码操作的状态与编码后的字节数
+ *         返回值:
+ *         INVALID_PARAM 表示参数为空或输出缓冲区不足,
+ *         SUCCESS 表示编码成功
+ */
+MW_FuncStatus<uint16_t> CobsFrameParser::Encode(uint8_t type, const uint8_t* payload, uint16_t len, uint8_t* out, uint16_t outSize) const{
+   uint32_t bodyLen = 1U + len + FRAME_CRC_SIZE;
+   uint32_t maxLen = bodyLen + bodyLen / 254U + 2U;
+   if(out == nullptr || (payload == nullptr && len > 0) || outSize < maxLen){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+
+   // CRC 先算类型再接着算负载,不需要把两者拷贝到一起
+   uint16_t crc = Crc(&type, 1, FRAME_CRC_INIT);
+   if(len > 0){
+      crc = Crc(payload, len, crc);
+   }
+   uint8_t tail[FRAME_CRC_SIZE] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+   // 从前向后编码,逐字节从类型、负载和 CRC 中取数据
+   uint16_t codePos = 0;
+   uint16_t wr = 1;
+   uint8_t code = 1;
+   for(uint32_t i = 0; i < bodyLen; i++){
+      uint8_t b;
+      if(i == 0){
+         b = type;
+      }else if(i <= len){
+         b = payload[i - 1];
+      }else{
+         b = tail[i - 1 - len];
+      }
+      if(b == 0){
+         out[codePos] = code;
+         codePos = wr++;
+         code = 1;
+      }else{
+         out[wr++] = b;
+         if(++code == 0xFF){
+            out[codePos] = code;
+            codePos = wr++;
+            code = 1;
+         }
+      }
+   }
+   out[codePos] = code;
+   out[wr++] = 0;
+   return {wr, MW_Status::SUCCESS};
+}
+
+/*================= HeaderFrameParser的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数
+ * @param buffer 帧缓冲区
+ * @param size 帧缓冲区大小
+ * @param sof 帧头字节
+ * @param lenBytes 长度字段的字节数,1 或 2
+ * @param crc CRC16 函数
+ */
+HeaderFrameParser::HeaderFrameParser(uint8_t* buffer, uint16_t size, uint8_t sof, uint8_t lenBytes, FrameCrc16Fn_t crc)
+   : FrameParser(buffer, size, crc), Sof(sof), LenBytes((lenBytes == 2) ? 2 : 1), Need(0), HeaderDone(false)
+{
+}
+
+/**
+ * @brief 重置帧头解析状态
+ */
+void HeaderFrameParser::ResetState(){
+   Need = 0;
+   HeaderDone = false;
+}
+
+/**
+ * @brief 解析一段连续的数据
+ * @details 1. 搜索帧头时用 memchr 跳过整段无效数据
+ *          2. 帧头和负载各用一次 memmove 累计
+ *          3. 长度或 CRC 错误时丢弃当前帧头,把帧缓冲区中它之后的字节当作输入重新扫描,
+ *             扫描完再回到外部数据。重新扫描时写入位置总是不超过读取位置,可以就地搬移;
+ *             重新扫描中再次失败时,先把未扫描的字节接到失败帧之后,合并成一段重新扫描
+ * @param data 数据
+ * @param len 数据长度
+ */
+void HeaderFrameParser::FeedSpan(const uint8_t* data, uint32_t len){
+   const uint8_t* p = data;
+   const uint8_t* end = data + len;
+   const uint8_t* extP = nullptr;       // 重新扫描期间暂存的外部数据位置
+   const uint8_t* extEnd = nullptr;
+
+   for(;;){
+      if(p >= end){
+         if(extP == nullptr){
+            return;
+         }
+         p = extP;
+         end = extEnd;
+         extP = nullptr;
+         continue;
+      }
+
+      if(Length == 0){
+         const uint8_t* sof = static_cast<const uint8_t*>(memchr(p, Sof, (size_t)(end - p)));
+         if(sof == nullptr){
+            Stats.droppedBytes += (uint32_t)(end - p);
+            p = end;
+            continue;
+         }
+         Stats.droppedBytes += (uint32_t)(sof - p);
+         Buffer[0] = Sof;
+         Length = 1;
+         Need = HeaderSize();
+         HeaderDone = false;
+         p = sof + 1;
+         continue;
+      }
+
+      uint32_t n = (uint32_t)(end - p);
+      if(n > (uint32_t)(Need - Length)){
+         n = Need - Length;
+      }
+      memmove(&Buffer[Length], p, n);
+      Length += n;
+      p += n;
+      if(Length < Need){
+         continue;
+      }
+
+      uint16_t payloadLen = (LenBytes == 2) ? (uint16_t)(Buffer[1] | (Buffer[2] << 8)) : Buffer[1];
+      if(!HeaderDone){
+         uint32_t total = (uint32_t)HeaderSize() + payloadLen + FRAME_CRC_SIZE;
+         if(total <= BufferSize){
+            Need = (uint16_t)total;
+            HeaderDone = true;
+            continue;
+         }
+         Stats.lengthErrors++;
+      }else if(CheckCrc(Buffer, Length)){
+         Dispatch(Buffer[1 + LenBytes], &Buffer[HeaderSize()], payloadLen);
+         Length = 0;
+         continue;
+      }else{
+         Stats.crcErrors++;
+      }
+
+      // 帧头是误同步,从它之后的字节重新搜索
+      uint32_t rescan = (uint32_t)Length - 1;
+      if(extP == nullptr){
+         extP = p;
+         extEnd = end;
+      }else{
+         memmove(&Buffer[Length], p, (size_t)(end - p));
+         rescan += (uint32_t)(end - p);
+      }
+      Length = 0;
+      p = &Buffer[1];
+      end = &Buffer[1 + rescan];
+   }
+}
+
+/**
+ * @brief 把一帧编码成帧头线路格式
+ * @param type 帧类型ID
+ * @param payload 负载
+ * @param len 负载长度
+ * @param out 输出缓冲区
+ * @param outSize 输出缓冲区大小
+ * @return 编码操作的状态与编码后的字节数
+ *         返回值:
+ *         INVALID_PARAM 表示参数为空、长度超出长度字段或输出缓冲区不足,
+ *         SUCCESS 表示编码成功
+ */
+MW_FuncStatus<uint16_t> HeaderFrameParser::Encode(uint8_t type, const uint8_t* payload, uint16_t len, uint8_t* out, uint16_t outSize) const{
+   uint32_t total = (uint32_t)HeaderSize() + len + FRAME_CRC_SIZE;
+   if(out == nullptr || (payload == nullptr && len > 0) || outSize < total || (LenBytes == 1 && len > 0xFF)){
+      return {0, MW_Status::INVALID_PARAM};
+   }
+
+   uint16_t wr = 0;
+   out[wr++] = Sof;
+   out[wr++] = (uint8_t)(len & 0xFF);
+   if(LenBytes == 2){
+      out[wr++] = (uint8_t)(len >> 8);
+   }
+   out[wr++] = type;
+   if(len > 0){
+      memcpy(&out[wr], payload, len);
+      wr += len;
+   }
+   uint16_t crc = Crc(out, wr, FRAME_CRC_INIT);
+   out[wr++] = (uint8_t)(crc & 0xFF);
+   out[wr++] = (uint8_t)(crc >> 8);
+   return {wr, MW_Status::SUCCESS};
+}
@@ -0,0 +1,190 @@
+/*===========================================================
+* @file      MW_RcReceiver.hpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖:
+* BspUart.h
+* MW_Common.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 构建在 Uart 双缓冲定长帧接收之上的遥控器接收机驱动
+* DMA 每写满一帧自动切换缓冲区,在传输完成中断中直接对刚写满的缓冲区解码,
+* 解码按字读取、移位掩码,不含分支;结果经序号锁发布为快照,任务中无锁读取。
+* 1. 声明了 RcReceiver 类，支持 DBUS(DJI DT7/DR16) 与 SBUS 两种协议。
+* 2. 定义了 RcProtocol 枚举，用于选择协议。
+* 3. 定义了 RcState 结构体，用于保存一帧解码后的数据。
+* 4. 定义了 RcStats 结构体，用于统计丢帧与失步。
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+#ifndef MW_RCRECEIVER_HPP
+#define MW_RCRECEIVER_HPP
+
+/*========================= 文件依赖 =========================*/
+
+#include "BspUart.h"
+#include "MW_Common.hpp"
+
+/*========================== 宏定义 ==========================*/
+
+/**
+ * @brief DBUS 帧长与帧周期(100kbaud 8E1)
+ */
+#define RC_DBUS_FRAME_SIZE 18
+#define RC_DBUS_PERIOD_MS 7
+
+/**
+ * @brief SBUS 帧长与帧周期(100kbaud 8E2),高速模式的周期为 7ms
+ */
+#define RC_SBUS_FRAME_SIZE 25
+#define RC_SBUS_PERIOD_MS 14
+
+/**
+ * @brief 帧缓冲区大小,取两种协议中较长的帧长
+ */
+#define RC_FRAME_BUFFER_SIZE RC_SBUS_FRAME_SIZE
+
+/**
+ * @brief 通道数量,DBUS 只使用前 5 个
+ */
+#define RC_MAX_CHANNELS 16
+
+/**
+ * @brief 超过该时间没有收到有效帧视为离线
+ */
+#define RC_OFFLINE_TIMEOUT_MS 50
+
+/*==================== 接收机数据类型 ====================*/
+
+/**
+ * @brief 接收机协议
+ * @details
+ *  RcProtocol::DBUS-DJI DT7/DR16,18字节,4个摇杆通道 + 拨轮 + 两个三挡开关 + 鼠标键盘
+ *  RcProtocol::SBUS-Futaba SBUS,25字节,16个通道 + failsafe 标志
+ * @note 两种协议的电平都是反相的,F4 的 USART 不能反相接收,需要板上的反相器
+ */
+enum class RcProtocol : uint8_t
+{
+    DBUS = 0,
+    SBUS
+};
+
+/**
+ * @brief 一帧解码后的数据
+ * @details 通道值已减去中位(DBUS 1024, SBUS 992),DBUS 摇杆范围 ±660
+ */
+struct RcState
+{
+    int16_t ch[RC_MAX_CHANNELS];     /*!< 通道值,DBUS: 0~3 为摇杆, 4 为拨轮 */
+    uint8_t sw[2];                   /*!< DBUS 左右开关,1 上 3 中 2 下 */
+    int16_t mouseX;                  /*!< DBUS 鼠标 */
+    int16_t mouseY;
+    int16_t mouseZ;
+    uint8_t mouseL;
+    uint8_t mouseR;
+    uint16_t keys;                   /*!< DBUS 键盘位图 */
+    bool failsafe;                   /*!< SBUS failsafe 标志 */
+    uint32_t frame;                  /*!< 有效帧序号,从 1 开始 */
+    uint32_t stampMs;                /*!< 收到该帧时的 HAL 毫秒时基 */
+};
+
+/**
+ * @brief 接收统计
+ */
+struct RcStats
+{
+    uint32_t frames;                 /*!< 有效帧数 */
+    uint32_t lostFrames;             /*!< 按帧间隔推算的丢失帧数 */
+    uint32_t desyncs;                /*!< IDLE 时帧不完整、重新对齐的次数 */
+    uint32_t invalidFrames;          /*!< 通道越界或帧头帧尾错误的帧数 */
+    uint32_t failsafes;              /*!< SBUS 带 failsafe 标志的帧数 */
+};
+
+/*==================== 遥控器接收机类 ====================*/
+
+/**
+ * @brief 遥控器接收机
+ * @details
+ * 1. 帧缓冲区是对象的成员,对象应定义为全局或静态对象,不能放在 CCM RAM 中。
+ * 2. 解码在 DMA 传输完成中断中进行,快照由序号锁保护:写者只有中断,
+ *    读者在任务中读到序号变化时重读,读写双方都不关中断。
+ * 3. 一个 Uart 只能被一个接收机使用,该 Uart 不再进行环形接收。
+ */
+class RcReceiver
+{
+public:
+
+    /**
+     * @brief 构造函数
+     * @param uart 接收机所在的串口,Start 时按协议重新配置
+     * @param protocol 协议
+     * @param periodMs 帧周期,用于推算丢帧,为 0 时使用协议的默认周期
+     */
+    RcReceiver(Uart& uart, RcProtocol protocol, uint16_t periodMs = 0);
+
+    /**
+     * @brief 配置串口帧格式并启动双缓冲接收
+     * @return 启动操作的状态
+     */
+    MW_Status Start();
+
+    /**
+     * @brief 读取最新一帧的快照
+     * @param state 用于接收快照的引用
+     * @return UNINITIALIZED 表示还没有收到有效帧, RESOURCE_BUSY 表示多次重读仍被新帧打断,
+     *         SUCCESS 表示读取成功
+     * @note 可以在任务或比接收中断优先级低的中断中调用
+     */
+    MW_Status Read(RcState& state) const;
+
+    /**
+     * @brief 是否在线
+     * @param timeoutMs 超过该时间没有有效帧视为离线
+     */
+    bool IsOnline(uint32_t timeoutMs = RC_OFFLINE_TIMEOUT_MS) const;
+
+    /**
+     * @brief 获取接收统计
+     */
+    const RcStats& GetStats() const { return Stats; }
+
+private:
+
+    Uart& Port;                                     /*!< 接收机所在的串口 */
+    RcProtocol Protocol;                            /*!< 协议 */
+    uint16_t FrameSize;                             /*!< 协议的帧长 */
+    uint16_t PeriodMs;                              /*!< 帧周期 */
+    uint8_t FrameBuffers[2][RC_FRAME_BUFFER_SIZE];  /*!< DMA 双缓冲区 */
+    RcState Snapshot;                               /*!< 最新一帧 */
+    volatile uint32_t SnapshotSeq;                  /*!< 序号锁,奇数表示正在写入 */
+    volatile uint32_t LastStampMs;                  /*!< 最近一次有效帧的时间 */
+    RcStats Stats;                                  /*!< 接收统计 */
+
+    RcReceiver(const RcReceiver&) = delete;
+    RcReceiver& operator=(const RcReceiver&) = delete;
+
+    /**
+     * @brief 解码一帧 DBUS,返回帧是否有效
+     */
+    static bool DecodeDbus(const uint8_t* frame, RcState& state);
+
+    /**
+     * @brief 解码一帧 SBUS,返回帧是否有效
+     */
+    static bool DecodeSbus(const uint8_t* frame, RcState& state);
+
+    /**
+     * @brief 发布一帧快照并推算丢帧,在接收中断中调用
+     */
+    void Publish(const RcState& state);
+
+    /**
+     * @brief 注册在 Uart 上的帧回调
+     */
+    static void OnFrame(void* ctx, const uint8_t* frame, uint16_t len);
+};
+
+#endif /* MW_RCRECEIVER_HPP */
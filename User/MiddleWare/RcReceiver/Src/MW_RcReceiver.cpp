@@ -0,0 +1,261 @@
+/*===========================================================
+* @file      MW_RcReceiver.cpp
+* @author    MRZHENG
+* ===========================================================
+* @brief
+* 该文件依赖
+* MW_RcReceiver.hpp
+* ===========================================================
+* 该文件功能表述(先声明后定义):
+* 1.实现了RcReceiver类的成员函数
+* 2.实现了 DBUS/SBUS 的按字无分支解码、序号锁快照与丢帧推算
+* ===========================================================
+* @version   1.0
+* @date      2026-10-18
+* @copyright Copyright (c) 2025
+============================================================*/
+
+/*========================= 文件依赖 ========================*/
+
+#include "MW_RcReceiver.hpp"
+#include <cstring>
+
+/*========================= 内部常量 =========================*/
+
+/**
+ * @brief 通道中位与 DBUS 摇杆的有效范围
+ */
+static constexpr uint32_t RcDbusCenter = 1024;
+static constexpr uint32_t RcDbusMin = 364;
+static constexpr uint32_t RcDbusSpan = 1320;
+static constexpr uint32_t RcSbusCenter = 992;
+
+/**
+ * @brief SBUS 帧头与 failsafe 标志位
+ */
+static constexpr uint8_t RcSbusHeader = 0x0F;
+static constexpr uint8_t RcSbusFailsafe = 0x08;
+
+/**
+ * @brief 快照读取被新帧打断时的最大重读次数
+ */
+static constexpr uint8_t RcReadRetries = 4;
+
+/*========================= 内部函数 =========================*/
+
+/**
+ * @brief 小端读取,缓冲区可能不对齐
+ * @details Cortex-M4 的 LDR/LDRH 支持非对齐访问,LDRD 不支持。
+ *          memcpy 在 32/16 位时编译为一次 LDR/LDRH,64 位时编译为两次 LDR,不会生成 LDRD
+ */
+static inline uint64_t RcLoad64(const uint8_t* p){
+   uint64_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint32_t RcLoad32(const uint8_t* p){
+   uint32_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint16_t RcLoad16(const uint8_t* p){
+   uint16_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+/*================= RcReceiver的成员函数定义 =================*/
+
+/**
+ * @brief 构造函数
+ * @param uart 接收机所在的串口
+ * @param protocol 协议
+ * @param periodMs 帧周期,为 0 时使用协议的默认周期
+ */
+RcReceiver::RcReceiver(Uart& uart, RcProtocol protocol, uint16_t periodMs)
+   : Port(uart), Protocol(protocol), SnapshotSeq(0), LastStampMs(0)
+{
+   bool sbus = (protocol == RcProtocol::SBUS);
+   FrameSize = sbus ? RC_SBUS_FRAME_SIZE : RC_DBUS_FRAME_SIZE;
+   PeriodMs = (periodMs != 0) ? periodMs : (sbus ? RC_SBUS_PERIOD_MS : RC_DBUS_PERIOD_MS);
+   memset(FrameBuffers, 0, sizeof(FrameBuffers));
+   memset(&Snapshot, 0, sizeof(Snapshot));
+   memset(&Stats, 0, sizeof(Stats));
+}
+
+/**
+ * @brief 配置串口帧格式并启动双缓冲接收
+ * @details DBUS 为 100kbaud 8E1, SBUS 为 100kbaud 8E2,两个缓冲区都恰好容纳一帧
+ * @return 启动操作的状态
+ *         返回值:
+ *         INVALID_OPERATION 表示串口初始化或启动接收失败(串口不存在或已经在环形接收),
+ *         SUCCESS 表示启动成功
+ */
+MW_Status RcReceiver::Start(){
+   UartFraming framing;
+   framing.parity = UartParity::Even;
+   framing.stopBits = (Protocol == RcProtocol::SBUS) ? UartStopBits::Two : UartStopBits::One;
+
+   if(!Port.Init(100000, framing).ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+   if(!Port.EnableRxFrameDMA(FrameBuffers[0], FrameBuffers[1], FrameSize, OnFrame, this).ok()){
+      return MW_Status::INVALID_OPERATION;
+   }
+   return MW_Status::SUCCESS;
+}
+
+/**
+ * @brief 读取最新一帧的快照
+ * @details 序号为奇数或拷贝前后序号不同,说明拷贝期间接收中断写入了新帧,重读
+ * @param state 用于接收快照的引用
+ * @return 读取操作的状态
+ */
+MW_Status RcReceiver::Read(RcState& state) const{
+   for(uint8_t i = 0; i < RcReadRetries; i++){
+      uint32_t seq = SnapshotSeq;
+      __DMB();
+      if(seq == 0){
+         return MW_Status::UNINITIALIZED;
+      }
+      if((seq & 1U) != 0U){
+         continue;
+      }
+      state = Snapshot;
+      __DMB();
+      if(SnapshotSeq == seq){
+         return MW_Status::SUCCESS;
+      }
+   }
+   return MW_Status::RESOURCE_BUSY;
+}
+
+/**
+ * @brief 是否在线
+ * @param timeoutMs 超过该时间没有有效帧视为离线
+ * @return true 表示在线
+ */
+bool RcReceiver::IsOnline(uint32_t timeoutMs) const{
+   return (SnapshotSeq != 0) && (HAL_GetTick() - LastStampMs <= timeoutMs);
+}
+
+/*==================== 私有函数实现 ====================*/
+
+/**
+ * @brief 解码一帧 DBUS
+ * @details 18 字节按三个字读取:
+ *          字节 0~7 为 4 个 11 位摇杆通道、两个 2 位开关与鼠标X,
+ *          字节 8~15 为鼠标Y/Z、左右键与键盘,字节 16~17 为拨轮。
+ *          有效性用无符号比较按位累加,不提前返回
+ * @param frame 帧数据
+ * @param state 用于接收解码结果的引用,未使用的通道保持原值
+ * @return 摇杆在 364~1684 之间且开关不为 0 时返回 true
+ */
+bool RcReceiver::DecodeDbus(const uint8_t* frame, RcState& state){
+   uint64_t w0 = RcLoad64(frame);
+   uint64_t w1 = RcLoad64(frame + 8);
+   uint32_t w2 = RcLoad16(frame + 16);
+
+   uint32_t ch0 = (uint32_t)w0 & 0x7FFU;
+   uint32_t ch1 = (uint32_t)(w0 >> 11) & 0x7FFU;
+   uint32_t ch2 = (uint32_t)(w0 >> 22) & 0x7FFU;
+   uint32_t ch3 = (uint32_t)(w0 >> 33) & 0x7FFU;
+   uint32_t sw0 = (uint32_t)(w0 >> 44) & 0x3U;
+   uint32_t sw1 = (uint32_t)(w0 >> 46) & 0x3U;
+   uint32_t wheel = w2 & 0x7FFU;
+
+   state.ch[0] = (int16_t)((int32_t)ch0 - (int32_t)RcDbusCenter);
+   state.ch[1] = (int16_t)((int32_t)ch1 - (int32_t)RcDbusCenter);
+   state.ch[2] = (int16_t)((int32_t)ch2 - (int32_t)RcDbusCenter);
+   state.ch[3] = (int16_t)((int32_t)ch3 - (int32_t)RcDbusCenter);
+   // 旧版接收机不发送拨轮,该字段为 0,按中位处理
+   state.ch[4] = (int16_t)(((int32_t)wheel - (int32_t)RcDbusCenter) & -(int32_t)(wheel != 0U));
+   state.sw[0] = (uint8_t)sw0;
+   state.sw[1] = (uint8_t)sw1;
+   state.mouseX = (int16_t)(w0 >> 48);
+   state.mouseY = (int16_t)w1;
+   state.mouseZ = (int16_t)(w1 >> 16);
+   state.mouseL = (uint8_t)(w1 >> 32);
+   state.mouseR = (uint8_t)(w1 >> 40);
+   state.keys = (uint16_t)(w1 >> 48);
+
+   uint32_t bad = (uint32_t)(ch0 - RcDbusMin > RcDbusSpan) | (uint32_t)(ch1 - RcDbusMin > RcDbusSpan)
+                | (uint32_t)(ch2 - RcDbusMin > RcDbusSpan) | (uint32_t)(ch3 - RcDbusMin > RcDbusSpan)
+                | (uint32_t)(sw0 == 0U) | (uint32_t)(sw1 == 0U);
+   return bad == 0U;
+}
+
+/**
+ * @brief 解码一帧 SBUS
+ * @details 字节 1~22 为 16 个 11 位通道,第 i 个通道从第 11*i 位开始,
+ *          每个通道用一次 32 位读取加移位掩码取出(位偏移不超过 7,11 位不会跨出该字),
+ *          循环次数固定,编译器展开后不含分支。字节 23 为标志,字节 24 为帧尾
+ * @param frame 帧数据
+ * @param state 用于接收解码结果的引用
+ * @return 帧头为 0x0F 且帧尾为 0x00 或 0x?4 时返回 true
+ */
+bool RcReceiver::DecodeSbus(const uint8_t* frame, RcState& state){
+   const uint8_t* payload = frame + 1;
+   for(uint32_t i = 0; i < RC_MAX_CHANNELS; i++){
+      uint32_t bit = 11U * i;
+      uint32_t raw = (RcLoad32(payload + (bit >> 3)) >> (bit & 7U)) & 0x7FFU;
+      state.ch[i] = (int16_t)((int32_t)raw - (int32_t)RcSbusCenter);
+   }
+   state.failsafe = (frame[23] & RcSbusFailsafe) != 0U;
+
+   uint32_t footer = frame[RC_SBUS_FRAME_SIZE - 1];
+   uint32_t bad = (uint32_t)(frame[0] != RcSbusHeader)
+                | ((uint32_t)(footer != 0x00U) & (uint32_t)((footer & 0xCFU) != 0x04U));
+   return bad == 0U;
+}
+
+/**
+ * @brief 发布一帧快照并推算丢帧
+ * @details 与上一帧的间隔超过 1.5 个周期时,按四舍五入推算中间丢失的帧数
+ * @param state 新的一帧
+ */
+void RcReceiver::Publish(const RcState& state){
+   if(SnapshotSeq != 0){
+      uint32_t gap = state.stampMs - LastStampMs;
+      if(gap * 2U > PeriodMs * 3U){
+         Stats.lostFrames += (gap + PeriodMs / 2U) / PeriodMs - 1U;
+      }
+   }
+
+   SnapshotSeq = SnapshotSeq + 1U;
+   __DMB();
+   Snapshot = state;
+   __DMB();
+   SnapshotSeq = SnapshotSeq + 1U;
+   LastStampMs = state.stampMs;
+}
+
+/**
+ * @brief 注册在 Uart 上的帧回调,在DMA传输完成或IDLE中断中调用
+ * @param ctx 接收机
+ * @param frame 刚写满的帧缓冲区,帧错位时为 nullptr
+ * @param len 帧长或错位时已收到的字节数
+ */
+void RcReceiver::OnFrame(void* ctx, const uint8_t* frame, uint16_t len){
+   (void)len;
+   RcReceiver* self = static_cast<RcReceiver*>(ctx);
+   if(frame == nullptr){
+      // Uart 已经从下一帧的起点重新对齐
+      self->Stats.desyncs++;
+      return;
+   }
+
+   RcState next = {};
+   next.stampMs = HAL_GetTick();
+   bool valid = (self->Protocol == RcProtocol::SBUS) ? DecodeSbus(frame, next) : DecodeDbus(frame, next);
+   if(!valid){
+      self->Stats.invalidFrames++;
+      return;
+   }
+   self->Stats.failsafes += next.failsafe ? 1U : 0U;
+   self->Stats.frames++;
+   next.frame = self->Stats.frames;
+   self->Publish(next);
+}